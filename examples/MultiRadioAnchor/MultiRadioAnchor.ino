@@ -0,0 +1,92 @@
+/*
+ * MIT License
+ * 
+ * Copyright (c) 2018 Michele Biondi, Andrea Salvatori
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+*/
+
+/*
+ * Anchor with two DW1000 on the same SPI bus, listening in parallel.
+ * Frames heard by both radios are printed in arrival order with the
+ * radio that received them, the RX timestamp and the first path power.
+ */
+
+#include <DW1000Ng.hpp>
+#include <DW1000NgMultiRadio.hpp>
+
+const uint8_t PIN_SS_A = 10; // spi select pin, radio 0
+const uint8_t PIN_IRQ_A = 2; // irq pin, radio 0
+const uint8_t PIN_SS_B = 9;  // spi select pin, radio 1
+const uint8_t PIN_IRQ_B = 3; // irq pin, radio 1
+
+DW1000NgDevice radioA;
+DW1000NgDevice radioB;
+DW1000NgDevice* radios[] = {&radioA, &radioB};
+
+device_configuration_t DEFAULT_CONFIG = {
+    false,
+    true,
+    true,
+    true,
+    false,
+    SFDMode::STANDARD_SFD,
+    Channel::CHANNEL_5,
+    DataRate::RATE_850KBPS,
+    PulseFrequency::FREQ_16MHZ,
+    PreambleLength::LEN_256,
+    PreambleCode::CODE_3
+};
+
+interrupt_configuration_t RECEIVE_INTERRUPT_CONFIG = {
+    false,
+    true,
+    true,
+    true,
+    false
+};
+
+void setup() {
+    Serial.begin(115200);
+    Serial.println(F("### DW1000Ng-arduino-multi-radio-anchor ###"));
+
+    DW1000Ng::initialize(radioA, PIN_SS_A, PIN_IRQ_A);
+    DW1000Ng::applyConfiguration(DEFAULT_CONFIG);
+    DW1000Ng::applyInterruptConfiguration(RECEIVE_INTERRUPT_CONFIG);
+    DW1000Ng::setAntennaDelay(16436);
+
+    DW1000Ng::initialize(radioB, PIN_SS_B, PIN_IRQ_B);
+    DW1000Ng::applyConfiguration(DEFAULT_CONFIG);
+    DW1000Ng::applyInterruptConfiguration(RECEIVE_INTERRUPT_CONFIG);
+    DW1000Ng::setAntennaDelay(16436);
+
+    DW1000NgMultiRadio::begin(radios, 2);
+    Serial.println(F("Receivers armed ..."));
+}
+
+void loop() {
+    MultiRadioFrame frame;
+    while(DW1000NgMultiRadio::read(frame)) {
+        Serial.print(F("radio ")); Serial.print(frame.radio);
+        Serial.print(F(" arrival [us] ")); Serial.print(frame.arrival);
+        Serial.print(F(" timestamp ")); Serial.print((uint32_t)frame.timestamp);
+        Serial.print(F(" first path [dBm] ")); Serial.print(frame.firstPathPower);
+        Serial.print(F(" length ")); Serial.println(frame.length);
+    }
+}
@@ -16,6 +16,7 @@
 #include <DW1000NgUtils.hpp>
 #include <DW1000NgRanging.hpp>
 #include <DW1000NgRTLS.hpp>
+#include <DW1000NgFrame.hpp>
 
 // connection pins
 #if defined(ESP8266)
@@ -76,9 +77,8 @@ void setup() {
     
     DW1000Ng::setEUI(EUI);
 
-    DW1000Ng::setPreambleDetectionTimeout(64);
-    DW1000Ng::setSfdDetectionTimeout(273);
-    DW1000Ng::setReceiveFrameWaitTimeoutPeriod(5000);
+    // longest frame: final message (22 bytes), sent by the tag up to the reply delay (at most REPLY_DELAY_LIMIT) after the response to poll
+    DW1000Ng::enableAutoReceiveTimeouts(22, REPLY_DELAY_LIMIT);
 
     DW1000Ng::setNetworkId(RTLS_APP_ID);
     DW1000Ng::setDeviceAddress(2);
@@ -100,13 +100,10 @@ void setup() {
 }
 
 void transmitRangeReport() {
-    byte rangingReport[] = {DATA, SHORT_SRC_AND_DEST, DW1000NgRTLS::increaseSequenceNumber(), 0,0, 0,0, 0,0, 0x60, 0,0 };
-    DW1000Ng::getNetworkId(&rangingReport[3]);
-    memcpy(&rangingReport[5], main_anchor_address, 2);
-    DW1000Ng::getDeviceAddress(&rangingReport[7]);
-    DW1000NgUtils::writeValueToBytes(&rangingReport[10], static_cast<uint16_t>((range_self*1000)), 2);
-    DW1000Ng::setTransmitData(rangingReport, sizeof(rangingReport));
-    DW1000Ng::startTransmit();
+    DW1000NgFrame::DataFrame<SHORT_SRC_AND_DEST, 3> rangingReport(DW1000NgRTLS::increaseSequenceNumber(), main_anchor_address);
+    rangingReport.payload()[0] = 0x60;
+    DW1000NgUtils::writeValueToBytes(&rangingReport.payload()[1], static_cast<uint16_t>((range_self*1000)), 2);
+    rangingReport.transmit();
 }
  
 void loop() {     
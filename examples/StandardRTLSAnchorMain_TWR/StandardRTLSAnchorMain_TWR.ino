@@ -92,9 +92,8 @@ void setup() {
     
     DW1000Ng::setEUI(EUI);
 
-    DW1000Ng::setPreambleDetectionTimeout(64);
-    DW1000Ng::setSfdDetectionTimeout(273);
-    DW1000Ng::setReceiveFrameWaitTimeoutPeriod(5000);
+    // longest frame: final message (22 bytes), sent by the tag up to the reply delay (at most REPLY_DELAY_LIMIT) after the response to poll
+    DW1000Ng::enableAutoReceiveTimeouts(22, REPLY_DELAY_LIMIT);
 
     DW1000Ng::setNetworkId(RTLS_APP_ID);
     DW1000Ng::setDeviceAddress(1);
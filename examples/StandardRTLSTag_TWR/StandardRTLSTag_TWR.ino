@@ -91,11 +91,16 @@ void setup() {
 
     DW1000Ng::applySleepConfiguration(SLEEP_CONFIG);
 
-    DW1000Ng::setPreambleDetectionTimeout(15);
-    DW1000Ng::setSfdDetectionTimeout(273);
-    DW1000Ng::setReceiveFrameWaitTimeoutPeriod(2000);
+    // longest frame: ranging initiation (18 bytes), sent by the anchors right after receiving
+    DW1000Ng::enableAutoReceiveTimeouts(18, 120);
     
     Serial.println(F("Committed configuration ..."));
+    uint16_t replyDelay = DW1000NgRTLS::calibrateReplyDelay();
+    if(replyDelay == 0) {
+        Serial.println(F("Reply delay above REPLY_DELAY_LIMIT, the anchors would miss the final message"));
+    } else {
+        Serial.print("Reply delay (us): "); Serial.println(replyDelay);
+    }
     // DEBUG chip info and registers pretty printed
     char msg[128];
     DW1000Ng::getPrintableDeviceIdentifier(msg);
@@ -114,7 +119,7 @@ void loop() {
     DW1000Ng::spiWakeup();
     DW1000Ng::setEUI(EUI);
 
-    RangeInfrastructureResult res = DW1000NgRTLS::tagTwrLocalize(1500);
+    RangeInfrastructureResult res = DW1000NgRTLS::tagTwrLocalize();
     if(res.success)
         blink_rate = res.new_blink_rate;
 }
@@ -174,14 +174,10 @@ void transmitPoll() {
 void transmitRange() {
     data[0] = RANGE;
 
-    /* Calculation of future time */
-    byte futureTimeBytes[LENGTH_TIMESTAMP];
-
-	timeRangeSent = DW1000Ng::getSystemTimestamp();
-	timeRangeSent += DW1000NgTime::microsecondsToUWBTime(replyDelayTimeUS);
-    DW1000NgUtils::writeValueToBytes(futureTimeBytes, timeRangeSent, LENGTH_TIMESTAMP);
-    DW1000Ng::setDelayedTRX(futureTimeBytes);
-    timeRangeSent += DW1000Ng::getTxAntennaDelay();
+    /* Calculation of future time, the device tells us the exact timestamp it will use */
+    timeRangeSent = DW1000Ng::setDelayedTransmitTime(
+        DW1000Ng::getSystemTimestamp() + DW1000NgTime::microsecondsToUWBTime(replyDelayTimeUS)
+    );
 
     DW1000NgUtils::writeValueToBytes(data + 1, timePollSent, LENGTH_TIMESTAMP);
     DW1000NgUtils::writeValueToBytes(data + 6, timePollAckReceived, LENGTH_TIMESTAMP);
@@ -0,0 +1,128 @@
+/*
+ * MIT License
+ * 
+ * Copyright (c) 2018 Michele Biondi, Andrea Salvatori
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ * @file power.cpp
+ * Compares DW1000Ng::getReceivePower() and DW1000Ng::getFirstPathPower() (integer log2, DW1000NgUtils::log2Q16())
+ * with the float log10 formula of section 4.7 of the User Manual they replaced, for both PRFs.
+ * The receive quality registers of a simulated DW1000 are swept: every CIR_PWR value and random first path
+ * amplitudes (FP_AMPL1-3), each with a set of preamble accumulation counts (RXPACC).
+ *
+ * usage: power [count] [seed]
+ * Exits with 1 if an estimate differs by more than 0.1 dB.
+*/
+
+#include <Arduino.h>
+#include <random>
+#include "DW1000Ng.hpp"
+#include "DW1000NgRegisters.hpp"
+#include "DW1000Simulator.hpp"
+
+namespace {
+
+    constexpr uint8_t PIN_SS = 10;
+    constexpr double MAX_ERROR_DB = 0.1;
+    const uint16_t RXPACC[] = {16, 32, 57, 64, 100, 128, 256, 500, 512, 1000, 1024, 2048, 4095};
+
+    typedef struct result_t {
+        double maxError;
+        uint32_t checks;
+        uint32_t failures;
+    } result_t;
+
+    /* previous float implementation, A and the correction factor depend on the PRF */
+    float referencePower(float powerRatio, PulseFrequency prf) {
+        float A, corrFac;
+        if(prf == PulseFrequency::FREQ_16MHZ) {
+            A       = 113.77;
+            corrFac = 2.3334;
+        } else {
+            A       = 121.74;
+            corrFac = 1.1667;
+        }
+        float estPwr = 10.0*log10(powerRatio)-A;
+        if(estPwr <= -88) {
+            return estPwr;
+        } else {
+            // approximation of Fig. 22 in user manual for dbm correction
+            estPwr += (estPwr+88)*corrFac;
+        }
+        return estPwr;
+    }
+
+    float referenceReceivePower(uint16_t C, uint16_t N, PulseFrequency prf) {
+        uint32_t twoPower17 = 131072;
+        return referencePower(((float)C*(float)twoPower17)/((float)N*(float)N), prf);
+    }
+
+    float referenceFirstPathPower(uint16_t f1, uint16_t f2, uint16_t f3, uint16_t N, PulseFrequency prf) {
+        return referencePower(((float)f1*(float)f1+(float)f2*(float)f2+(float)f3*(float)f3)/((float)N*(float)N), prf);
+    }
+
+    void check(result_t& result, float power, float reference, const char* name, uint16_t N) {
+        double error = fabs(power - reference);
+        result.checks++;
+        if(error > result.maxError)
+            result.maxError = error;
+        if(error > MAX_ERROR_DB && result.failures++ < 10)
+            printf("FAIL %s RXPACC %u: %f dBm, reference %f dBm\n", name, N, power, reference);
+    }
+
+}
+
+int main(int argc, char* argv[]) {
+    uint32_t count = argc > 1 ? strtoul(argv[1], nullptr, 10) : 100000;
+    std::mt19937 generator(argc > 2 ? strtoul(argv[2], nullptr, 10) : 1);
+    std::uniform_int_distribution<uint16_t> amplitude(0, 0xFFFF);
+
+    uint8_t node = DW1000Simulator::addNode(PIN_SS, 0xff, DW1000Simulator::defaultNodeConfiguration());
+    DW1000Ng::initializeNoInterrupt(PIN_SS);
+
+    result_t result = {};
+    const PulseFrequency prfs[] = {PulseFrequency::FREQ_16MHZ, PulseFrequency::FREQ_64MHZ};
+    for(PulseFrequency prf : prfs) {
+        device_configuration_t config = {false, false, true, true, false, SFDMode::STANDARD_SFD, Channel::CHANNEL_5,
+                                         DataRate::RATE_850KBPS, prf, PreambleLength::LEN_256,
+                                         prf == PulseFrequency::FREQ_16MHZ ? PreambleCode::CODE_3 : PreambleCode::CODE_9};
+        DW1000Ng::applyConfiguration(config);
+        for(uint16_t N : RXPACC) {
+            DW1000Simulator::setRegister(node, RX_FINFO, 0, LEN_RX_FINFO, static_cast<uint32_t>(N) << 20);
+            for(uint32_t C = 1; C <= 0xFFFF; C++) {
+                DW1000Simulator::setRegister(node, RX_FQUAL, CIR_PWR_SUB, LEN_CIR_PWR, C);
+                check(result, DW1000Ng::getReceivePower(), referenceReceivePower(C, N, prf), "CIR_PWR", N);
+            }
+            for(uint32_t i = 0; i < count; i++) {
+                uint16_t f1 = amplitude(generator);
+                uint16_t f2 = amplitude(generator);
+                uint16_t f3 = amplitude(generator);
+                if(f1 == 0 && f2 == 0 && f3 == 0)
+                    continue;
+                DW1000Simulator::setRegister(node, RX_TIME, FP_AMPL1_SUB, LEN_FP_AMPL1, f1);
+                DW1000Simulator::setRegister(node, RX_FQUAL, FP_AMPL2_SUB, LEN_FP_AMPL2, f2);
+                DW1000Simulator::setRegister(node, RX_FQUAL, FP_AMPL3_SUB, LEN_FP_AMPL3, f3);
+                check(result, DW1000Ng::getFirstPathPower(), referenceFirstPathPower(f1, f2, f3, N, prf), "FP_AMPL", N);
+            }
+        }
+    }
+    printf("%u estimates, largest difference %.4f dB, %u above %.1f dB\n", result.checks, result.maxError, result.failures, MAX_ERROR_DB);
+    return result.failures == 0 ? 0 : 1;
+}
@@ -0,0 +1,128 @@
+/*
+ * MIT License
+ * 
+ * Copyright (c) 2018 Michele Biondi, Andrea Salvatori
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ * @file ranging.cpp
+ * Compares DW1000NgRanging::computeRangeAsymmetricMillimeters() (integer math, DW1000NG_FIXED_POINT)
+ * with the double precision DW1000NgRanging::computeRangeAsymmetric() over randomized two-way ranging exchanges.
+ * The double formula rounds its 64 bit products, so when the time of flight falls right on a tick boundary
+ * it may truncate to the neighbouring tick: such one tick differences are counted apart, not as failures.
+ *
+ * usage: ranging [count] [seed]
+ * Exits with 1 if a range differs by more than 1 mm otherwise.
+*/
+
+#include <Arduino.h>
+#include <random>
+#include "DW1000NgConstants.hpp"
+#include "DW1000NgRanging.hpp"
+
+namespace {
+
+    constexpr uint64_t TIMESTAMP_MASK = (1ULL << 40) - 1;
+    constexpr double MAX_ERROR_MM = 1.0;
+    /* relative error of the double products, far above what they lose (2^-52) */
+    constexpr double DOUBLE_ROUNDING = 1e-12;
+
+    /* device clock of a node with the given crystal error and time base, wrapped to 40 bit */
+    uint64_t deviceTime(double realTicks, double clockError, uint64_t offset) {
+        return (offset + static_cast<uint64_t>(llround(realTicks * (1 + clockError)))) & TIMESTAMP_MASK;
+    }
+
+    /* whether the exact time of flight (ticks) is close enough to an integer for the double rounding to cross it */
+    bool onTickBoundary(uint64_t timePollSent, uint64_t timePollReceived, uint64_t timePollAckSent,
+                         uint64_t timePollAckReceived, uint64_t timeRangeSent, uint64_t timeRangeReceived) {
+        uint64_t round1 = static_cast<uint32_t>(timePollAckReceived - timePollSent);
+        uint64_t reply1 = static_cast<uint32_t>(timePollAckSent - timePollReceived);
+        uint64_t round2 = static_cast<uint32_t>(timeRangeReceived - timePollAckSent);
+        uint64_t reply2 = static_cast<uint32_t>(timeRangeSent - timePollAckReceived);
+        uint64_t rounds = round1 * round2;
+        uint64_t replies = reply1 * reply2;
+        uint64_t sum = round1 + round2 + reply1 + reply2;
+        uint64_t difference = rounds >= replies ? rounds - replies : replies - rounds;
+        uint64_t remainder = difference % sum;
+        uint64_t distance = remainder < sum - remainder ? remainder : sum - remainder;
+        return distance <= (rounds + replies) * DOUBLE_ROUNDING;
+    }
+
+}
+
+int main(int argc, char* argv[]) {
+    uint32_t count = argc > 1 ? strtoul(argv[1], nullptr, 10) : 1000000;
+    std::mt19937_64 generator(argc > 2 ? strtoull(argv[2], nullptr, 10) : 1);
+    std::uniform_int_distribution<uint64_t> timestamp(0, TIMESTAMP_MASK);
+    std::uniform_real_distribution<double> clockError(-20e-6, 20e-6);
+    /* up to 300 m */
+    std::uniform_real_distribution<double> timeOfFlight(0, 300.0 / DISTANCE_OF_RADIO);
+    /* 100 μs to 30 ms (TIME_RES is in μs), the intervals must fit 32 bit (67 ms) */
+    std::uniform_real_distribution<double> replyDelay(100 / TIME_RES, 30000 / TIME_RES);
+
+    double maxError = 0;
+    uint32_t failures = 0;
+    uint32_t boundaries = 0;
+    for(uint32_t i = 0; i < count; i++) {
+        double tagError = clockError(generator);
+        double anchorError = clockError(generator);
+        uint64_t tagOffset = timestamp(generator);
+        uint64_t anchorOffset = timestamp(generator);
+        double tof = timeOfFlight(generator);
+        double reply1 = replyDelay(generator);
+        double reply2 = replyDelay(generator);
+
+        /* real times, in UWB time units from the poll transmission */
+        double pollReceived = tof;
+        double pollAckSent = pollReceived + reply1;
+        double pollAckReceived = pollAckSent + tof;
+        double rangeSent = pollAckReceived + reply2;
+        double rangeReceived = rangeSent + tof;
+
+        uint64_t timePollSent = deviceTime(0, tagError, tagOffset);
+        uint64_t timePollReceived = deviceTime(pollReceived, anchorError, anchorOffset);
+        uint64_t timePollAckSent = deviceTime(pollAckSent, anchorError, anchorOffset);
+        uint64_t timePollAckReceived = deviceTime(pollAckReceived, tagError, tagOffset);
+        uint64_t timeRangeSent = deviceTime(rangeSent, tagError, tagOffset);
+        uint64_t timeRangeReceived = deviceTime(rangeReceived, anchorError, anchorOffset);
+
+        double range = DW1000NgRanging::computeRangeAsymmetric(timePollSent, timePollReceived, timePollAckSent,
+                                                               timePollAckReceived, timeRangeSent, timeRangeReceived) * 1000;
+        int32_t rangeMillimeters = DW1000NgRanging::computeRangeAsymmetricMillimeters(timePollSent, timePollReceived, timePollAckSent,
+                                                                                     timePollAckReceived, timeRangeSent, timeRangeReceived);
+        double error = fabs(rangeMillimeters - range);
+        if(error > MAX_ERROR_MM && onTickBoundary(timePollSent, timePollReceived, timePollAckSent,
+                                                   timePollAckReceived, timeRangeSent, timeRangeReceived)
+                && fabs(error - DISTANCE_OF_RADIO * 1000) <= MAX_ERROR_MM) {
+            boundaries++;
+            continue;
+        }
+        if(error > maxError)
+            maxError = error;
+        if(error > MAX_ERROR_MM) {
+            if(failures++ < 10)
+                printf("FAIL %llu %llu %llu %llu %llu %llu: %f mm, %d mm\n", (unsigned long long)timePollSent,
+                       (unsigned long long)timePollReceived, (unsigned long long)timePollAckSent, (unsigned long long)timePollAckReceived,
+                       (unsigned long long)timeRangeSent, (unsigned long long)timeRangeReceived, range, rangeMillimeters);
+        }
+    }
+    printf("%u exchanges, largest difference %.3f mm, %u above %.1f mm, %u one tick apart on a tick boundary\n",
+           count, maxError, failures, MAX_ERROR_MM, boundaries);
+    return failures == 0 ? 0 : 1;
+}
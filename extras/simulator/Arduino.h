@@ -0,0 +1,146 @@
+/*
+ * MIT License
+ * 
+ * Copyright (c) 2018 Michele Biondi, Andrea Salvatori
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ * @file Arduino.h
+ * Minimal Arduino core for host builds against the DW1000 simulator.
+ * Time is virtual: delay(), micros() and every SPI transaction advance the clock of the running MCU.
+*/
+
+#pragma once
+
+#include <stdint.h>
+#include <stddef.h>
+#include <string.h>
+#include <stdlib.h>
+#include <stdio.h>
+#include <math.h>
+#include <string>
+
+typedef uint8_t byte;
+typedef bool boolean;
+
+#define LOW 0
+#define HIGH 1
+#define INPUT 0
+#define OUTPUT 1
+#define INPUT_PULLUP 2
+#define CHANGE 1
+#define FALLING 2
+#define RISING 3
+#define MSBFIRST 1
+#define SPI_MODE0 0
+#define DEC 10
+#define HEX 16
+
+#define F(string) (string)
+#define PROGMEM
+
+#define bitRead(value, bit) (((value) >> (bit)) & 0x01)
+#define bitSet(value, bit) ((value) |= (1UL << (bit)))
+#define bitClear(value, bit) ((value) &= ~(1UL << (bit)))
+#define bitWrite(value, bit, bitvalue) ((bitvalue) ? bitSet(value, bit) : bitClear(value, bit))
+
+constexpr uint8_t SS = 10;
+
+void delay(unsigned long ms);
+void delayMicroseconds(unsigned int us);
+unsigned long millis();
+unsigned long micros();
+void yield();
+
+void pinMode(uint8_t pin, uint8_t mode);
+void digitalWrite(uint8_t pin, uint8_t value);
+int digitalRead(uint8_t pin);
+
+inline int digitalPinToInterrupt(uint8_t pin) { return pin; }
+void attachInterrupt(int interruptNumber, void (*handler)(void), int mode);
+void detachInterrupt(int interruptNumber);
+void noInterrupts();
+void interrupts();
+
+class String {
+public:
+    String(const char* value = "") : _value(value) {}
+    String(const std::string& value) : _value(value) {}
+    String(char value) : _value(1, value) {}
+    String(unsigned char value, unsigned char base = DEC);
+    String(int value, unsigned char base = DEC);
+    String(unsigned int value, unsigned char base = DEC);
+    String(long value, unsigned char base = DEC);
+    String(unsigned long value, unsigned char base = DEC);
+    String(double value, unsigned char decimals = 2);
+
+    unsigned int length() const { return _value.length(); }
+    const char* c_str() const { return _value.c_str(); }
+    void getBytes(unsigned char buffer[], unsigned int size) const;
+    void remove(unsigned int index) { if(index < _value.length()) _value.erase(index); }
+
+    String& operator+=(const String& value) { _value += value._value; return *this; }
+    String& operator+=(const char* value) { _value += value; return *this; }
+    String& operator+=(char value) { _value += value; return *this; }
+    String& operator+=(unsigned char value) { return *this += String(value); }
+    String& operator+=(int value) { return *this += String(value); }
+    String& operator+=(unsigned int value) { return *this += String(value); }
+    String& operator+=(long value) { return *this += String(value); }
+    String& operator+=(unsigned long value) { return *this += String(value); }
+    String& operator+=(float value) { return *this += String((double)value); }
+    String& operator+=(double value) { return *this += String(value); }
+
+    bool operator==(const String& other) const { return _value == other._value; }
+
+private:
+    std::string _value;
+};
+
+class Print {
+public:
+    virtual ~Print() {}
+
+    size_t print(const String& value);
+    size_t print(const char value[]);
+    size_t print(char value);
+    size_t print(unsigned char value, int base = DEC);
+    size_t print(int value, int base = DEC);
+    size_t print(unsigned int value, int base = DEC);
+    size_t print(long value, int base = DEC);
+    size_t print(unsigned long value, int base = DEC);
+    size_t print(double value, int decimals = 2);
+
+    size_t println();
+    template<typename T> size_t println(T value) { size_t n = print(value); return n + println(); }
+    template<typename T> size_t println(T value, int format) { size_t n = print(value, format); return n + println(); }
+
+protected:
+    virtual size_t _write(const char text[]) = 0;
+};
+
+class HardwareSerial : public Print {
+public:
+    void begin(unsigned long baud) {}
+    void flush() {}
+
+protected:
+    size_t _write(const char text[]) override;
+};
+
+extern HardwareSerial Serial;
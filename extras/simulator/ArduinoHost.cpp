@@ -0,0 +1,152 @@
+/*
+ * MIT License
+ * 
+ * Copyright (c) 2018 Michele Biondi, Andrea Salvatori
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ * @file ArduinoHost.cpp
+ * Host implementation of the Arduino core functions used by the driver, on the simulator clock.
+*/
+
+#include <map>
+#include <Arduino.h>
+#include <SPI.h>
+#include "DW1000Simulator.hpp"
+
+HardwareSerial Serial;
+SPIClass SPI;
+
+namespace {
+    constexpr uint64_t TICKS_PER_10_MICROSECONDS = 638976;
+    /* micros() and millis() cost some time, so polling loops always make progress */
+    constexpr uint64_t TIME_READ_COST = TICKS_PER_10_MICROSECONDS / 20;
+
+    std::map<uint8_t, int> _pins;
+
+    std::string _number(unsigned long long value, unsigned char base, bool negative) {
+        static const char digits[] = "0123456789ABCDEF";
+        std::string text;
+        do {
+            text.insert(text.begin(), digits[value % base]);
+            value /= base;
+        } while(value != 0);
+        if(negative)
+            text.insert(text.begin(), '-');
+        return text;
+    }
+
+    std::string _decimal(double value, unsigned char decimals) {
+        char text[64];
+        snprintf(text, sizeof(text), "%.*f", decimals, value);
+        return text;
+    }
+}
+
+void delay(unsigned long ms) {
+    DW1000Simulator::elapse((uint64_t)ms * 100 * TICKS_PER_10_MICROSECONDS);
+}
+
+void delayMicroseconds(unsigned int us) {
+    DW1000Simulator::elapse((uint64_t)us * TICKS_PER_10_MICROSECONDS / 10);
+}
+
+unsigned long millis() {
+    DW1000Simulator::elapse(TIME_READ_COST);
+    return (unsigned long)(DW1000Simulator::now() / (100 * TICKS_PER_10_MICROSECONDS));
+}
+
+unsigned long micros() {
+    DW1000Simulator::elapse(TIME_READ_COST);
+    return (unsigned long)(DW1000Simulator::now() * 10 / TICKS_PER_10_MICROSECONDS);
+}
+
+void yield() {
+    DW1000Simulator::elapse(TIME_READ_COST);
+}
+
+void pinMode(uint8_t pin, uint8_t mode) {}
+
+void digitalWrite(uint8_t pin, uint8_t value) {
+    _pins[pin] = value;
+}
+
+int digitalRead(uint8_t pin) {
+    boolean handled;
+    int level = DW1000Simulator::readIrqPin(pin, handled);
+    return handled ? level : _pins[pin];
+}
+
+void attachInterrupt(int interruptNumber, void (*handler)(void), int mode) {
+    DW1000Simulator::attachIsr(interruptNumber, handler);
+}
+
+void detachInterrupt(int interruptNumber) {
+    DW1000Simulator::detachIsr(interruptNumber);
+}
+
+void noInterrupts() {
+    DW1000Simulator::setInterruptsEnabled(false);
+}
+
+void interrupts() {
+    DW1000Simulator::setInterruptsEnabled(true);
+}
+
+String::String(unsigned char value, unsigned char base) : _value(_number(value, base, false)) {}
+String::String(int value, unsigned char base) : _value(base == DEC ? _number(value < 0 ? -(long long)value : value, base, value < 0) : _number((unsigned int)value, base, false)) {}
+String::String(unsigned int value, unsigned char base) : _value(_number(value, base, false)) {}
+String::String(long value, unsigned char base) : _value(base == DEC ? _number(value < 0 ? -(long long)value : value, base, value < 0) : _number((unsigned long)value, base, false)) {}
+String::String(unsigned long value, unsigned char base) : _value(_number(value, base, false)) {}
+String::String(double value, unsigned char decimals) : _value(_decimal(value, decimals)) {}
+
+void String::getBytes(unsigned char buffer[], unsigned int size) const {
+    if(size == 0)
+        return;
+    unsigned int n = _value.length() < size - 1 ? _value.length() : size - 1;
+    memcpy(buffer, _value.c_str(), n);
+    buffer[n] = '\0';
+}
+
+/* each MCU runs on its own thread, lines are buffered per thread so output of different MCUs never interleaves */
+static thread_local std::string _serialLine;
+
+size_t HardwareSerial::_write(const char text[]) {
+    size_t n = 0;
+    for(; text[n] != '\0'; n++) {
+        _serialLine += text[n];
+        if(text[n] == '\n') {
+            fputs(DW1000Simulator::serialPrefix(), stdout);
+            fputs(_serialLine.c_str(), stdout);
+            _serialLine.clear();
+        }
+    }
+    return n;
+}
+
+size_t Print::print(const String& value) { return _write(value.c_str()); }
+size_t Print::print(const char value[]) { return _write(value); }
+size_t Print::print(char value) { char text[2] = {value, '\0'}; return _write(text); }
+size_t Print::print(unsigned char value, int base) { return print(String(value, base)); }
+size_t Print::print(int value, int base) { return print(String(value, base)); }
+size_t Print::print(unsigned int value, int base) { return print(String(value, base)); }
+size_t Print::print(long value, int base) { return print(String(value, base)); }
+size_t Print::print(unsigned long value, int base) { return print(String(value, base)); }
+size_t Print::print(double value, int decimals) { return print(String(value, decimals)); }
+size_t Print::println() { return _write("\n"); }
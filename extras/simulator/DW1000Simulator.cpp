@@ -0,0 +1,915 @@
+/*
+ * MIT License
+ * 
+ * Copyright (c) 2018 Michele Biondi, Andrea Salvatori
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ * @file DW1000Simulator.cpp
+ * Register level DW1000 model. Only what the driver relies on is modelled: register storage,
+ * SYS_CTRL commands, SYS_STATUS events, delayed TX/RX, frame wait timeout, frame filtering,
+ * timestamps from distance and clock error, RX power from free space path loss, OTP and SAR readings,
+ * automatic acknowledgement, deep sleep and SPI wake-up, the accumulator of an ideal channel.
+*/
+
+#include <vector>
+#include <map>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include "DW1000Simulator.hpp"
+#include "DW1000Ng.hpp"
+#include "DW1000NgConstants.hpp"
+#include "DW1000NgRegisters.hpp"
+#include "DW1000NgAirtime.hpp"
+#include "DW1000NgRTLS.hpp"
+
+namespace DW1000Simulator {
+
+    namespace {
+
+        constexpr uint64_t TIME_MASK = 0xFFFFFFFFFF;
+        constexpr uint64_t HALF_PERIOD = 0x8000000000;
+        constexpr double TICKS_PER_SECOND = 63897600000.0;
+        constexpr double SPEED_OF_LIGHT_IN_AIR = 299702547.0;
+
+        /* One unit of RX_FWTO and W4R_TIM, 512 / 499.2 MHz */
+        constexpr uint64_t WAIT_UNIT = 65536;
+        constexpr uint64_t TICKS_PER_MICROSECOND = 63898;
+        /* From the TXSTRT command to the first preamble symbol */
+        constexpr uint64_t TX_STARTUP = 3 * TICKS_PER_MICROSECOND;
+        /* A frame reaches the other nodes at least one preamble (64 symbols) after the TX command,
+           so every MCU may run this far ahead of the others without missing their frames */
+        constexpr uint64_t LOOKAHEAD = 32 * TICKS_PER_MICROSECOND;
+        /* Preamble symbols needed by a receiver to synchronize, on top of the SFD */
+        constexpr uint16_t ACQUISITION_SYMBOLS = 16;
+        /* From SPICSn low in DEEPSLEEP to IDLE: crystal start-up, AON restore and clock PLL lock */
+        constexpr uint64_t WAKEUP_TIME = 2200 * TICKS_PER_MICROSECOND;
+        /* LDE microcode load from ROM, LDELOAD clears at the end */
+        constexpr uint64_t LDE_LOAD_TIME = 120 * TICKS_PER_MICROSECOND;
+        /* Position of the direct path in the accumulator */
+        constexpr uint16_t FIRST_PATH_INDEX = 745;
+        constexpr uint16_t REFLECTION_DELAY = 4;    /* samples (~1 ns) */
+        /* Cost of a call to loop() */
+        constexpr uint64_t LOOP_OVERHEAD = TICKS_PER_MICROSECOND;
+        /* Chip select, transaction setup and the 5 us hold of the Arduino SPIporting backend */
+        constexpr uint64_t SPI_TRANSACTION_OVERHEAD_NS = 6000;
+
+        struct SimulationEnd {};
+
+        struct AirFrame {
+            uint8_t sender;
+            uint64_t rmarker;           /* global time the RMARKER leaves the sender antenna */
+            uint64_t acquisition;       /* preamble and SFD */
+            uint64_t payload;           /* PHR and data, from the RMARKER to the end of the frame */
+            std::vector<byte> data;
+            uint8_t channel, prf, code, rate;
+            uint16_t preambleSymbols;
+            std::vector<bool> handled; /* per node */
+        };
+
+        struct Node {
+            uint8_t ss, irq, mcu;
+            node_configuration_t config;
+            std::map<uint8_t, std::vector<byte>> registers;
+            std::map<uint16_t, uint32_t> otp;
+            uint64_t epoch;             /* local clock at global time 0 */
+
+            bool txActive;
+            uint64_t txEnd;
+            uint64_t txStamp;           /* local RMARKER time, TX_STAMP before antenna delay */
+            AirFrame* txFrame;
+            bool wait4resp;
+
+            bool rxOn;
+            uint64_t rxStart;
+            bool rxDeadlineActive;
+            uint64_t rxDeadline;
+
+            bool irqLevel;
+            bool irqPending;
+
+            bool asleep;
+            uint64_t wakeup;            /* time the device is ready again, 0 until SPICSn wakes it */
+            uint64_t ldeLoaded;         /* time the LDE microcode load ends */
+        };
+
+        struct Mcu {
+            uint64_t now = 0;
+            bool finished = false;
+            bool interruptsEnabled = true;
+            bool inInterrupt = false;
+            std::map<int, void (*)(void)> isrs;
+            DW1000NgDevice device;
+            DW1000NgDevice* selected = nullptr;
+            char prefix[32] = "";
+        };
+
+        Mcu _host;
+        std::vector<Mcu*> _mcus;
+        std::vector<Node*> _nodes;
+        std::vector<AirFrame*> _air;
+        spi_statistics_t _statistics = {0, 0, 0};
+
+        thread_local uint8_t _current = 0;
+        boolean _running = false;
+        uint64_t _end = UINT64_MAX;
+        uint8_t _turn = 0;
+        std::mutex _turnMutex;
+        std::condition_variable _turnChanged;
+
+        Mcu& _me() {
+            if(_mcus.empty())
+                _mcus.push_back(&_host);
+            return *_mcus[_current];
+        }
+
+        /* ####################### registers ####################### */
+
+        std::vector<byte>& _register(Node& node, uint8_t reg, size_t size) {
+            std::vector<byte>& bytes = node.registers[reg];
+            if(bytes.size() < size)
+                bytes.resize(size, 0);
+            return bytes;
+        }
+
+        uint64_t _getValue(Node& node, uint8_t reg, uint16_t offset, uint8_t length) {
+            std::vector<byte>& bytes = _register(node, reg, offset + length);
+            uint64_t value = 0;
+            for(uint8_t i = 0; i < length; i++)
+                value |= (uint64_t)bytes[offset + i] << (8 * i);
+            return value;
+        }
+
+        void _setValue(Node& node, uint8_t reg, uint16_t offset, uint8_t length, uint64_t value) {
+            std::vector<byte>& bytes = _register(node, reg, offset + length);
+            for(uint8_t i = 0; i < length; i++)
+                bytes[offset + i] = (byte)(value >> (8 * i));
+        }
+
+        uint32_t _status(Node& node) {
+            return (uint32_t)_getValue(node, SYS_STATUS, 0, 4);
+        }
+
+        void _updateIrq(Node& node) {
+            boolean level = (_status(node) & (uint32_t)_getValue(node, SYS_MASK, 0, 4)) != 0;
+            if(level && !node.irqLevel)
+                node.irqPending = true;
+            node.irqLevel = level;
+        }
+
+        /* event counters (DIG_DIAG) of the events the model produces */
+        void _countEvents(Node& node, uint32_t bits) {
+            if(!(_getValue(node, DIG_DIAG, EVC_CTRL_SUB, 1) & (1 << EVC_EN_BIT)))
+                return;
+            const struct { uint8_t bit; uint16_t counter; } events[] = {
+                {RXFCG_BIT, EVC_FCG_SUB}, {AFFREJ_BIT, EVC_FFR_SUB}, {RXRFTO_BIT, EVC_FWTO_SUB},
+                {TXFRS_BIT, EVC_TXFS_SUB}, {HPDWARN_BIT, EVC_HPW_SUB}
+            };
+            for(const auto& event : events) {
+                if(bits & (1UL << event.bit))
+                    _setValue(node, DIG_DIAG, event.counter, 2, (_getValue(node, DIG_DIAG, event.counter, 2) + 1) & EVC_COUNTER_MASK);
+            }
+        }
+
+        void _setStatus(Node& node, uint32_t bits) {
+            _countEvents(node, bits);
+            _setValue(node, SYS_STATUS, 0, 4, _status(node) | bits);
+            _updateIrq(node);
+        }
+
+        void _powerOnReset(Node& node) {
+            node.registers.clear();
+            _setValue(node, DEV_ID, 0, 4, 0xDECA0130);
+            _setValue(node, EUI, 0, 4, node.otp[0x000]);
+            _setValue(node, EUI, 4, 4, node.otp[0x001]);
+            _setValue(node, PANADR, 0, 4, 0xFFFFFFFF);
+            _setValue(node, SYS_CFG, 0, 4, 0x00001200);
+            _setValue(node, TX_FCTRL, 0, 4, 0x0015400C);
+            _setValue(node, CHAN_CTRL, 0, 4, 0x00000055);
+            _setValue(node, SYS_STATUS, 0, 4, 1UL << CPLOCK_BIT);
+            node.txActive = false;
+            node.txFrame = nullptr;
+            node.rxOn = false;
+            node.irqLevel = false;
+            node.irqPending = false;
+            node.asleep = false;
+            node.wakeup = 0;
+            node.ldeLoaded = 0;
+        }
+
+        /* SAVE with SLEEP_EN enters DEEPSLEEP: the transceiver stops and SPI is ignored until SPICSn wakes the device */
+        void _sleep(Node& node) {
+            node.txActive = false;
+            node.rxOn = false;
+            node.asleep = true;
+            node.wakeup = 0;
+        }
+
+        /* The AON block restores the configuration (ONW_LDC), TX_ANTD is not kept */
+        void _wake(Node& node) {
+            node.asleep = false;
+            _setValue(node, TX_ANTD, 0, 2, 0);
+            _setValue(node, SYS_STATUS, 0, 4, (1UL << CPLOCK_BIT) | (1UL << SLP2INIT_BIT));
+            _updateIrq(node);
+        }
+
+        /* ####################### time ####################### */
+
+        uint64_t _localTime(const Node& node, uint64_t global) {
+            int64_t drift = (int64_t)llround((double)global * node.config.clockErrorPpb * 1e-9);
+            return (node.epoch + global + drift) & TIME_MASK;
+        }
+
+        /* Global time at which the local clock reaches target, late if it is more than half a period away */
+        uint64_t _globalTime(const Node& node, uint64_t now, uint64_t target, boolean& late) {
+            uint64_t delta = (target - _localTime(node, now)) & TIME_MASK;
+            late = delta >= HALF_PERIOD;
+            return now + (uint64_t)llround((double)delta * 1e9 / (1e9 + node.config.clockErrorPpb));
+        }
+
+        uint64_t _nanosecondsToTicks(uint64_t nanoseconds) {
+            return nanoseconds * 638976 / 10000;
+        }
+
+        /* ####################### air ####################### */
+
+        uint64_t _symbolDuration(uint8_t prf) {
+            return DW1000NgAirtime::preambleSymbolDuration(static_cast<PulseFrequency>(prf));
+        }
+
+        double _channelFrequency(uint8_t channel) {
+            switch(channel) {
+                case 1: return 3494.4e6;
+                case 2: case 4: return 3993.6e6;
+                case 3: return 4492.8e6;
+                default: return 6489.6e6;
+            }
+        }
+
+        double _distance(const Node& a, const Node& b) {
+            double dx = a.config.x - b.config.x;
+            double dy = a.config.y - b.config.y;
+            double dz = a.config.z - b.config.z;
+            return sqrt(dx*dx + dy*dy + dz*dz);
+        }
+
+        /* Global time at which the receiver digital RMARKER and the frame end are reached */
+        uint64_t _arrival(const AirFrame& frame, const Node& receiver) {
+            double timeOfFlight = _distance(*_nodes[frame.sender], receiver) / SPEED_OF_LIGHT_IN_AIR * TICKS_PER_SECOND;
+            return frame.rmarker + (uint64_t)llround(timeOfFlight) + receiver.config.antennaDelay;
+        }
+
+        uint64_t _completion(const AirFrame& frame, const Node& receiver) {
+            return _arrival(frame, receiver) + frame.payload;
+        }
+
+        /* Inverse of the driver power estimation (user manual 4.7), so getReceivePower reads back the modelled power */
+        uint16_t _powerRegister(double power, uint8_t prf, double divider, uint16_t N) {
+            double A = prf == 2 ? 121.74 : 113.77;
+            double correction = prf == 2 ? 1.1667 : 2.3334;
+            double estimate = power <= -88 ? power : (power - 88 * correction) / (1 + correction);
+            double value = pow(10, (estimate + A) / 10) * N * N / divider;
+            return value < 1 ? 1 : (value > 65535 ? 65535 : (uint16_t)lround(value));
+        }
+
+        /* The direct path spread over the three samples read by the LDE (FP_AMPL1..3),
+           plus a stronger reflection when the direct path is attenuated */
+        void _writeAccumulator(Node& node, uint8_t prf, uint16_t firstPath, uint16_t reflection) {
+            std::vector<byte>& accumulator = _register(node, ACC_MEM, (prf == 2 ? ACC_SAMPLES_64MHZ : ACC_SAMPLES_16MHZ) * LEN_ACC_SAMPLE);
+            std::fill(accumulator.begin(), accumulator.end(), 0);
+            for(uint16_t sample = FIRST_PATH_INDEX; sample < FIRST_PATH_INDEX + 3; sample++)
+                _setValue(node, ACC_MEM, sample * LEN_ACC_SAMPLE, 2, firstPath > 0x7FFF ? 0x7FFF : firstPath);
+            if(reflection > firstPath)
+                _setValue(node, ACC_MEM, (FIRST_PATH_INDEX + REFLECTION_DELAY) * LEN_ACC_SAMPLE, 2, reflection > 0x7FFF ? 0x7FFF : reflection);
+        }
+
+        boolean _addressedTo(Node& node, const std::vector<byte>& data) {
+            uint32_t syscfg = (uint32_t)_getValue(node, SYS_CFG, 0, 4);
+            if(!(syscfg & (1UL << FFEN_BIT)))
+                return true;
+            if(data.size() < 3)
+                return false;
+            uint8_t type = data[0] & 0x07;
+            static const uint16_t allowBits[] = {FFAB_BIT, FFAD_BIT, FFAA_BIT, FFAM_BIT, FFAR_BIT, FFA5_BIT, FFAR_BIT, FFAR_BIT};
+            if(type == 4 && (syscfg & (1UL << FFA4_BIT)))
+                return true;
+            if(!(syscfg & (1UL << allowBits[type])))
+                return false;
+            /* no address filtering for acknowledgments and reserved frames (e.g. blinks) */
+            if(type == 2 || type > 3)
+                return true;
+            uint8_t destinationMode = (data[1] >> 2) & 0x03;
+            if(destinationMode == 0)
+                return (syscfg & (1UL << FFBC_BIT)) != 0;
+            size_t addressLength = destinationMode == 3 ? 8 : 2;
+            if(data.size() < 5 + addressLength)
+                return false;
+            uint16_t pan = data[3] | (data[4] << 8);
+            if(pan != 0xFFFF && pan != (uint16_t)_getValue(node, PANADR, 2, 2))
+                return false;
+            if(addressLength == 2) {
+                uint16_t address = data[5] | (data[6] << 8);
+                return address == 0xFFFF || address == (uint16_t)_getValue(node, PANADR, 0, 2);
+            }
+            return memcmp(&data[5], _register(node, EUI, 8).data(), 8) == 0;
+        }
+
+        /* returns true if the frame was received */
+        boolean _deliver(Node& node, AirFrame& frame, uint64_t arrival) {
+            uint32_t chanctrl = (uint32_t)_getValue(node, CHAN_CTRL, 0, 4);
+            boolean receiver110k = (_getValue(node, SYS_CFG, 0, 4) >> RXM110K_BIT) & 0x01;
+            /* the receiver must be on early enough to synchronize on the preamble and detect the SFD */
+            uint64_t synchronization = (ACQUISITION_SYMBOLS + (frame.rate == 0 ? 64 : 8)) * _symbolDuration(frame.prf);
+            if(!node.rxOn
+                || node.rxStart + synchronization > arrival
+                || frame.channel != ((chanctrl >> 4) & 0x0F)
+                || frame.prf != ((chanctrl >> 18) & 0x03)
+                || frame.code != ((chanctrl >> 27) & 0x1F)
+                || (frame.rate == 0) != receiver110k)
+                return false;
+
+            if(!_addressedTo(node, frame.data)) {
+                _setStatus(node, 1UL << AFFREJ_BIT);
+                return false;
+            }
+
+            node.rxOn = false;
+            std::vector<byte>& buffer = _register(node, RX_BUFFER, frame.data.size());
+            std::copy(frame.data.begin(), frame.data.end(), buffer.begin());
+
+            uint16_t N = frame.preambleSymbols > 32 ? frame.preambleSymbols - 16 : frame.preambleSymbols;
+            _setValue(node, RX_FINFO, 0, 4, (frame.data.size() & 0x3FF) | ((uint32_t)frame.rate << 13) | ((uint32_t)(N & 0xFFF) << 20));
+
+            const Node& sender = *_nodes[frame.sender];
+            double distance = _distance(sender, node);
+            if(distance < 0.1)
+                distance = 0.1;
+            double power = -14.3 - 20 * log10(4 * M_PI * distance * _channelFrequency(frame.channel) / SPEED_OF_LIGHT_IN_AIR)
+                - node.config.extraPathLoss - sender.config.extraPathLoss;
+            /* FP_AMPL registers hold amplitudes: the squared value is computed over 65536 to fit the power register */
+            double directPathLoss = node.config.directPathLoss + sender.config.directPathLoss;
+            uint16_t firstPath = (uint16_t)sqrt((double)_powerRegister(power - 2 - directPathLoss, frame.prf, 3 * 65536.0, N) * 65536);
+            uint16_t reflection = directPathLoss > 0 ? (uint16_t)sqrt((double)_powerRegister(power - 2, frame.prf, 3 * 65536.0, N) * 65536) : 0;
+
+            uint64_t localArrival = _localTime(node, arrival);
+            uint64_t rxAntennaDelay = _getValue(node, LDE_IF, LDE_RXANTD_SUB, 2);
+            _setValue(node, RX_TIME, RX_STAMP_SUB, 5, (localArrival - rxAntennaDelay) & TIME_MASK);
+            _setValue(node, RX_TIME, FP_INDEX_SUB, 2, FIRST_PATH_INDEX << 6);
+            _setValue(node, RX_TIME, FP_AMPL1_SUB, 2, firstPath);
+            _setValue(node, RX_TIME, 9, 5, localArrival);       /* RX_RAWST */
+            _setValue(node, RX_FQUAL, STD_NOISE_SUB, 2, 48);
+            _setValue(node, RX_FQUAL, FP_AMPL2_SUB, 2, firstPath);
+            _setValue(node, RX_FQUAL, FP_AMPL3_SUB, 2, firstPath);
+            _setValue(node, RX_FQUAL, CIR_PWR_SUB, 2, _powerRegister(power, frame.prf, 131072, N));
+            _writeAccumulator(node, frame.prf, firstPath, reflection);
+
+            _setStatus(node, (1UL << RXPRD_BIT) | (1UL << RXSFDD_BIT) | (1UL << LDEDONE_BIT) |
+                (1UL << RXPHD_BIT) | (1UL << RXDFR_BIT) | (1UL << RXFCG_BIT));
+            return true;
+        }
+
+        void _removeFrame(AirFrame* frame) {
+            for(size_t i = 0; i < _air.size(); i++) {
+                if(_air[i] == frame) {
+                    _air.erase(_air.begin() + i);
+                    break;
+                }
+            }
+            for(Node* node : _nodes) {
+                if(node->txFrame == frame)
+                    node->txFrame = nullptr;
+            }
+            delete frame;
+        }
+
+        void _startReceive(Node& node, uint64_t now, boolean delayed) {
+            node.rxOn = true;
+            node.rxStart = now;
+            if(delayed) {
+                boolean late;
+                node.rxStart = _globalTime(node, now, _getValue(node, DX_TIME, 0, 5) & ~0x1FFULL, late);
+                if(late)
+                    _setStatus(node, 1UL << HPDWARN_BIT);
+            }
+            node.rxDeadlineActive = (_getValue(node, SYS_CFG, 0, 4) >> RXWTOE_BIT) & 0x01;
+            node.rxDeadline = node.rxStart + _getValue(node, RX_WFTO, 0, 2) * WAIT_UNIT;
+        }
+
+        frame_airtime_t _transmitAirtime(Node& node, uint16_t length) {
+            uint32_t txfctrl = (uint32_t)_getValue(node, TX_FCTRL, 0, 4);
+            uint32_t chanctrl = (uint32_t)_getValue(node, CHAN_CTRL, 0, 4);
+            PreambleLength preambleLength = static_cast<PreambleLength>((txfctrl >> 18) & 0x0F);
+            SFDMode sfd = (chanctrl >> DWSFD_BIT) & 0x01 ? SFDMode::DECAWAVE_SFD : SFDMode::STANDARD_SFD;
+            return DW1000NgAirtime::frameAirtime(preambleLength, static_cast<PulseFrequency>((txfctrl >> 16) & 0x03),
+                static_cast<DataRate>((txfctrl >> 13) & 0x03), sfd, length);
+        }
+
+        /* Puts a frame on air with the PHY settings of TX_FCTRL and CHAN_CTRL, its RMARKER leaves the chip at rmarker */
+        void _emit(Node& node, uint8_t index, const byte data[], uint16_t length, uint64_t rmarker) {
+            uint32_t txfctrl = (uint32_t)_getValue(node, TX_FCTRL, 0, 4);
+            uint32_t chanctrl = (uint32_t)_getValue(node, CHAN_CTRL, 0, 4);
+            frame_airtime_t airtime = _transmitAirtime(node, length);
+
+            node.txActive = true;
+            node.txEnd = rmarker + airtime.phr + airtime.payload;
+
+            AirFrame* frame = new AirFrame();
+            frame->sender = index;
+            frame->rmarker = rmarker + node.config.antennaDelay;
+            frame->acquisition = airtime.shr;
+            frame->payload = airtime.phr + airtime.payload;
+            frame->data.assign(data, data + length);
+            frame->channel = chanctrl & 0x0F;
+            frame->prf = (txfctrl >> 16) & 0x03;
+            frame->code = (chanctrl >> 22) & 0x1F;
+            frame->rate = (txfctrl >> 13) & 0x03;
+            frame->preambleSymbols = DW1000NgAirtime::preambleSymbols(static_cast<PreambleLength>((txfctrl >> 18) & 0x0F));
+            frame->handled.assign(_nodes.size(), false);
+            frame->handled[index] = true;
+            _air.push_back(frame);
+            node.txFrame = frame;
+        }
+
+        void _startTransmit(Node& node, uint8_t index, uint64_t now, boolean delayed) {
+            uint16_t length = (uint32_t)_getValue(node, TX_FCTRL, 0, 4) & 0x3FF;
+            uint64_t acquisition = _transmitAirtime(node, length).shr;
+
+            node.rxOn = false;
+            uint64_t rmarker;
+            if(delayed) {
+                /* the preamble has to start before DX_TIME, if that moment passed the chip waits for the wrap */
+                uint64_t target = _getValue(node, DX_TIME, 0, 5) & ~0x1FFULL;
+                boolean late;
+                rmarker = _globalTime(node, now, (target - acquisition - TX_STARTUP) & TIME_MASK, late) + acquisition + TX_STARTUP;
+                if(late) {
+                    /* the RMARKER is still ahead but there is no time left for the power-up and the whole preamble:
+                       it leaves on time with a shortened preamble (TXPUTE) */
+                    boolean missed;
+                    uint64_t onTime = _globalTime(node, now, target, missed);
+                    if(!missed && onTime >= now + TX_STARTUP) {
+                        _setValue(node, SYS_STATUS, 4, 1, _getValue(node, SYS_STATUS, 4, 1) | (1 << TXPUTE_BIT));
+                        acquisition = onTime - now - TX_STARTUP;
+                        rmarker = onTime;
+                    } else {
+                        _setStatus(node, 1UL << HPDWARN_BIT);
+                    }
+                }
+                node.txStamp = target;
+            } else {
+                rmarker = now + TX_STARTUP + acquisition;
+                node.txStamp = _localTime(node, rmarker);
+            }
+            _emit(node, index, _register(node, TX_BUFFER, length).data(), length, rmarker);
+            node.txFrame->acquisition = acquisition;
+        }
+
+        /* Automatic acknowledgement (AUTOACK): data and MAC command frames with the ACK request bit, not broadcast */
+        boolean _acknowledgeRequested(Node& node, const std::vector<byte>& data) {
+            uint32_t syscfg = (uint32_t)_getValue(node, SYS_CFG, 0, 4);
+            if(!(syscfg & (1UL << FFEN_BIT)) || !(syscfg & (1UL << AUTOACK_BIT)) || data.size() < 7)
+                return false;
+            uint8_t type = data[0] & 0x07;
+            uint8_t destinationMode = (data[1] >> 2) & 0x03;
+            if(!(data[0] & ACK_REQUEST) || (type != 1 && type != 3) || destinationMode == 0)
+                return false;
+            return destinationMode == 3 || (data[5] & data[6]) != 0xFF;
+        }
+
+        /* The ACK preamble starts ACK_TIM preamble symbols after the end of the acknowledged frame */
+        void _sendAcknowledge(Node& node, uint8_t index, const AirFrame& received, uint64_t frameEnd) {
+            byte ack[DW1000NgAirtime::ACKNOWLEDGEMENT_LENGTH + 2] = {ACKNOWLEDGEMENT, 0, received.data[2], 0, 0};
+            uint64_t turnaround = _getValue(node, ACK_RESP_T, ACK_RESP_T_ACK_TIM_SUB, 1) * _symbolDuration((_getValue(node, TX_FCTRL, 0, 4) >> 16) & 0x03);
+            uint64_t rmarker = frameEnd + turnaround + _transmitAirtime(node, sizeof(ack)).shr;
+            node.rxOn = false;
+            node.wait4resp = false;
+            node.txStamp = _localTime(node, rmarker);
+            _emit(node, index, ack, sizeof(ack), rmarker);
+            _setStatus(node, 1UL << AAT_BIT);
+        }
+
+        void _systemControl(Node& node, uint8_t index, uint32_t command, uint64_t now) {
+            if(command & (1UL << TRXOFF_BIT)) {
+                /* a frame whose preamble did not start yet never reaches the air */
+                if(node.txActive && node.txFrame != nullptr && node.txFrame->rmarker - node.txFrame->acquisition > now)
+                    _removeFrame(node.txFrame);
+                node.txActive = false;
+                node.rxOn = false;
+            }
+            if(command & (1UL << TXSTRT_BIT)) {
+                node.wait4resp = (command & (1UL << WAIT4RESP_BIT)) != 0;
+                _startTransmit(node, index, now, (command & (1UL << TXDLYS_BIT)) != 0);
+            }
+            if(command & (1UL << RXENAB_BIT))
+                _startReceive(node, now, (command & (1UL << RXDLYS_BIT)) != 0);
+        }
+
+        /* Handles the events of node up to time, in order */
+        void _processNode(Node& node, uint8_t index, uint64_t time) {
+            while(true) {
+                uint64_t next = UINT64_MAX;
+                AirFrame* nextFrame = nullptr;
+                if(node.txActive)
+                    next = node.txEnd;
+                if(node.rxOn && node.rxDeadlineActive && node.rxDeadline < next)
+                    next = node.rxDeadline;
+                for(AirFrame* frame : _air) {
+                    if(index < frame->handled.size() && !frame->handled[index] && _completion(*frame, node) < next) {
+                        next = _completion(*frame, node);
+                        nextFrame = frame;
+                    }
+                }
+                if(next > time)
+                    return;
+
+                if(nextFrame != nullptr) {
+                    nextFrame->handled[index] = true;
+                    if(_deliver(node, *nextFrame, _arrival(*nextFrame, node)) && _acknowledgeRequested(node, nextFrame->data))
+                        _sendAcknowledge(node, index, *nextFrame, _completion(*nextFrame, node));
+                    boolean done = true;
+                    for(bool handled : nextFrame->handled)
+                        done = done && handled;
+                    if(done)
+                        _removeFrame(nextFrame);
+                } else if(node.txActive && node.txEnd == next) {
+                    node.txActive = false;
+                    _setValue(node, TX_TIME, TX_STAMP_SUB, 5, (node.txStamp + _getValue(node, TX_ANTD, 0, 2)) & TIME_MASK);
+                    _setValue(node, TX_TIME, 5, 5, node.txStamp);   /* TX_RAWST */
+                    _setStatus(node, (1UL << TXFRB_BIT) | (1UL << TXPRS_BIT) | (1UL << TXPHS_BIT) | (1UL << TXFRS_BIT));
+                    if(node.wait4resp) {
+                        _startReceive(node, node.txEnd + (_getValue(node, ACK_RESP_T, 0, 3) & 0xFFFFF) * WAIT_UNIT, false);
+                    }
+                } else {
+                    node.rxOn = false;
+                    _setStatus(node, 1UL << RXRFTO_BIT);
+                }
+            }
+        }
+
+        uint64_t _nextEvent(uint8_t mcu) {
+            uint64_t next = UINT64_MAX;
+            for(size_t i = 0; i < _nodes.size(); i++) {
+                Node& node = *_nodes[i];
+                if(node.mcu != mcu)
+                    continue;
+                if(node.txActive && node.txEnd < next)
+                    next = node.txEnd;
+                if(node.rxOn && node.rxDeadlineActive && node.rxDeadline < next)
+                    next = node.rxDeadline;
+                for(AirFrame* frame : _air) {
+                    if(i < frame->handled.size() && !frame->handled[i] && _completion(*frame, node) < next)
+                        next = _completion(*frame, node);
+                }
+            }
+            return next;
+        }
+
+        void _writeRegister(Node& node, uint8_t index, uint8_t reg, uint16_t offset, const byte data[], uint16_t length, uint64_t now) {
+            switch(reg) {
+                case SYS_CTRL: {
+                    uint32_t command = 0;
+                    for(uint16_t i = 0; i < length && offset + i < 4; i++)
+                        command |= (uint32_t)data[i] << (8 * (offset + i));
+                    _systemControl(node, index, command, now);
+                    return;
+                }
+                case SYS_STATUS: {
+                    /* write 1 to clear */
+                    std::vector<byte>& status = _register(node, SYS_STATUS, offset + length);
+                    for(uint16_t i = 0; i < length; i++)
+                        status[offset + i] &= ~data[i];
+                    _updateIrq(node);
+                    return;
+                }
+                case DEV_ID: case SYS_TIME: case RX_FINFO: case RX_BUFFER: case RX_FQUAL: case RX_TIME: case TX_TIME: case ACC_MEM:
+                    return;
+            }
+
+            std::vector<byte>& bytes = _register(node, reg, offset + length);
+            std::copy(data, data + length, bytes.begin() + offset);
+
+            if(reg == SYS_MASK) {
+                _updateIrq(node);
+            } else if(reg == OTP_IF && offset <= OTP_CTRL_SUB && offset + length > OTP_CTRL_SUB) {
+                if(_getValue(node, OTP_IF, OTP_CTRL_SUB, 1) & 0x02)
+                    _setValue(node, OTP_IF, OTP_RDAT_SUB, 4, node.otp[_getValue(node, OTP_IF, OTP_ADDR_SUB, 2) & 0x7FF]);
+                if((_getValue(node, OTP_IF, OTP_CTRL_SUB, 2) >> LDELOAD_BIT) & 0x01)
+                    node.ldeLoaded = now + LDE_LOAD_TIME;
+            } else if(reg == TX_CAL && offset == 0 && (data[0] & 0x01)) {
+                /* SAR conversion, see getTemperatureAndBatteryVoltage */
+                uint8_t vmeas = node.otp[0x008] & 0xFF;
+                uint8_t tmeas = node.otp[0x009] & 0xFF;
+                _setValue(node, TX_CAL, 0x03, 1, (uint8_t)(vmeas + lround((node.config.voltage - 3.3f) * 173.0f)));
+                _setValue(node, TX_CAL, 0x04, 1, (uint8_t)(tmeas + lround((node.config.temperature - 23.0f) / 1.14f)));
+            } else if(reg == DIG_DIAG && offset == EVC_CTRL_SUB && (data[0] & (1 << EVC_CLR_BIT))) {
+                for(uint16_t counter = EVC_PHE_SUB; counter < EVC_PHE_SUB + LEN_EVC_COUNTERS; counter += 2)
+                    _setValue(node, DIG_DIAG, counter, 2, 0);
+                _setValue(node, DIG_DIAG, EVC_CTRL_SUB, 1, data[0] & ~(1 << EVC_CLR_BIT));
+            } else if(reg == AON && offset == AON_CTRL_SUB && (data[0] & (1 << SAVE_BIT))) {
+                if(_getValue(node, AON, AON_CFG0_SUB, 1) & (1 << SLEEP_EN_BIT))
+                    _sleep(node);
+            } else if(reg == PMSC && offset <= PMSC_SOFTRESET_SUB && offset + length > PMSC_SOFTRESET_SUB) {
+                uint8_t softreset = _getValue(node, PMSC, PMSC_SOFTRESET_SUB, 1);
+                if(softreset == 0x00) {
+                    _powerOnReset(node);
+                    _setValue(node, PMSC, PMSC_SOFTRESET_SUB, 1, 0x00);
+                } else if(softreset == 0xE0) {
+                    node.rxOn = false;
+                }
+            }
+        }
+
+        void _readRegister(Node& node, uint8_t reg, uint16_t offset, byte data[], uint16_t length, uint64_t now) {
+            if(reg == SYS_TIME) {
+                /* the counter runs at 125 MHz, the 9 low order bits are always 0 */
+                _setValue(node, SYS_TIME, 0, 5, _localTime(node, now) & ~0x1FFULL);
+            } else if(reg == SYS_CTRL) {
+                _setValue(node, SYS_CTRL, 0, 4, 0);
+            } else if(reg == OTP_IF && now >= node.ldeLoaded) {
+                _setValue(node, OTP_IF, OTP_CTRL_SUB, 2, _getValue(node, OTP_IF, OTP_CTRL_SUB, 2) & ~(1UL << LDELOAD_BIT));
+            }
+            if(reg == ACC_MEM && length > 0) {
+                /* the accumulator answers a dummy byte first, and only with its clocks enabled:
+                   FACE, AMCE and an RX clock, which RXCLKS auto (00) gates while the receiver is off */
+                data[0] = 0;
+                data++;
+                length--;
+                uint32_t pmscctrl0 = _getValue(node, PMSC, PMSC_CTRL0_SUB, 4);
+                uint32_t clocks = (1UL << FACE_BIT) | (1UL << AMCE_BIT);
+                uint8_t rxClock = (pmscctrl0 >> RXCLKS_BIT) & 0x03;
+                if((pmscctrl0 & clocks) != clocks || (rxClock == 0 && !node.rxOn)) {
+                    memset(data, 0, length);
+                    return;
+                }
+            }
+            std::vector<byte>& bytes = _register(node, reg, offset + length);
+            std::copy(bytes.begin() + offset, bytes.begin() + offset + length, data);
+        }
+
+        /* ####################### MCUs ####################### */
+
+        void _switchTo(uint8_t mcu) {
+            Mcu& me = _me();
+            me.selected = &DW1000Ng::getSelectedDevice();
+            {
+                std::unique_lock<std::mutex> lock(_turnMutex);
+                _turn = mcu;
+                _turnChanged.notify_all();
+                _turnChanged.wait(lock, []{ return _turn == _current; });
+            }
+            DW1000Ng::select(*me.selected);
+        }
+
+        /* Lets the MCUs that are behind catch up */
+        void _waitForOthers() {
+            if(!_running)
+                return;
+            while(true) {
+                uint8_t slowest = 0;
+                for(uint8_t i = 1; i < _mcus.size(); i++) {
+                    if(i != _current && !_mcus[i]->finished && (slowest == 0 || _mcus[i]->now < _mcus[slowest]->now))
+                        slowest = i;
+                }
+                if(slowest == 0 || _me().now <= _mcus[slowest]->now + LOOKAHEAD)
+                    return;
+                _switchTo(slowest);
+            }
+        }
+
+        void _finish() {
+            _me().finished = true;
+            uint8_t slowest = 0;
+            for(uint8_t i = 1; i < _mcus.size(); i++) {
+                if(!_mcus[i]->finished && (slowest == 0 || _mcus[i]->now < _mcus[slowest]->now))
+                    slowest = i;
+            }
+            std::unique_lock<std::mutex> lock(_turnMutex);
+            _turn = slowest;
+            _turnChanged.notify_all();
+        }
+
+        void _serviceInterrupts() {
+            Mcu& me = _me();
+            boolean serviced = true;
+            while(serviced && me.interruptsEnabled && !me.inInterrupt) {
+                serviced = false;
+                for(Node* node : _nodes) {
+                    if(node->mcu != _current || !node->irqPending)
+                        continue;
+                    node->irqPending = false;
+                    std::map<int, void (*)(void)>::iterator isr = me.isrs.find(digitalPinToInterrupt(node->irq));
+                    if(isr == me.isrs.end())
+                        continue;
+                    me.inInterrupt = true;
+                    isr->second();
+                    me.inInterrupt = false;
+                    serviced = true;
+                }
+            }
+        }
+
+        void _processEvents() {
+            for(size_t i = 0; i < _nodes.size(); i++) {
+                if(_nodes[i]->mcu == _current)
+                    _processNode(*_nodes[i], i, _me().now);
+            }
+        }
+
+        void _mcuMain(uint8_t index, mcu_program_t program) {
+            _current = index;
+            {
+                std::unique_lock<std::mutex> lock(_turnMutex);
+                _turnChanged.wait(lock, [index]{ return _turn == index; });
+            }
+            Mcu& me = _me();
+            DW1000Ng::select(me.device);
+            try {
+                program.setup();
+                while(true) {
+                    program.loop();
+                    elapse(LOOP_OVERHEAD);
+                }
+            } catch(SimulationEnd&) {
+            }
+            _finish();
+        }
+    }
+
+    node_configuration_t defaultNodeConfiguration() {
+        return {0, 0, 0, 0, 16436, 0, 0, 23.0f, 3.3f};
+    }
+
+    uint8_t addNode(uint8_t ss, uint8_t irq, const node_configuration_t& configuration) {
+        Node* node = new Node();
+        uint8_t index = _nodes.size();
+        node->ss = ss;
+        node->irq = irq;
+        node->mcu = _current;
+        node->config = configuration;
+        node->epoch = ((uint64_t)index * 0x1234567891ULL + 0x0ABCDEF012ULL) & TIME_MASK;
+        node->otp[0x000] = 0x00001000 + index;  /* EUI */
+        node->otp[0x001] = 0x01020304;
+        node->otp[0x006] = 0x00000001;          /* part ID */
+        node->otp[0x008] = 0x9A;                /* 3.3 V SAR reading */
+        node->otp[0x009] = 0x80;                /* 23 C SAR reading */
+        node->otp[0x01E] = 0x10;                /* crystal trim */
+        _powerOnReset(*node);
+        _nodes.push_back(node);
+        return index;
+    }
+
+    void moveNode(uint8_t node, double x, double y, double z) {
+        _nodes[node]->config.x = x;
+        _nodes[node]->config.y = y;
+        _nodes[node]->config.z = z;
+    }
+
+    void setRegister(uint8_t node, uint8_t reg, uint16_t offset, uint8_t length, uint64_t value) {
+        _setValue(*_nodes[node], reg, offset, length, value);
+    }
+
+    void run(const mcu_program_t programs[], uint8_t count, uint32_t durationMilliseconds) {
+        Mcu& host = _me();
+        _end = host.now + (uint64_t)durationMilliseconds * 1000 * TICKS_PER_MICROSECOND;
+        for(uint8_t i = 0; i < count; i++) {
+            Mcu* mcu = new Mcu();
+            mcu->now = host.now;
+            snprintf(mcu->prefix, sizeof(mcu->prefix), "[mcu %u ", i + 1);
+            _mcus.push_back(mcu);
+        }
+        _running = true;
+        _turn = 1;
+        std::vector<std::thread> threads;
+        for(uint8_t i = 0; i < count; i++)
+            threads.push_back(std::thread(_mcuMain, i + 1, programs[i]));
+        for(std::thread& thread : threads)
+            thread.join();
+        _running = false;
+
+        host.now = _end;
+        _end = UINT64_MAX;
+        for(uint8_t i = 1; i < _mcus.size(); i++)
+            delete _mcus[i];
+        _mcus.resize(1);
+        for(AirFrame* frame : _air)
+            delete frame;
+        _air.clear();
+        for(Node* node : _nodes)
+            delete node;
+        _nodes.clear();
+        DW1000Ng::select(DW1000Ng::getDefaultDevice());
+    }
+
+    uint64_t now() {
+        return _me().now;
+    }
+
+    spi_statistics_t getSpiStatistics() {
+        return _statistics;
+    }
+
+    void resetSpiStatistics() {
+        _statistics = {0, 0, 0};
+    }
+
+    void elapse(uint64_t ticks) {
+        Mcu& me = _me();
+        uint64_t target = me.now + ticks;
+        do {
+            uint64_t next = _nextEvent(_current);
+            me.now = next < target ? (next > me.now ? next : me.now) : target;
+            _waitForOthers();
+            _processEvents();
+            _serviceInterrupts();
+            if(me.now >= _end)
+                throw SimulationEnd();
+        } while(me.now < target);
+    }
+
+    void spiTransaction(uint8_t ss, const byte header[], uint8_t headerLength, byte data[], uint16_t dataLength, uint32_t clock) {
+        boolean write = (header[0] & 0x80) != 0;
+        uint8_t reg = header[0] & 0x3F;
+        uint16_t offset = 0;
+        if(header[0] & 0x40) {
+            offset = header[1] & 0x7F;
+            if(header[1] & 0x80)
+                offset |= (uint16_t)header[2] << 7;
+        }
+
+        for(size_t i = 0; i < _nodes.size(); i++) {
+            if(_nodes[i]->ss != ss)
+                continue;
+            Node& node = *_nodes[i];
+            if(node.asleep && node.wakeup != 0 && _me().now >= node.wakeup)
+                _wake(node);
+            if(node.asleep) {
+                if(node.wakeup == 0)
+                    node.wakeup = _me().now + WAKEUP_TIME;
+                if(!write)
+                    memset(data, 0, dataLength);
+            } else if(write)
+                _writeRegister(node, i, reg, offset, data, dataLength, _me().now);
+            else
+                _readRegister(node, reg, offset, data, dataLength, _me().now);
+            break;
+        }
+
+        uint64_t nanoseconds = (uint64_t)(headerLength + dataLength) * 8 * 1000000000ULL / clock + SPI_TRANSACTION_OVERHEAD_NS;
+        _statistics.transactions++;
+        _statistics.bytes += headerLength + dataLength;
+        _statistics.busyNanoseconds += nanoseconds;
+        elapse(_nanosecondsToTicks(nanoseconds));
+    }
+
+    int readIrqPin(uint8_t pin, boolean& handled) {
+        for(Node* node : _nodes) {
+            if(node->irq == pin) {
+                handled = true;
+                /* the line of another MCU is not wired to this one */
+                return node->mcu == _current && node->irqLevel ? HIGH : LOW;
+            }
+        }
+        handled = false;
+        return LOW;
+    }
+
+    void attachIsr(int interruptNumber, void (* handler)(void)) {
+        _me().isrs[interruptNumber] = handler;
+    }
+
+    void detachIsr(int interruptNumber) {
+        _me().isrs.erase(interruptNumber);
+    }
+
+    void setInterruptsEnabled(boolean enabled) {
+        _me().interruptsEnabled = enabled;
+        if(enabled)
+            _serviceInterrupts();
+    }
+
+    const char* serialPrefix() {
+        static thread_local char prefix[64];
+        if(!_running)
+            return "";
+        uint64_t microseconds = _me().now * 10 / 638976;
+        snprintf(prefix, sizeof(prefix), "%s%lu.%03lu ms] ", _me().prefix,
+            (unsigned long)(microseconds / 1000), (unsigned long)(microseconds % 1000));
+        return prefix;
+    }
+}
@@ -0,0 +1,134 @@
+/*
+ * MIT License
+ * 
+ * Copyright (c) 2018 Michele Biondi, Andrea Salvatori
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ * @file DW1000Simulator.hpp
+ * Register level DW1000 simulator for host builds: simulated chips, a shared air channel
+ * and the MCUs running the sketches, all driven by one virtual clock.
+*/
+
+#pragma once
+
+#include <Arduino.h>
+#include <SPI.h>
+
+namespace DW1000Simulator {
+
+    /* Physical setup of a simulated DW1000 */
+    typedef struct node_configuration_t {
+        double x, y, z;             /* antenna position (m) */
+        int32_t clockErrorPpb;      /* crystal frequency error (parts per billion) */
+        uint16_t antennaDelay;      /* real TX and RX antenna delays (UWB time units) */
+        double extraPathLoss;       /* added to the free space path loss (dB), e.g. walls */
+        double directPathLoss;      /* attenuation of the direct path only (dB): NLOS, the energy arrives on a later path */
+        float temperature;          /* degrees C */
+        float voltage;              /* V */
+    } node_configuration_t;
+
+    /* Antenna at the origin, perfect crystal, antenna delays matching the usual 16436 calibration */
+    node_configuration_t defaultNodeConfiguration();
+
+    /* Sketch run by a simulated MCU */
+    typedef struct mcu_program_t {
+        void (* setup)(void);
+        void (* loop)(void);
+    } mcu_program_t;
+
+    typedef struct spi_statistics_t {
+        uint32_t transactions;
+        uint32_t bytes;             /* header and data */
+        uint64_t busyNanoseconds;   /* time spent in transactions, as seen by the MCU */
+    } spi_statistics_t;
+
+    /**
+    Wires a simulated DW1000 to the running MCU (the host program itself outside of run()).
+    Pin numbers are global to the simulation, every node needs its own ss and irq pins.
+
+    @param [in] ss the SPI select pin
+    @param [in] irq the interrupt pin, 0xff if not wired
+    @param [in] configuration position, clock error and antenna delays of the chip
+
+    returns the node index
+    */
+    uint8_t addNode(uint8_t ss, uint8_t irq, const node_configuration_t& configuration);
+
+    /**
+    Moves a node, the next frames use the new distances
+
+    @param [in] node the node index
+    @param [in] x, y, z the new antenna position (m)
+    */
+    void moveNode(uint8_t node, double x, double y, double z);
+
+    /**
+    Overwrites part of a register of a node as the chip would, read-only registers included
+    (e.g. the receive quality registers, to check the estimators of the driver)
+
+    @param [in] node the node index
+    @param [in] reg the register
+    @param [in] offset the sub-address
+    @param [in] length number of bytes written, at most 8
+    @param [in] value the bytes, little endian
+    */
+    void setRegister(uint8_t node, uint8_t reg, uint16_t offset, uint8_t length, uint64_t value);
+
+    /**
+    Runs several sketches concurrently on simulated MCUs: setup() once then loop() forever, each with
+    its own clock, until the given virtual duration elapsed.
+    Sketches add their nodes in setup(), before initializing the driver. Every MCU has its own default
+    DW1000NgDevice, while the other driver state (e.g. the RTLS sequence number) is shared.
+    Nodes are removed when the run is over.
+
+    @param [in] programs the sketches
+    @param [in] count number of sketches
+    @param [in] durationMilliseconds virtual time to simulate
+    */
+    void run(const mcu_program_t programs[], uint8_t count, uint32_t durationMilliseconds);
+
+    /**
+    returns the virtual time of the running MCU in UWB time units (1 / 63.8976 GHz), not wrapped
+    */
+    uint64_t now();
+
+    /**
+    returns the SPI activity since the last reset, of all MCUs
+    */
+    spi_statistics_t getSpiStatistics();
+
+    void resetSpiStatistics();
+
+    /* Interface of the host Arduino core and of the SPIporting backend */
+
+    /* Advances the clock of the running MCU, handling air events and interrupts on the way */
+    void elapse(uint64_t ticks);
+
+    /* Executes one SPI transaction on the node selected by ss and advances the clock accordingly */
+    void spiTransaction(uint8_t ss, const byte header[], uint8_t headerLength, byte data[], uint16_t dataLength, uint32_t clock);
+
+    int readIrqPin(uint8_t pin, boolean& handled);
+    void attachIsr(int interruptNumber, void (* handler)(void));
+    void detachIsr(int interruptNumber);
+    void setInterruptsEnabled(boolean enabled);
+
+    /* Line prefix of the running MCU for Serial output, empty outside of run() */
+    const char* serialPrefix();
+}
@@ -0,0 +1,87 @@
+/*
+ * MIT License
+ * 
+ * Copyright (c) 2018 Michele Biondi, Andrea Salvatori
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ * @file SPIportingSimulator.cpp
+ * SPIporting backend for host builds: every transaction goes to the simulated DW1000 wired to the select pin.
+ * Build it instead of src/SPIporting.cpp.
+*/
+
+#include <Arduino.h>
+#include <SPI.h>
+#include "SPIporting.hpp"
+#include "DW1000NgConstants.hpp"
+#include "DW1000Simulator.hpp"
+
+static SPIClass *_spi;
+
+namespace SPIporting {
+
+	namespace {
+
+		/* Same clocks as the Arduino backend */
+		constexpr uint32_t ArduinoSPImaximumSpeed = 16000000; //16MHz
+		constexpr uint32_t SPIminimumSpeed = 2000000; //2MHz
+
+		uint32_t _currentSPI = ArduinoSPImaximumSpeed;
+	}
+
+	void SPIinit(SPIClass &spi) {
+		_spi = &spi;
+		_spi->begin();
+	}
+
+	void SPIbind(SPIClass &spi) {
+		_spi = &spi;
+	}
+
+	void SPIend() {
+		_spi->end();
+	}
+
+	void SPIselect(uint8_t slaveSelectPIN, uint8_t irq) {
+		pinMode(slaveSelectPIN, OUTPUT);
+		digitalWrite(slaveSelectPIN, HIGH);
+	}
+
+	void writeToSPI(uint8_t slaveSelectPIN, uint8_t headerLen, byte header[], uint16_t dataLen, byte data[]) {
+		#if DW1000NG_SPI_TRACE
+		traceSPI(micros(), true, headerLen, header, dataLen, data);
+		#endif
+		DW1000Simulator::spiTransaction(slaveSelectPIN, header, headerLen, data, dataLen, _currentSPI);
+	}
+
+	void readFromSPI(uint8_t slaveSelectPIN, uint8_t headerLen, byte header[], uint16_t dataLen, byte data[]) {
+		#if DW1000NG_SPI_TRACE
+		uint32_t start = micros();
+		#endif
+		DW1000Simulator::spiTransaction(slaveSelectPIN, header, headerLen, data, dataLen, _currentSPI);
+		#if DW1000NG_SPI_TRACE
+		traceSPI(start, false, headerLen, header, dataLen, data);
+		#endif
+	}
+
+	void setSPIspeed(SPIClock speed) {
+		_currentSPI = speed == SPIClock::FAST ? ArduinoSPImaximumSpeed : SPIminimumSpeed;
+	}
+
+}
@@ -0,0 +1,245 @@
+/*
+ * MIT License
+ * 
+ * Copyright (c) 2018 Michele Biondi, Andrea Salvatori
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ * @file RTLSLocalization.cpp
+ * The StandardRTLS TWR examples (tag, main anchor, anchors B and C) running together on simulated MCUs.
+ * The main anchor prints the ranges and the position found, to be compared with the tag position below.
+*/
+
+#include <DW1000Ng.hpp>
+#include <DW1000NgUtils.hpp>
+#include <DW1000NgRanging.hpp>
+#include <DW1000NgRTLS.hpp>
+#include <DW1000NgFrame.hpp>
+#include "DW1000Simulator.hpp"
+
+typedef struct Position {
+    double x;
+    double y;
+} Position;
+
+const Position TAG_POSITION = {1.2, 1.4};
+const Position ANCHOR_POSITIONS[] = {{0, 0}, {3, 0}, {3, 2.5}};
+
+device_configuration_t DEFAULT_CONFIG = {
+    false,
+    true,
+    true,
+    true,
+    false,
+    SFDMode::STANDARD_SFD,
+    Channel::CHANNEL_5,
+    DataRate::RATE_850KBPS,
+    PulseFrequency::FREQ_16MHZ,
+    PreambleLength::LEN_256,
+    PreambleCode::CODE_3
+};
+
+frame_filtering_configuration_t ANCHOR_FRAME_FILTER_CONFIG = {
+    false,
+    false,
+    true,
+    false,
+    false,
+    false,
+    false,
+    true /* This allows blink frames */
+};
+
+frame_filtering_configuration_t TAG_FRAME_FILTER_CONFIG = {
+    false,
+    false,
+    true,
+    false,
+    false,
+    false,
+    false,
+    false
+};
+
+static void addNode(uint8_t ss, Position position, int32_t clockErrorPpb) {
+    DW1000Simulator::node_configuration_t node = DW1000Simulator::defaultNodeConfiguration();
+    node.x = position.x;
+    node.y = position.y;
+    node.z = 1.5;
+    node.clockErrorPpb = clockErrorPpb;
+    DW1000Simulator::addNode(ss, 0xff, node);
+}
+
+static void setupAnchor(uint8_t ss, const char eui[], uint16_t address) {
+    DW1000Ng::initializeNoInterrupt(ss);
+    DW1000Ng::applyConfiguration(DEFAULT_CONFIG);
+    DW1000Ng::enableFrameFiltering(ANCHOR_FRAME_FILTER_CONFIG);
+    DW1000Ng::setEUI(const_cast<char*>(eui));
+    // longest frame: final message (22 bytes), sent by the tag up to the reply delay (at most REPLY_DELAY_LIMIT) after the response to poll
+    DW1000Ng::enableAutoReceiveTimeouts(22, REPLY_DELAY_LIMIT);
+    DW1000Ng::setNetworkId(RTLS_APP_ID);
+    DW1000Ng::setDeviceAddress(address);
+    DW1000Ng::setAntennaDelay(16436);
+}
+
+static void transmitRangeReport(double range) {
+    byte mainAnchorAddress[] = {0x01, 0x00};
+    DW1000NgFrame::DataFrame<SHORT_SRC_AND_DEST, 3> rangingReport(DW1000NgRTLS::increaseSequenceNumber(), mainAnchorAddress);
+    rangingReport.payload()[0] = 0x60;
+    DW1000NgUtils::writeValueToBytes(&rangingReport.payload()[1], static_cast<uint16_t>((range*1000)), 2);
+    rangingReport.transmit();
+}
+
+namespace Tag {
+    const char EUI[] = "AA:BB:CC:DD:EE:FF:00:00";
+    uint32_t blinkRate = 200;
+
+    void setup() {
+        addNode(10, TAG_POSITION, 3000);
+        DW1000Ng::initializeNoInterrupt(10);
+        DW1000Ng::applyConfiguration(DEFAULT_CONFIG);
+        DW1000Ng::enableFrameFiltering(TAG_FRAME_FILTER_CONFIG);
+        DW1000Ng::setEUI(const_cast<char*>(EUI));
+        DW1000Ng::setNetworkId(RTLS_APP_ID);
+        DW1000Ng::setAntennaDelay(16436);
+        // longest frame: ranging initiation (18 bytes), sent by the anchors right after receiving
+        DW1000Ng::enableAutoReceiveTimeouts(18, 120);
+        uint16_t replyDelay = DW1000NgRTLS::calibrateReplyDelay();
+        if(replyDelay == 0) {
+            Serial.println(F("Reply delay above REPLY_DELAY_LIMIT, the anchors would miss the final message"));
+        } else {
+            Serial.print("Reply delay (us): "); Serial.println(replyDelay);
+        }
+    }
+
+    void loop() {
+        delay(blinkRate);
+        RangeInfrastructureResult res = DW1000NgRTLS::tagTwrLocalize();
+        if(res.success)
+            blinkRate = res.new_blink_rate;
+    }
+}
+
+namespace AnchorMain {
+    double ranges[3];
+    boolean receivedB = false;
+    byte tagShortAddress[] = {0x05, 0x00};
+
+    void setup() {
+        addNode(20, ANCHOR_POSITIONS[0], -2000);
+        setupAnchor(20, "AA:BB:CC:DD:EE:FF:00:01", 1);
+    }
+
+    void calculatePosition(double &x, double &y) {
+        const Position* p = ANCHOR_POSITIONS;
+        double A = -2*p[0].x + 2*p[1].x;
+        double B = -2*p[0].y + 2*p[1].y;
+        double C = ranges[0]*ranges[0] - ranges[1]*ranges[1] - p[0].x*p[0].x + p[1].x*p[1].x - p[0].y*p[0].y + p[1].y*p[1].y;
+        double D = -2*p[1].x + 2*p[2].x;
+        double E = -2*p[1].y + 2*p[2].y;
+        double F = ranges[1]*ranges[1] - ranges[2]*ranges[2] - p[1].x*p[1].x + p[2].x*p[2].x - p[1].y*p[1].y + p[2].y*p[2].y;
+        x = (C*E-F*B) / (E*A-B*D);
+        y = (C*D-A*F) / (B*D-A*E);
+    }
+
+    void loop() {
+        if(!DW1000NgRTLS::receiveFrame())
+            return;
+        size_t recv_len = DW1000Ng::getReceivedDataLength();
+        byte recv_data[recv_len];
+        DW1000Ng::getReceivedData(recv_data, recv_len);
+
+        if(recv_data[0] == BLINK) {
+            DW1000NgRTLS::transmitRangingInitiation(&recv_data[2], tagShortAddress);
+            DW1000NgRTLS::waitForTransmission();
+            RangeAcceptResult result = DW1000NgRTLS::anchorRangeAccept(NextActivity::RANGING_CONFIRM, 2);
+            if(!result.success)
+                return;
+            ranges[0] = result.range;
+            String rangeString = "Range: "; rangeString += ranges[0]; rangeString += " m";
+            rangeString += "\t RX power: "; rangeString += DW1000Ng::getReceivePower(); rangeString += " dBm";
+            Serial.println(rangeString);
+        } else if(recv_len > 11 && recv_data[9] == 0x60) {
+            double range = static_cast<double>(DW1000NgUtils::bytesAsValue(&recv_data[10], 2) / 1000.0);
+            String rangeReportString = "Range from: "; rangeReportString += recv_data[7];
+            rangeReportString += " = "; rangeReportString += range;
+            Serial.println(rangeReportString);
+            if(!receivedB && recv_data[7] == 2) {
+                ranges[1] = range;
+                receivedB = true;
+            } else if(receivedB && recv_data[7] == 3) {
+                ranges[2] = range;
+                double x, y;
+                calculatePosition(x, y);
+                String positioning = "Found position - x: "; positioning += x;
+                positioning += " y: "; positioning += y;
+                positioning += " (tag at x: "; positioning += TAG_POSITION.x;
+                positioning += " y: "; positioning += TAG_POSITION.y; positioning += ")";
+                Serial.println(positioning);
+                receivedB = false;
+            } else {
+                receivedB = false;
+            }
+        }
+    }
+}
+
+namespace AnchorB {
+    void setup() {
+        addNode(30, ANCHOR_POSITIONS[1], 1000);
+        setupAnchor(30, "AA:BB:CC:DD:EE:FF:00:02", 2);
+    }
+
+    void loop() {
+        RangeAcceptResult result = DW1000NgRTLS::anchorRangeAccept(NextActivity::RANGING_CONFIRM, 3);
+        if(result.success) {
+            delay(2);
+            transmitRangeReport(result.range);
+        }
+    }
+}
+
+namespace AnchorC {
+    void setup() {
+        addNode(40, ANCHOR_POSITIONS[2], -500);
+        setupAnchor(40, "AA:BB:CC:DD:EE:FF:00:03", 3);
+    }
+
+    void loop() {
+        RangeAcceptResult result = DW1000NgRTLS::anchorRangeAccept(NextActivity::ACTIVITY_FINISHED, 200);
+        if(result.success) {
+            delay(4);
+            transmitRangeReport(result.range);
+        }
+    }
+}
+
+int main() {
+    const DW1000Simulator::mcu_program_t programs[] = {
+        {Tag::setup, Tag::loop},
+        {AnchorMain::setup, AnchorMain::loop},
+        {AnchorB::setup, AnchorB::loop},
+        {AnchorC::setup, AnchorC::loop}
+    };
+    DW1000Simulator::run(programs, 4, 2000);
+
+    DW1000Simulator::spi_statistics_t spi = DW1000Simulator::getSpiStatistics();
+    printf("SPI: %u transactions, %u bytes, %.1f ms busy\n", spi.transactions, spi.bytes, spi.busyNanoseconds / 1e6);
+    return 0;
+}
@@ -0,0 +1,272 @@
+/*
+ * MIT License
+ * 
+ * Copyright (c) 2018 Michele Biondi, Andrea Salvatori
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ * @file spitrace.cpp
+ * Decodes the SPI trace printed by SPIporting::dumpSPItrace() (DW1000NG_SPI_TRACE) into register names,
+ * summarizes the accesses per register, flags repeated reads and replays the trace against a simulated DW1000.
+ *
+ * usage: spitrace [-r] [-c clock] [-q] [trace.txt]
+ *   -r        replay the trace against the simulator and compare the data read
+ *   -c clock  SPI clock used to estimate bus time (Hz, default 16000000)
+ *   -q        only print the summary
+ * Lines not starting with "SPI <number>" are ignored, so a raw serial log can be used as input.
+*/
+
+#include <Arduino.h>
+#include <SPI.h>
+#include <map>
+#include <vector>
+#include "DW1000NgRegisters.hpp"
+#include "SPIporting.hpp"
+#include "DW1000Simulator.hpp"
+
+namespace {
+
+    typedef struct trace_entry_t {
+        uint32_t timestamp;
+        bool write;
+        uint8_t reg;
+        uint16_t subAddress;
+        uint16_t length;
+        std::vector<uint8_t> data;
+    } trace_entry_t;
+
+    typedef struct register_summary_t {
+        uint32_t reads;
+        uint32_t writes;
+        uint32_t bytes;
+        double busMicroseconds;
+        uint32_t repeatedReads;
+        uint32_t replayMismatches;
+    } register_summary_t;
+
+    #define REGISTER_NAME(name) {name, #name}
+    const struct { uint16_t reg; const char* name; } REGISTER_NAMES[] = {
+        REGISTER_NAME(DEV_ID), REGISTER_NAME(EUI), REGISTER_NAME(PANADR), REGISTER_NAME(SYS_CFG),
+        REGISTER_NAME(SYS_TIME), REGISTER_NAME(TX_FCTRL), REGISTER_NAME(TX_BUFFER), REGISTER_NAME(DX_TIME),
+        REGISTER_NAME(RX_WFTO), REGISTER_NAME(SYS_CTRL), REGISTER_NAME(SYS_MASK), REGISTER_NAME(SYS_STATUS),
+        REGISTER_NAME(RX_FINFO), REGISTER_NAME(RX_BUFFER), REGISTER_NAME(RX_FQUAL), REGISTER_NAME(RX_TIME),
+        REGISTER_NAME(TX_TIME), REGISTER_NAME(TX_ANTD), REGISTER_NAME(ACK_RESP_T), REGISTER_NAME(TX_POWER),
+        REGISTER_NAME(CHAN_CTRL), REGISTER_NAME(USR_SFD), REGISTER_NAME(AGC_TUNE), REGISTER_NAME(EXT_SYNC),
+        REGISTER_NAME(GPIO_CTRL), REGISTER_NAME(DRX_TUNE), REGISTER_NAME(RF_CONF), REGISTER_NAME(TX_CAL),
+        REGISTER_NAME(FS_CTRL), REGISTER_NAME(AON), REGISTER_NAME(OTP_IF), REGISTER_NAME(LDE_IF),
+        REGISTER_NAME(DIG_DIAG), REGISTER_NAME(PMSC)
+    };
+
+    /* reads of the same address returning the same data, closer than this and with no write in between, are reported as repeated */
+    constexpr uint32_t REPEATED_READ_WINDOW_US = 1000;
+    constexpr uint8_t REPLAY_SS = 10;
+
+    std::vector<trace_entry_t> _trace;
+    std::map<uint8_t, register_summary_t> _summary;
+
+    const char* _registerName(uint8_t reg) {
+        static char unknown[8];
+        for(const auto& known : REGISTER_NAMES) {
+            if(known.reg == reg)
+                return known.name;
+        }
+        snprintf(unknown, sizeof(unknown), "REG_%02X", reg);
+        return unknown;
+    }
+
+    bool _parseLine(const char* line, trace_entry_t& entry) {
+        char direction;
+        unsigned long timestamp;
+        unsigned int reg, subAddress, length;
+        int consumed;
+        if(sscanf(line, "SPI %lu %c %x %x %u%n", &timestamp, &direction, &reg, &subAddress, &length, &consumed) != 5)
+            return false;
+        if(direction != 'R' && direction != 'W')
+            return false;
+
+        entry.timestamp = timestamp;
+        entry.write = direction == 'W';
+        entry.reg = reg;
+        entry.subAddress = subAddress;
+        entry.length = length;
+        entry.data.clear();
+        const char* cursor = line + consumed;
+        unsigned int value;
+        int read;
+        while(sscanf(cursor, " %2x%n", &value, &read) == 1) {
+            entry.data.push_back(value);
+            cursor += read;
+        }
+        return true;
+    }
+
+    /* same framing as SPIporting: header bytes, data bytes, then the 5us hold of the select line */
+    double _busMicroseconds(const trace_entry_t& entry, uint32_t clock) {
+        uint8_t headerLength = entry.subAddress == 0 ? 1 : (entry.subAddress < 128 ? 2 : 3);
+        return (headerLength + entry.length) * 8 * 1e6 / clock + 5;
+    }
+
+    void _buildHeader(const trace_entry_t& entry, byte header[], uint8_t& headerLength) {
+        header[0] = (entry.write ? 0x80 : 0x00) | entry.reg;
+        headerLength = 1;
+        if(entry.subAddress == 0)
+            return;
+        header[0] |= 0x40;
+        if(entry.subAddress < 128) {
+            header[1] = entry.subAddress;
+            headerLength = 2;
+        } else {
+            header[1] = 0x80 | (entry.subAddress & 0x7F);
+            header[2] = entry.subAddress >> 7;
+            headerLength = 3;
+        }
+    }
+
+    /* Issues the traced transactions with the traced spacing against a simulated DW1000 on the host MCU */
+    void _replay() {
+        DW1000Simulator::addNode(REPLAY_SS, 0xff, DW1000Simulator::defaultNodeConfiguration());
+        SPIporting::SPIinit();
+        SPIporting::SPIselect(REPLAY_SS);
+        DW1000Simulator::resetSpiStatistics();
+
+        uint32_t start = micros();
+        for(const trace_entry_t& entry : _trace) {
+            while(micros() - start < entry.timestamp - _trace[0].timestamp)
+                delayMicroseconds(1);
+
+            byte header[3];
+            uint8_t headerLength;
+            _buildHeader(entry, header, headerLength);
+            std::vector<byte> data(entry.length, 0);
+            for(size_t i = 0; i < entry.data.size() && i < data.size(); i++)
+                data[i] = entry.data[i];
+
+            if(entry.write) {
+                SPIporting::writeToSPI(REPLAY_SS, headerLength, header, data.size(), data.data());
+            } else {
+                SPIporting::readFromSPI(REPLAY_SS, headerLength, header, data.size(), data.data());
+                for(size_t i = 0; i < entry.data.size() && i < data.size(); i++) {
+                    if(data[i] != entry.data[i]) {
+                        _summary[entry.reg].replayMismatches++;
+                        break;
+                    }
+                }
+            }
+        }
+
+        DW1000Simulator::spi_statistics_t statistics = DW1000Simulator::getSpiStatistics();
+        printf("\nReplay: %u transactions, %u bytes, %.1f us on the bus, %.1f us of trace\n",
+            statistics.transactions, statistics.bytes, statistics.busyNanoseconds / 1000.0,
+            (double)(micros() - start));
+    }
+
+}
+
+int main(int argc, char* argv[]) {
+    bool replay = false;
+    bool quiet = false;
+    uint32_t clock = 16000000;
+    const char* path = nullptr;
+    for(int i = 1; i < argc; i++) {
+        if(strcmp(argv[i], "-r") == 0) {
+            replay = true;
+        } else if(strcmp(argv[i], "-q") == 0) {
+            quiet = true;
+        } else if(strcmp(argv[i], "-c") == 0 && i + 1 < argc) {
+            clock = strtoul(argv[++i], nullptr, 10);
+        } else if(argv[i][0] == '-') {
+            fprintf(stderr, "usage: %s [-r] [-c clock] [-q] [trace.txt]\n", argv[0]);
+            return 1;
+        } else {
+            path = argv[i];
+        }
+    }
+
+    FILE* input = path != nullptr ? fopen(path, "r") : stdin;
+    if(input == nullptr) {
+        perror(path);
+        return 1;
+    }
+
+    char line[256];
+    trace_entry_t entry;
+    while(fgets(line, sizeof(line), input) != nullptr) {
+        if(_parseLine(line, entry))
+            _trace.push_back(entry);
+    }
+    if(input != stdin)
+        fclose(input);
+    if(_trace.empty()) {
+        fprintf(stderr, "no SPI trace found\n");
+        return 1;
+    }
+
+    /* last read of each address since the last write to any register */
+    std::map<uint32_t, const trace_entry_t*> lastReads;
+    double busMicroseconds = 0;
+    for(const trace_entry_t& current : _trace) {
+        register_summary_t& summary = _summary[current.reg];
+        double bus = _busMicroseconds(current, clock);
+        summary.bytes += current.length;
+        summary.busMicroseconds += bus;
+        busMicroseconds += bus;
+
+        bool repeated = false;
+        if(current.write) {
+            summary.writes++;
+            lastReads.clear();
+        } else {
+            summary.reads++;
+            uint32_t address = (static_cast<uint32_t>(current.reg) << 16) | current.subAddress;
+            auto last = lastReads.find(address);
+            repeated = last != lastReads.end() && last->second->length == current.length
+                && last->second->data == current.data
+                && current.timestamp - last->second->timestamp < REPEATED_READ_WINDOW_US;
+            if(repeated)
+                summary.repeatedReads++;
+            lastReads[address] = &current;
+        }
+
+        if(!quiet) {
+            printf("%10u %+8d %c %-10s +%04X %4u ",
+                current.timestamp, (int)(current.timestamp - _trace[0].timestamp),
+                current.write ? 'W' : 'R', _registerName(current.reg), current.subAddress, current.length);
+            for(uint8_t value : current.data)
+                printf(" %02X", value);
+            printf("%s\n", repeated ? "   <- repeated read" : "");
+        }
+    }
+
+    if(replay)
+        _replay();
+
+    printf("\n%-10s %7s %7s %7s %10s %9s", "register", "reads", "writes", "bytes", "bus us", "repeated");
+    printf(replay ? " %9s\n" : "\n", "mismatch");
+    for(const auto& item : _summary) {
+        const register_summary_t& summary = item.second;
+        printf("%-10s %7u %7u %7u %10.1f %9u", _registerName(item.first),
+            summary.reads, summary.writes, summary.bytes, summary.busMicroseconds, summary.repeatedReads);
+        if(replay)
+            printf(" %9u", summary.replayMismatches);
+        printf("\n");
+    }
+    printf("%zu transactions over %u us, %.1f us on the bus at %u Hz\n", _trace.size(),
+        _trace.back().timestamp - _trace[0].timestamp, busMicroseconds, clock);
+    return 0;
+}
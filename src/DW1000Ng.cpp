@@ -50,9 +50,12 @@
 #endif
 #include "DW1000Ng.hpp"
 #include "DW1000NgUtils.hpp"
+#include "DW1000NgTime.hpp"
+#include "DW1000NgAirtime.hpp"
 #include "DW1000NgConstants.hpp"
 #include "DW1000NgRegisters.hpp"
 #include "SPIporting.hpp"
+#include "DW1000NgProbes.hpp"
 
 namespace DW1000Ng {
 	
@@ -61,52 +64,82 @@ namespace DW1000Ng {
 
 		/* ########################### PRIVATE VARIABLES ################################# */
 
-		/* SPI select pin and interrupt pin*/
-		uint8_t _ss = 0xff;
-		uint8_t _irq = 0xff;
-		uint8_t _rst = 0xff;
-
-		/* IRQ callbacks */
-		void (* _handleSent)(void)                      = nullptr;
-		void (* _handleError)(void)                     = nullptr;
-		void (* _handleReceived)(void)                  = nullptr;
-		void (* _handleReceiveFailed)(void)             = nullptr;
-		void (* _handleReceiveTimeout)(void)            = nullptr;
-		void (* _handleReceiveTimestampAvailable)(void) = nullptr;
-
-		/* registers */
-		byte       _syscfg[LEN_SYS_CFG];
-		byte       _sysctrl[LEN_SYS_CTRL];
-		byte       _sysstatus[LEN_SYS_STATUS];
-		byte       _txfctrl[LEN_TX_FCTRL];
-		byte       _sysmask[LEN_SYS_MASK];
-		byte       _chanctrl[LEN_CHAN_CTRL];
-		byte       _networkAndAddress[LEN_PANADR];
-
-		/* Temperature and Voltage monitoring */
-		byte _vmeas3v3 = 0;
-		byte _tmeas23C = 0;
-
-		/* Driver Internal State Trackers */
-		byte        	_extendedFrameLength;
-		PacSize        	_pacSize;
-		PulseFrequency	_pulseFrequency;
-		DataRate        _dataRate;
-		PreambleLength	_preambleLength;
-		PreambleCode	_preambleCode;
-		Channel        	_channel;
-		boolean     	_smartPower;
-		boolean     	_frameCheck;
-		boolean     	_debounceClockEnabled = false;
-		boolean     	_nlos = false;
-		boolean			_standardSFD = true;
-		boolean     	_autoTXPower = true;
-		boolean     	_autoTCPGDelay = true;
-		boolean 		_wait4resp = false;
-		uint16_t		_antennaTxDelay = 0;
-		uint16_t		_antennaRxDelay = 0;
+		static_assert(sizeof(DW1000NgDevice::_syscfg) == LEN_SYS_CFG, "SYS_CFG mirror size");
+		static_assert(sizeof(DW1000NgDevice::_sysctrl) == LEN_SYS_CTRL, "SYS_CTRL mirror size");
+		static_assert(sizeof(DW1000NgDevice::_sysstatus) == LEN_SYS_STATUS, "SYS_STATUS mirror size");
+		static_assert(sizeof(DW1000NgDevice::_txfctrl) == LEN_TX_FCTRL, "TX_FCTRL mirror size");
+		static_assert(sizeof(DW1000NgDevice::_sysmask) == LEN_SYS_MASK, "SYS_MASK mirror size");
+		static_assert(sizeof(DW1000NgDevice::_chanctrl) == LEN_CHAN_CTRL, "CHAN_CTRL mirror size");
+		static_assert(sizeof(DW1000NgDevice::_networkAndAddress) == LEN_PANADR, "PANADR mirror size");
+		static_assert(sizeof(DW1000NgDevice::_eui) == LEN_EUI, "EUI mirror size");
+		static_assert(sizeof(DW1000NgDevice::_eventCounters) == LEN_EVC_COUNTERS, "event counters snapshot size");
+
+		/* Device used when select() is never called */
+		DW1000NgDevice _defaultDevice;
+
+		/* Currently selected device, every function works on it */
+		DW1000NgDevice* _dev = &_defaultDevice;
+
+		/* Wake-up from deep sleep (μs): how long SPICSn is held low, and the bound of the wait for the device to be ready */
+		constexpr uint16_t WAKEUP_CS_LOW_TIME = 500;
+		constexpr uint16_t WAKEUP_TIMEOUT = 5000;
+
+		/* Bounds of the waits of initialize() (μs): power-up or reset until SPI answers, LDE microcode load, clock PLL lock */
+		constexpr uint16_t POWER_UP_TIMEOUT = 5000;
+		constexpr uint16_t LDE_LOAD_TIMEOUT = 1000;
+		constexpr uint16_t PLL_LOCK_TIMEOUT = 5000;
+
+		/* Devices with an interrupt line, serviced by the shared interrupt handler */
+		DW1000NgDevice* _interruptDevices[DW1000NG_MAX_DEVICES];
+		uint8_t _interruptDevicesCount = 0;
 
 		/* ############################# PRIVATE METHODS ################################### */
+
+		/* Sets the SPI speed and remembers it, so it can be restored when the device is selected again */
+		void _setSPIspeed(SPIClock speed) {
+			_dev->_spiClock = speed;
+			SPIporting::setSPIspeed(speed);
+		}
+
+		/* Makes device the target of the driver and binds its SPI bus */
+		void _bindDevice(DW1000NgDevice* device) {
+			_dev = device;
+			if(_dev->_spi != nullptr)
+				SPIporting::SPIbind(*_dev->_spi);
+			SPIporting::setSPIspeed(_dev->_spiClock);
+		}
+
+		void _registerInterruptDevice(DW1000NgDevice* device) {
+			for(uint8_t i = 0; i < _interruptDevicesCount; i++) {
+				if(_interruptDevices[i] == device)
+					return;
+			}
+			if(_interruptDevicesCount < DW1000NG_MAX_DEVICES)
+				_interruptDevices[_interruptDevicesCount++] = device;
+		}
+
+		/*
+		* Shared interrupt handler: the DW1000 IRQ line stays active until the events are cleared,
+		* so every device whose line is active (see setInterruptPolarity()) gets serviced, then the previous selection is restored.
+		*/
+#if defined(ESP8266)
+		void ICACHE_RAM_ATTR _dispatchInterrupt() {
+#else
+		void _dispatchInterrupt() {
+#endif
+			if(_interruptDevicesCount == 1 && _interruptDevices[0] == _dev) {
+				interruptServiceRoutine();
+				return;
+			}
+			DW1000NgDevice* previous = _dev;
+			for(uint8_t i = 0; i < _interruptDevicesCount; i++) {
+				if(digitalRead(_interruptDevices[i]->_irq) == (_interruptDevices[i]->_interruptActiveHigh ? HIGH : LOW)) {
+					_bindDevice(_interruptDevices[i]);
+					interruptServiceRoutine();
+				}
+			}
+			_bindDevice(previous);
+		}
 		
 		/*
 		* Write bytes to the DW1000. Single bytes can be written to registers via sub-addressing.
@@ -142,7 +175,7 @@ namespace DW1000Ng {
 				}
 			}
 			
-			SPIporting::writeToSPI(_ss, headerLen, header, data_size, data);
+			SPIporting::writeToSPI(_dev->_ss, headerLen, header, data_size, data);
 		}
 
 		/*
@@ -207,7 +240,7 @@ namespace DW1000Ng {
 				}
 			}
 
-			SPIporting::readFromSPI(_ss, headerLen, header, data_size, data);
+			SPIporting::readFromSPI(_dev->_ss, headerLen, header, data_size, data);
 		}
 
 		/*
@@ -243,22 +276,23 @@ namespace DW1000Ng {
 			_writeBytesToRegister(bitRegister, RegisterOffset+idx, &targetByte, 1);
 		}
 
-		// always 4 bytes
-		// TODO why always 4 bytes? can be different, see p. 58 table 10 otp memory map
-		void _readBytesOTP(uint16_t address, byte data[]) {
+		/* Reads words consecutive 32 bit OTP words starting at address in a single read mode session */
+		void _readBytesOTP(uint16_t address, byte data[], uint8_t words = 1) {
 			byte addressBytes[LEN_OTP_ADDR];
 			
 			// p60 - 6.3.3 Reading a value from OTP memory
-			// bytes of address
-			addressBytes[0] = (address & 0xFF);
-			addressBytes[1] = ((address >> 8) & 0xFF);
-			// set address
-			_writeBytesToRegister(OTP_IF, OTP_ADDR_SUB, addressBytes, LEN_OTP_ADDR);
 			// switch into read mode
-			_writeSingleByteToRegister(OTP_IF, OTP_CTRL_SUB, 0x03); // OTPRDEN | OTPREAD
 			_writeSingleByteToRegister(OTP_IF, OTP_CTRL_SUB, 0x01); // OTPRDEN
-			// read value/block - 4 bytes
-			_readBytesFromRegister(OTP_IF, OTP_RDAT_SUB, data, LEN_OTP_RDAT);
+			for(uint8_t i = 0; i < words; i++) {
+				// bytes of address
+				addressBytes[0] = ((address + i) & 0xFF);
+				addressBytes[1] = (((address + i) >> 8) & 0xFF);
+				// set address
+				_writeBytesToRegister(OTP_IF, OTP_ADDR_SUB, addressBytes, LEN_OTP_ADDR);
+				_writeSingleByteToRegister(OTP_IF, OTP_CTRL_SUB, 0x03); // OTPRDEN | OTPREAD
+				// read value/block - 4 bytes
+				_readBytesFromRegister(OTP_IF, OTP_RDAT_SUB, &data[i * LEN_OTP_RDAT], LEN_OTP_RDAT);
+			}
 			// end read mode
 			_writeSingleByteToRegister(OTP_IF, OTP_CTRL_SUB, 0x00);
 		}
@@ -297,12 +331,46 @@ namespace DW1000Ng {
 			byte step5 = 0x00; _writeBytesToRegister(TX_CAL, NO_SUB, &step5, 1);
 		}
 
+		float _temperatureFromSAR(byte sar_ltemp) {
+			return (sar_ltemp - _dev->_otp.tmeas23C) * 1.14f + 23.0f;
+		}
+
+		float _batteryVoltageFromSAR(byte sar_lvbat) {
+			return (sar_lvbat - _dev->_otp.vmeas3v3) / 173.0f + 3.3f;
+		}
+
+		/* offsets of the compensation table at the temperature and battery voltage of the state */
+		void _compensationOffsets(compensation_state_t& state) {
+			const compensation_configuration_t& config = _dev->_compensationConfig;
+			float antennaDelay = 0;
+			float pgDelay = 0;
+			float txPower = (3.3f - state.batteryVoltage) * config.txPowerPerVolt;
+			if(config.pointsCount > 0) {
+				uint8_t i = 0;
+				while(i + 2 < config.pointsCount && state.temperature > config.points[i + 1].temperature)
+					i++;
+				const compensation_point_t& low = config.points[i];
+				const compensation_point_t& high = config.points[i + 1 < config.pointsCount ? i + 1 : i];
+				float f = 0;
+				if(high.temperature > low.temperature) {
+					f = (state.temperature - low.temperature) / (high.temperature - low.temperature);
+					f = f < 0 ? 0 : (f > 1 ? 1 : f);
+				}
+				antennaDelay = low.antennaDelay + (high.antennaDelay - low.antennaDelay) * f;
+				pgDelay = low.pgDelay + (high.pgDelay - low.pgDelay) * f;
+				txPower += low.txPower + (high.txPower - low.txPower) * f;
+			}
+			state.antennaDelay = lround(antennaDelay);
+			state.pgDelay = lround(pgDelay);
+			state.txPower = lround(txPower);
+		}
+
 		/* AGC_TUNE1 - reg:0x23, sub-reg:0x04, table 24 */
 		void _agctune1() {
 			byte agctune1[LEN_AGC_TUNE1];
-			if(_pulseFrequency == PulseFrequency::FREQ_16MHZ) {
+			if(_dev->_pulseFrequency == PulseFrequency::FREQ_16MHZ) {
 				DW1000NgUtils::writeValueToBytes(agctune1, 0x8870, LEN_AGC_TUNE1);
-			} else if(_pulseFrequency == PulseFrequency::FREQ_64MHZ) {
+			} else if(_dev->_pulseFrequency == PulseFrequency::FREQ_64MHZ) {
 				DW1000NgUtils::writeValueToBytes(agctune1, 0x889B, LEN_AGC_TUNE1);
 			} else {
 				// TODO proper error/warning handling
@@ -327,20 +395,20 @@ namespace DW1000Ng {
 		/* DRX_TUNE0b - reg:0x27, sub-reg:0x02, table 30 */
 		void _drxtune0b() {
 			byte drxtune0b[LEN_DRX_TUNE0b];
-			if(_dataRate == DataRate::RATE_110KBPS) {
-				if(!_standardSFD) {
+			if(_dev->_dataRate == DataRate::RATE_110KBPS) {
+				if(!_dev->_standardSFD) {
 					DW1000NgUtils::writeValueToBytes(drxtune0b, 0x0016, LEN_DRX_TUNE0b);
 				} else {
 					DW1000NgUtils::writeValueToBytes(drxtune0b, 0x000A, LEN_DRX_TUNE0b);
 				}
-			} else if(_dataRate == DataRate::RATE_850KBPS) {
-				if(!_standardSFD) {
+			} else if(_dev->_dataRate == DataRate::RATE_850KBPS) {
+				if(!_dev->_standardSFD) {
 					DW1000NgUtils::writeValueToBytes(drxtune0b, 0x0006, LEN_DRX_TUNE0b);
 				} else {
 					DW1000NgUtils::writeValueToBytes(drxtune0b, 0x0001, LEN_DRX_TUNE0b);
 				}
-			} else if(_dataRate == DataRate::RATE_6800KBPS) {
-				if(!_standardSFD) {
+			} else if(_dev->_dataRate == DataRate::RATE_6800KBPS) {
+				if(!_dev->_standardSFD) {
 					DW1000NgUtils::writeValueToBytes(drxtune0b, 0x0002, LEN_DRX_TUNE0b);
 				} else {
 					DW1000NgUtils::writeValueToBytes(drxtune0b, 0x0001, LEN_DRX_TUNE0b);
@@ -354,9 +422,9 @@ namespace DW1000Ng {
 		/* DRX_TUNE1a - reg:0x27, sub-reg:0x04, table 31 */
 		void _drxtune1a() {
 			byte drxtune1a[LEN_DRX_TUNE1a];
-			if(_pulseFrequency == PulseFrequency::FREQ_16MHZ) {
+			if(_dev->_pulseFrequency == PulseFrequency::FREQ_16MHZ) {
 				DW1000NgUtils::writeValueToBytes(drxtune1a, 0x0087, LEN_DRX_TUNE1a);
-			} else if(_pulseFrequency == PulseFrequency::FREQ_64MHZ) {
+			} else if(_dev->_pulseFrequency == PulseFrequency::FREQ_64MHZ) {
 				DW1000NgUtils::writeValueToBytes(drxtune1a, 0x008D, LEN_DRX_TUNE1a);
 			} else {
 				// TODO proper error/warning handling
@@ -367,21 +435,21 @@ namespace DW1000Ng {
 		/* DRX_TUNE1b - reg:0x27, sub-reg:0x06, table 32 */
 		void _drxtune1b() {
 			byte drxtune1b[LEN_DRX_TUNE1b];
-			if(_preambleLength == PreambleLength::LEN_1536 || _preambleLength == PreambleLength::LEN_2048 ||
-				_preambleLength == PreambleLength::LEN_4096) {
-				if(_dataRate == DataRate::RATE_110KBPS) {
+			if(_dev->_preambleLength == PreambleLength::LEN_1536 || _dev->_preambleLength == PreambleLength::LEN_2048 ||
+				_dev->_preambleLength == PreambleLength::LEN_4096) {
+				if(_dev->_dataRate == DataRate::RATE_110KBPS) {
 					DW1000NgUtils::writeValueToBytes(drxtune1b, 0x0064, LEN_DRX_TUNE1b);
 				} else {
 					// TODO proper error/warning handling
 				}
-			} else if(_preambleLength != PreambleLength::LEN_64) {
-				if(_dataRate == DataRate::RATE_850KBPS || _dataRate == DataRate::RATE_6800KBPS) {
+			} else if(_dev->_preambleLength != PreambleLength::LEN_64) {
+				if(_dev->_dataRate == DataRate::RATE_850KBPS || _dev->_dataRate == DataRate::RATE_6800KBPS) {
 					DW1000NgUtils::writeValueToBytes(drxtune1b, 0x0020, LEN_DRX_TUNE1b);
 				} else {
 					// TODO proper error/warning handling
 				}
 			} else {
-				if(_dataRate == DataRate::RATE_6800KBPS) {
+				if(_dev->_dataRate == DataRate::RATE_6800KBPS) {
 					DW1000NgUtils::writeValueToBytes(drxtune1b, 0x0010, LEN_DRX_TUNE1b);
 				} else {
 					// TODO proper error/warning handling
@@ -393,34 +461,34 @@ namespace DW1000Ng {
 		/* DRX_TUNE2 - reg:0x27, sub-reg:0x08, table 33 */
 		void _drxtune2() {
 			byte drxtune2[LEN_DRX_TUNE2];	
-			if(_pacSize == PacSize::SIZE_8) {
-				if(_pulseFrequency == PulseFrequency::FREQ_16MHZ) {
+			if(_dev->_pacSize == PacSize::SIZE_8) {
+				if(_dev->_pulseFrequency == PulseFrequency::FREQ_16MHZ) {
 					DW1000NgUtils::writeValueToBytes(drxtune2, 0x311A002DL, LEN_DRX_TUNE2);
-				} else if(_pulseFrequency == PulseFrequency::FREQ_64MHZ) {
+				} else if(_dev->_pulseFrequency == PulseFrequency::FREQ_64MHZ) {
 					DW1000NgUtils::writeValueToBytes(drxtune2, 0x313B006BL, LEN_DRX_TUNE2);
 				} else {
 					// TODO proper error/warning handling
 				}
-			} else if(_pacSize == PacSize::SIZE_16) {
-				if(_pulseFrequency == PulseFrequency::FREQ_16MHZ) {
+			} else if(_dev->_pacSize == PacSize::SIZE_16) {
+				if(_dev->_pulseFrequency == PulseFrequency::FREQ_16MHZ) {
 					DW1000NgUtils::writeValueToBytes(drxtune2, 0x331A0052L, LEN_DRX_TUNE2);
-				} else if(_pulseFrequency == PulseFrequency::FREQ_64MHZ) {
+				} else if(_dev->_pulseFrequency == PulseFrequency::FREQ_64MHZ) {
 					DW1000NgUtils::writeValueToBytes(drxtune2, 0x333B00BEL, LEN_DRX_TUNE2);
 				} else {
 					// TODO proper error/warning handling
 				}
-			} else if(_pacSize == PacSize::SIZE_32) {
-				if(_pulseFrequency == PulseFrequency::FREQ_16MHZ) {
+			} else if(_dev->_pacSize == PacSize::SIZE_32) {
+				if(_dev->_pulseFrequency == PulseFrequency::FREQ_16MHZ) {
 					DW1000NgUtils::writeValueToBytes(drxtune2, 0x351A009AL, LEN_DRX_TUNE2);
-				} else if(_pulseFrequency == PulseFrequency::FREQ_64MHZ) {
+				} else if(_dev->_pulseFrequency == PulseFrequency::FREQ_64MHZ) {
 					DW1000NgUtils::writeValueToBytes(drxtune2, 0x353B015EL, LEN_DRX_TUNE2);
 				} else {
 					// TODO proper error/warning handling
 				}
-			} else if(_pacSize == PacSize::SIZE_64) {
-				if(_pulseFrequency == PulseFrequency::FREQ_16MHZ) {
+			} else if(_dev->_pacSize == PacSize::SIZE_64) {
+				if(_dev->_pulseFrequency == PulseFrequency::FREQ_16MHZ) {
 					DW1000NgUtils::writeValueToBytes(drxtune2, 0x371A011DL, LEN_DRX_TUNE2);
-				} else if(_pulseFrequency == PulseFrequency::FREQ_64MHZ) {
+				} else if(_dev->_pulseFrequency == PulseFrequency::FREQ_64MHZ) {
 					DW1000NgUtils::writeValueToBytes(drxtune2, 0x373B0296L, LEN_DRX_TUNE2);
 				} else {
 					// TODO proper error/warning handling
@@ -434,7 +502,7 @@ namespace DW1000Ng {
 		/* DRX_TUNE4H - reg:0x27, sub-reg:0x26, table 34 */
 		void _drxtune4H() {
 			byte drxtune4H[LEN_DRX_TUNE4H];
-			if(_preambleLength == PreambleLength::LEN_64) {
+			if(_dev->_preambleLength == PreambleLength::LEN_64) {
 				DW1000NgUtils::writeValueToBytes(drxtune4H, 0x0010, LEN_DRX_TUNE4H);
 			} else {
 				DW1000NgUtils::writeValueToBytes(drxtune4H, 0x0028, LEN_DRX_TUNE4H);
@@ -445,16 +513,16 @@ namespace DW1000Ng {
 		/* LDE_CFG1 - reg 0x2E, sub-reg:0x0806 */
 		void _ldecfg1() {
 			byte ldecfg1[LEN_LDE_CFG1];
-			_nlos == true ? DW1000NgUtils::writeValueToBytes(ldecfg1, 0x7, LEN_LDE_CFG1) : DW1000NgUtils::writeValueToBytes(ldecfg1, 0xD, LEN_LDE_CFG1);
+			_dev->_nlos == true ? DW1000NgUtils::writeValueToBytes(ldecfg1, 0x7, LEN_LDE_CFG1) : DW1000NgUtils::writeValueToBytes(ldecfg1, 0xD, LEN_LDE_CFG1);
 			_writeBytesToRegister(LDE_IF, LDE_CFG1_SUB, ldecfg1, LEN_LDE_CFG1);
 		}
 
 		/* LDE_CFG2 - reg 0x2E, sub-reg:0x1806, table 50 */
 		void _ldecfg2() {
 			byte ldecfg2[LEN_LDE_CFG2];	
-			if(_pulseFrequency == PulseFrequency::FREQ_16MHZ) {
-				_nlos == true ? DW1000NgUtils::writeValueToBytes(ldecfg2, 0x0003, LEN_LDE_CFG2) : DW1000NgUtils::writeValueToBytes(ldecfg2, 0x1607, LEN_LDE_CFG2);
-			} else if(_pulseFrequency == PulseFrequency::FREQ_64MHZ) {
+			if(_dev->_pulseFrequency == PulseFrequency::FREQ_16MHZ) {
+				_dev->_nlos == true ? DW1000NgUtils::writeValueToBytes(ldecfg2, 0x0003, LEN_LDE_CFG2) : DW1000NgUtils::writeValueToBytes(ldecfg2, 0x1607, LEN_LDE_CFG2);
+			} else if(_dev->_pulseFrequency == PulseFrequency::FREQ_64MHZ) {
 				DW1000NgUtils::writeValueToBytes(ldecfg2, 0x0607, LEN_LDE_CFG2);
 			} else {
 				// TODO proper error/warning handling
@@ -463,246 +531,251 @@ namespace DW1000Ng {
 		}
 
 		/* LDE_REPC - reg 0x2E, sub-reg:0x2804, table 51 */
-		void _lderepc() {
-			byte lderepc[LEN_LDE_REPC];
-			if(_preambleCode == PreambleCode::CODE_1 || _preambleCode == PreambleCode::CODE_2) {
-				if(_dataRate == DataRate::RATE_110KBPS) {
-					DW1000NgUtils::writeValueToBytes(lderepc, ((0x5998 >> 3) & 0xFFFF), LEN_LDE_REPC);
+		uint16_t _ldeRepcValue(PreambleCode preambleCode) {
+			uint16_t lderepc = 0;
+			if(preambleCode == PreambleCode::CODE_1 || preambleCode == PreambleCode::CODE_2) {
+				if(_dev->_dataRate == DataRate::RATE_110KBPS) {
+					lderepc = ((0x5998 >> 3) & 0xFFFF);
 				} else {
-					DW1000NgUtils::writeValueToBytes(lderepc, 0x5998, LEN_LDE_REPC);
+					lderepc = 0x5998;
 				}
-			} else if(_preambleCode == PreambleCode::CODE_3 || _preambleCode == PreambleCode::CODE_8) {
-				if(_dataRate == DataRate::RATE_110KBPS) {
-					DW1000NgUtils::writeValueToBytes(lderepc, ((0x51EA >> 3) & 0xFFFF), LEN_LDE_REPC);
+			} else if(preambleCode == PreambleCode::CODE_3 || preambleCode == PreambleCode::CODE_8) {
+				if(_dev->_dataRate == DataRate::RATE_110KBPS) {
+					lderepc = ((0x51EA >> 3) & 0xFFFF);
 				} else {
-					DW1000NgUtils::writeValueToBytes(lderepc, 0x51EA, LEN_LDE_REPC);
+					lderepc = 0x51EA;
 				}
-			} else if(_preambleCode == PreambleCode::CODE_4) {
-				if(_dataRate == DataRate::RATE_110KBPS) {
-					DW1000NgUtils::writeValueToBytes(lderepc, ((0x428E >> 3) & 0xFFFF), LEN_LDE_REPC);
+			} else if(preambleCode == PreambleCode::CODE_4) {
+				if(_dev->_dataRate == DataRate::RATE_110KBPS) {
+					lderepc = ((0x428E >> 3) & 0xFFFF);
 				} else {
-					DW1000NgUtils::writeValueToBytes(lderepc, 0x428E, LEN_LDE_REPC);
+					lderepc = 0x428E;
 				}
-			} else if(_preambleCode == PreambleCode::CODE_5) {
-				if(_dataRate == DataRate::RATE_110KBPS) {
-					DW1000NgUtils::writeValueToBytes(lderepc, ((0x451E >> 3) & 0xFFFF), LEN_LDE_REPC);
+			} else if(preambleCode == PreambleCode::CODE_5) {
+				if(_dev->_dataRate == DataRate::RATE_110KBPS) {
+					lderepc = ((0x451E >> 3) & 0xFFFF);
 				} else {
-					DW1000NgUtils::writeValueToBytes(lderepc, 0x451E, LEN_LDE_REPC);
+					lderepc = 0x451E;
 				}
-			} else if(_preambleCode == PreambleCode::CODE_6) {
-				if(_dataRate == DataRate::RATE_110KBPS) {
-					DW1000NgUtils::writeValueToBytes(lderepc, ((0x2E14 >> 3) & 0xFFFF), LEN_LDE_REPC);
+			} else if(preambleCode == PreambleCode::CODE_6) {
+				if(_dev->_dataRate == DataRate::RATE_110KBPS) {
+					lderepc = ((0x2E14 >> 3) & 0xFFFF);
 				} else {
-					DW1000NgUtils::writeValueToBytes(lderepc, 0x2E14, LEN_LDE_REPC);
+					lderepc = 0x2E14;
 				}
-			} else if(_preambleCode == PreambleCode::CODE_7) {
-				if(_dataRate == DataRate::RATE_110KBPS) {
-					DW1000NgUtils::writeValueToBytes(lderepc, ((0x8000 >> 3) & 0xFFFF), LEN_LDE_REPC);
+			} else if(preambleCode == PreambleCode::CODE_7) {
+				if(_dev->_dataRate == DataRate::RATE_110KBPS) {
+					lderepc = ((0x8000 >> 3) & 0xFFFF);
 				} else {
-					DW1000NgUtils::writeValueToBytes(lderepc, 0x8000, LEN_LDE_REPC);
+					lderepc = 0x8000;
 				}
-			} else if(_preambleCode == PreambleCode::CODE_9) {
-				if(_dataRate == DataRate::RATE_110KBPS) {
-					DW1000NgUtils::writeValueToBytes(lderepc, ((0x28F4 >> 3) & 0xFFFF), LEN_LDE_REPC);
+			} else if(preambleCode == PreambleCode::CODE_9) {
+				if(_dev->_dataRate == DataRate::RATE_110KBPS) {
+					lderepc = ((0x28F4 >> 3) & 0xFFFF);
 				} else {
-					DW1000NgUtils::writeValueToBytes(lderepc, 0x28F4, LEN_LDE_REPC);
+					lderepc = 0x28F4;
 				}
-			} else if(_preambleCode == PreambleCode::CODE_10 || _preambleCode == PreambleCode::CODE_17) {
-				if(_dataRate == DataRate::RATE_110KBPS) {
-					DW1000NgUtils::writeValueToBytes(lderepc, ((0x3332 >> 3) & 0xFFFF), LEN_LDE_REPC);
+			} else if(preambleCode == PreambleCode::CODE_10 || preambleCode == PreambleCode::CODE_17) {
+				if(_dev->_dataRate == DataRate::RATE_110KBPS) {
+					lderepc = ((0x3332 >> 3) & 0xFFFF);
 				} else {
-					DW1000NgUtils::writeValueToBytes(lderepc, 0x3332, LEN_LDE_REPC);
+					lderepc = 0x3332;
 				}
-			} else if(_preambleCode == PreambleCode::CODE_11) {
-				if(_dataRate == DataRate::RATE_110KBPS) {
-					DW1000NgUtils::writeValueToBytes(lderepc, ((0x3AE0 >> 3) & 0xFFFF), LEN_LDE_REPC);
+			} else if(preambleCode == PreambleCode::CODE_11) {
+				if(_dev->_dataRate == DataRate::RATE_110KBPS) {
+					lderepc = ((0x3AE0 >> 3) & 0xFFFF);
 				} else {
-					DW1000NgUtils::writeValueToBytes(lderepc, 0x3AE0, LEN_LDE_REPC);
+					lderepc = 0x3AE0;
 				}
-			} else if(_preambleCode == PreambleCode::CODE_12) {
-				if(_dataRate == DataRate::RATE_110KBPS) {
-					DW1000NgUtils::writeValueToBytes(lderepc, ((0x3D70 >> 3) & 0xFFFF), LEN_LDE_REPC);
+			} else if(preambleCode == PreambleCode::CODE_12) {
+				if(_dev->_dataRate == DataRate::RATE_110KBPS) {
+					lderepc = ((0x3D70 >> 3) & 0xFFFF);
 				} else {
-					DW1000NgUtils::writeValueToBytes(lderepc, 0x3D70, LEN_LDE_REPC);
+					lderepc = 0x3D70;
 				}
-			} else if(_preambleCode == PreambleCode::CODE_18 || _preambleCode == PreambleCode::CODE_19) {
-				if(_dataRate == DataRate::RATE_110KBPS) {
-					DW1000NgUtils::writeValueToBytes(lderepc, ((0x35C2 >> 3) & 0xFFFF), LEN_LDE_REPC);
+			} else if(preambleCode == PreambleCode::CODE_18 || preambleCode == PreambleCode::CODE_19) {
+				if(_dev->_dataRate == DataRate::RATE_110KBPS) {
+					lderepc = ((0x35C2 >> 3) & 0xFFFF);
 				} else {
-					DW1000NgUtils::writeValueToBytes(lderepc, 0x35C2, LEN_LDE_REPC);
+					lderepc = 0x35C2;
 				}
-			} else if(_preambleCode == PreambleCode::CODE_20) {
-				if(_dataRate == DataRate::RATE_110KBPS) {
-					DW1000NgUtils::writeValueToBytes(lderepc, ((0x47AE >> 3) & 0xFFFF), LEN_LDE_REPC);
+			} else if(preambleCode == PreambleCode::CODE_20) {
+				if(_dev->_dataRate == DataRate::RATE_110KBPS) {
+					lderepc = ((0x47AE >> 3) & 0xFFFF);
 				} else {
-					DW1000NgUtils::writeValueToBytes(lderepc, 0x47AE, LEN_LDE_REPC);
+					lderepc = 0x47AE;
 				}
 			} else {
 				// TODO proper error/warning handling
 			}
-			
+			return lderepc;
+		}
+
+		void _lderepc() {
+			byte lderepc[LEN_LDE_REPC];
+			DW1000NgUtils::writeValueToBytes(lderepc, _ldeRepcValue(_dev->_preambleCode), LEN_LDE_REPC);
 			_writeBytesToRegister(LDE_IF, LDE_REPC_SUB, lderepc, LEN_LDE_REPC);
 		}
 
 		/* TX_POWER (enabled smart transmit power control) - reg:0x1E, tables 19-20
 		* These values are based on a typical IC and an assumed IC to antenna loss of 1.5 dB with a 0 dBi antenna */
-		void _txpowertune() {
-			byte txpower[LEN_TX_POWER];
-			if(_channel == Channel::CHANNEL_1 || _channel == Channel::CHANNEL_2) {
-				if(_pulseFrequency == PulseFrequency::FREQ_16MHZ) {
-					if(_smartPower) {
+		uint32_t _txPowerValue(Channel channel) {
+			uint32_t txpower = 0;
+			if(channel == Channel::CHANNEL_1 || channel == Channel::CHANNEL_2) {
+				if(_dev->_pulseFrequency == PulseFrequency::FREQ_16MHZ) {
+					if(_dev->_smartPower) {
 						#if DWM1000_OPTIMIZED
-						DW1000NgUtils::writeValueToBytes(txpower, 0x1B153555L, LEN_TX_POWER);
+						txpower = 0x1B153555L;
 						#else
-						DW1000NgUtils::writeValueToBytes(txpower, 0x15355575L, LEN_TX_POWER);
+						txpower = 0x15355575L;
 						#endif
 					} else {
 						#if DWM1000_OPTIMIZED
-						DW1000NgUtils::writeValueToBytes(txpower, 0x55555555L, LEN_TX_POWER);
+						txpower = 0x55555555L;
 						#else
-						DW1000NgUtils::writeValueToBytes(txpower, 0x75757575L, LEN_TX_POWER);
+						txpower = 0x75757575L;
 						#endif
 					}
-				} else if(_pulseFrequency == PulseFrequency::FREQ_64MHZ) {
-					if(_smartPower) {
+				} else if(_dev->_pulseFrequency == PulseFrequency::FREQ_64MHZ) {
+					if(_dev->_smartPower) {
 						#if DWM1000_OPTIMIZED
-						DW1000NgUtils::writeValueToBytes(txpower, 0x0D072747L, LEN_TX_POWER);
+						txpower = 0x0D072747L;
 						#else
-						DW1000NgUtils::writeValueToBytes(txpower, 0x07274767L, LEN_TX_POWER);
+						txpower = 0x07274767L;
 						#endif
 					} else {
 						#if DWM1000_OPTIMIZED
-						DW1000NgUtils::writeValueToBytes(txpower, 0x47474747L, LEN_TX_POWER);
+						txpower = 0x47474747L;
 						#else
-						DW1000NgUtils::writeValueToBytes(txpower, 0x67676767L, LEN_TX_POWER);
+						txpower = 0x67676767L;
 						#endif
 					}
 				} else {
 					// TODO proper error/warning handling
 				}
-			} else if(_channel == Channel::CHANNEL_3) {
-				if(_pulseFrequency == PulseFrequency::FREQ_16MHZ) {
-					if(_smartPower) {
+			} else if(channel == Channel::CHANNEL_3) {
+				if(_dev->_pulseFrequency == PulseFrequency::FREQ_16MHZ) {
+					if(_dev->_smartPower) {
 						#if DWM1000_OPTIMIZED
-						DW1000NgUtils::writeValueToBytes(txpower, 0x150F2F4FL, LEN_TX_POWER);
+						txpower = 0x150F2F4FL;
 						#else
-						DW1000NgUtils::writeValueToBytes(txpower, 0x0F2F4F6FL, LEN_TX_POWER);
+						txpower = 0x0F2F4F6FL;
 						#endif
 					} else {
 						#if DWM1000_OPTIMIZED
-						DW1000NgUtils::writeValueToBytes(txpower, 0x4F4F4F4FL, LEN_TX_POWER);
+						txpower = 0x4F4F4F4FL;
 						#else
-						DW1000NgUtils::writeValueToBytes(txpower, 0x6F6F6F6FL, LEN_TX_POWER);
+						txpower = 0x6F6F6F6FL;
 						#endif
 					}
-				} else if(_pulseFrequency == PulseFrequency::FREQ_64MHZ) {
-					if(_smartPower) {
+				} else if(_dev->_pulseFrequency == PulseFrequency::FREQ_64MHZ) {
+					if(_dev->_smartPower) {
 						#if DWM1000_OPTIMIZED
-						DW1000NgUtils::writeValueToBytes(txpower, 0x0B2B4B6BL, LEN_TX_POWER);
+						txpower = 0x0B2B4B6BL;
 						#else
-						DW1000NgUtils::writeValueToBytes(txpower, 0x2B4B6B8BL, LEN_TX_POWER);
+						txpower = 0x2B4B6B8BL;
 						#endif
 					} else {
 						#if DWM1000_OPTIMIZED
-						DW1000NgUtils::writeValueToBytes(txpower, 0x6B6B6B6BL, LEN_TX_POWER);
+						txpower = 0x6B6B6B6BL;
 						#else
-						DW1000NgUtils::writeValueToBytes(txpower, 0x8B8B8B8BL, LEN_TX_POWER);
+						txpower = 0x8B8B8B8BL;
 						#endif
 					}
 				} else {
 					// TODO proper error/warning handling
 				}
-			} else if(_channel == Channel::CHANNEL_4) {
-				if(_pulseFrequency == PulseFrequency::FREQ_16MHZ) {
-					if(_smartPower) {
+			} else if(channel == Channel::CHANNEL_4) {
+				if(_dev->_pulseFrequency == PulseFrequency::FREQ_16MHZ) {
+					if(_dev->_smartPower) {
 						#if DWM1000_OPTIMIZED
-						DW1000NgUtils::writeValueToBytes(txpower, 0x1F1F1F3FL, LEN_TX_POWER);
+						txpower = 0x1F1F1F3FL;
 						#else
-						DW1000NgUtils::writeValueToBytes(txpower, 0x1F1F3F5FL, LEN_TX_POWER);
+						txpower = 0x1F1F3F5FL;
 						#endif
 					} else {
 						#if DWM1000_OPTIMIZED
-						DW1000NgUtils::writeValueToBytes(txpower, 0x3F3F3F3FL, LEN_TX_POWER);
+						txpower = 0x3F3F3F3FL;
 						#else
-						DW1000NgUtils::writeValueToBytes(txpower, 0x5F5F5F5FL, LEN_TX_POWER);
+						txpower = 0x5F5F5F5FL;
 						#endif
 					}
-				} else if(_pulseFrequency == PulseFrequency::FREQ_64MHZ) {
-					if(_smartPower) {
+				} else if(_dev->_pulseFrequency == PulseFrequency::FREQ_64MHZ) {
+					if(_dev->_smartPower) {
 						#if DWM1000_OPTIMIZED
-						DW1000NgUtils::writeValueToBytes(txpower, 0x1A3A5A7AL, LEN_TX_POWER);
+						txpower = 0x1A3A5A7AL;
 						#else
-						DW1000NgUtils::writeValueToBytes(txpower, 0x3A5A7A9AL, LEN_TX_POWER);
+						txpower = 0x3A5A7A9AL;
 						#endif
 					} else {
 						#if DWM1000_OPTIMIZED
-						DW1000NgUtils::writeValueToBytes(txpower, 0x7A7A7A7AL, LEN_TX_POWER);
+						txpower = 0x7A7A7A7AL;
 						#else
-						DW1000NgUtils::writeValueToBytes(txpower, 0x9A9A9A9AL, LEN_TX_POWER);
+						txpower = 0x9A9A9A9AL;
 						#endif
 					}
 				} else {
 					// TODO proper error/warning handling
 				}
-			} else if(_channel == Channel::CHANNEL_5) {
-				if(_pulseFrequency == PulseFrequency::FREQ_16MHZ) {
-					if(_smartPower) {
+			} else if(channel == Channel::CHANNEL_5) {
+				if(_dev->_pulseFrequency == PulseFrequency::FREQ_16MHZ) {
+					if(_dev->_smartPower) {
 						#if DWM1000_OPTIMIZED
-						DW1000NgUtils::writeValueToBytes(txpower, 0x140E0828L, LEN_TX_POWER);
+						txpower = 0x140E0828L;
 						#else
-						DW1000NgUtils::writeValueToBytes(txpower, 0x0E082848L, LEN_TX_POWER);
+						txpower = 0x0E082848L;
 						#endif
 					} else {
 						#if DWM1000_OPTIMIZED
-						DW1000NgUtils::writeValueToBytes(txpower, 0x28282828L, LEN_TX_POWER);
+						txpower = 0x28282828L;
 						#else
-						DW1000NgUtils::writeValueToBytes(txpower, 0x48484848L, LEN_TX_POWER);
+						txpower = 0x48484848L;
 						#endif
 					}
-				} else if(_pulseFrequency == PulseFrequency::FREQ_64MHZ) {
-					if(_smartPower) {
+				} else if(_dev->_pulseFrequency == PulseFrequency::FREQ_64MHZ) {
+					if(_dev->_smartPower) {
 						#if DWM1000_OPTIMIZED
-						DW1000NgUtils::writeValueToBytes(txpower, 0x05254565L, LEN_TX_POWER);
+						txpower = 0x05254565L;
 						#else
-						DW1000NgUtils::writeValueToBytes(txpower, 0x25456585L, LEN_TX_POWER);
+						txpower = 0x25456585L;
 						#endif
 					} else {
 						#if DWM1000_OPTIMIZED
-						DW1000NgUtils::writeValueToBytes(txpower, 0x65656565L, LEN_TX_POWER);
+						txpower = 0x65656565L;
 						#else
-						DW1000NgUtils::writeValueToBytes(txpower, 0x85858585L, LEN_TX_POWER);
+						txpower = 0x85858585L;
 						#endif
 					}
 				} else {
 					// TODO proper error/warning handling
 				}
-			} else if(_channel == Channel::CHANNEL_7) {
-				if(_pulseFrequency == PulseFrequency::FREQ_16MHZ) {
-					if(_smartPower) {
+			} else if(channel == Channel::CHANNEL_7) {
+				if(_dev->_pulseFrequency == PulseFrequency::FREQ_16MHZ) {
+					if(_dev->_smartPower) {
 						#if DWM1000_OPTIMIZED
-						DW1000NgUtils::writeValueToBytes(txpower, 0x12325272L, LEN_TX_POWER);
+						txpower = 0x12325272L;
 						#else
-						DW1000NgUtils::writeValueToBytes(txpower, 0x32527292L, LEN_TX_POWER);
+						txpower = 0x32527292L;
 						#endif
 					} else {
 						#if DWM1000_OPTIMIZED
-						DW1000NgUtils::writeValueToBytes(txpower, 0x72727272L, LEN_TX_POWER);
+						txpower = 0x72727272L;
 						#else
-						DW1000NgUtils::writeValueToBytes(txpower, 0x92929292L, LEN_TX_POWER);
+						txpower = 0x92929292L;
 						#endif
 					}
-				} else if(_pulseFrequency == PulseFrequency::FREQ_64MHZ) {
-					if(_smartPower) {
+				} else if(_dev->_pulseFrequency == PulseFrequency::FREQ_64MHZ) {
+					if(_dev->_smartPower) {
 						#if DWM1000_OPTIMIZED
-						DW1000NgUtils::writeValueToBytes(txpower, 0x315191B1L, LEN_TX_POWER);
+						txpower = 0x315191B1L;
 						#else
-						DW1000NgUtils::writeValueToBytes(txpower, 0x5171B1D1L, LEN_TX_POWER);
+						txpower = 0x5171B1D1L;
 						#endif
 					} else {
 						#if DWM1000_OPTIMIZED
-						DW1000NgUtils::writeValueToBytes(txpower, 0xB1B1B1B1L, LEN_TX_POWER);
+						txpower = 0xB1B1B1B1L;
 						#else
-						DW1000NgUtils::writeValueToBytes(txpower, 0xD1D1D1D1L, LEN_TX_POWER);
+						txpower = 0xD1D1D1D1L;
 						#endif
 					}
 				} else {
@@ -711,82 +784,147 @@ namespace DW1000Ng {
 			} else {
 				// TODO proper error/warning handling
 			}
+			return txpower;
+		}
+
+		/* moves a TX power field (coarse DA in 2.5 dB steps, fine mixer in 0.5 dB steps) by 0.5 dB steps */
+		byte _adjustTXPowerField(byte field, int8_t steps) {
+			int8_t coarse = field >> 5;
+			int16_t fine = (field & 0x1F) + steps;
+			if(coarse > 6) {
+				/* output off */
+				return field;
+			}
+			while(fine > 0x1F && coarse > 0) {
+				coarse--;
+				fine -= 5;
+			}
+			while(fine < 0 && coarse < 6) {
+				coarse++;
+				fine += 5;
+			}
+			if(fine > 0x1F)
+				fine = 0x1F;
+			if(fine < 0)
+				fine = 0;
+			return (coarse << 5) | fine;
+		}
+
+		void _writeTXPowerRegister() {
+			byte txpower[LEN_TX_POWER];
+			DW1000NgUtils::writeValueToBytes(txpower, _dev->_txPower, LEN_TX_POWER);
+			for(auto i = 0; i < LEN_TX_POWER; i++) {
+				txpower[i] = _adjustTXPowerField(txpower[i], _dev->_compensationState.txPower);
+			}
 			_writeBytesToRegister(TX_POWER, NO_SUB, txpower, LEN_TX_POWER);
 		}
 
+		void _txpowertune() {
+			_dev->_txPower = _txPowerValue(_dev->_channel);
+			_writeTXPowerRegister();
+		}
+
 		/* RF_RXCTRLH - reg:0x28, sub-reg:0x0B, table 37 */
-		void _rfrxctrlh() {
-			byte rfrxctrlh[LEN_RF_RXCTRLH];
-			if(_channel != Channel::CHANNEL_4 && _channel != Channel::CHANNEL_7) {
-				DW1000NgUtils::writeValueToBytes(rfrxctrlh, 0xD8, LEN_RF_RXCTRLH);
+		byte _rfRxCtrlHValue(Channel channel) {
+			if(channel != Channel::CHANNEL_4 && channel != Channel::CHANNEL_7) {
+				return 0xD8;
 			} else {
-				DW1000NgUtils::writeValueToBytes(rfrxctrlh, 0xBC, LEN_RF_RXCTRLH);
+				return 0xBC;
 			}
-			_writeBytesToRegister(RF_CONF, RF_RXCTRLH_SUB, rfrxctrlh, LEN_RF_RXCTRLH);
+		}
+
+		void _rfrxctrlh() {
+			byte rfrxctrlh = _rfRxCtrlHValue(_dev->_channel);
+			_writeBytesToRegister(RF_CONF, RF_RXCTRLH_SUB, &rfrxctrlh, LEN_RF_RXCTRLH);
 		}
 
 		/* RX_TXCTRL - reg:0x28, sub-reg:0x0C */
-		void _rftxctrl() {
-			byte rftxctrl[LEN_RF_TXCTRL];
-			if(_channel == Channel::CHANNEL_1) {
-				DW1000NgUtils::writeValueToBytes(rftxctrl, 0x00005C40L, LEN_RF_TXCTRL);
-			} else if(_channel == Channel::CHANNEL_2) {
-				DW1000NgUtils::writeValueToBytes(rftxctrl, 0x00045CA0L, LEN_RF_TXCTRL);
-			} else if(_channel == Channel::CHANNEL_3) {
-				DW1000NgUtils::writeValueToBytes(rftxctrl, 0x00086CC0L, LEN_RF_TXCTRL);
-			} else if(_channel == Channel::CHANNEL_4) {
-				DW1000NgUtils::writeValueToBytes(rftxctrl, 0x00045C80L, LEN_RF_TXCTRL);
-			} else if(_channel == Channel::CHANNEL_5) {
-				DW1000NgUtils::writeValueToBytes(rftxctrl, 0x001E3FE0L, LEN_RF_TXCTRL);
-			} else if(_channel == Channel::CHANNEL_7) {
-				DW1000NgUtils::writeValueToBytes(rftxctrl, 0x001E7DE0L, LEN_RF_TXCTRL);
+		uint32_t _rfTxCtrlValue(Channel channel) {
+			uint32_t rftxctrl = 0;
+			if(channel == Channel::CHANNEL_1) {
+				rftxctrl = 0x00005C40L;
+			} else if(channel == Channel::CHANNEL_2) {
+				rftxctrl = 0x00045CA0L;
+			} else if(channel == Channel::CHANNEL_3) {
+				rftxctrl = 0x00086CC0L;
+			} else if(channel == Channel::CHANNEL_4) {
+				rftxctrl = 0x00045C80L;
+			} else if(channel == Channel::CHANNEL_5) {
+				rftxctrl = 0x001E3FE0L;
+			} else if(channel == Channel::CHANNEL_7) {
+				rftxctrl = 0x001E7DE0L;
 			} else {
 				// TODO proper error/warning handling
 			}
+			return rftxctrl;
+		}
+
+		void _rftxctrl() {
+			byte rftxctrl[LEN_RF_TXCTRL];
+			DW1000NgUtils::writeValueToBytes(rftxctrl, _rfTxCtrlValue(_dev->_channel), LEN_RF_TXCTRL);
 			_writeBytesToRegister(RF_CONF, RF_TXCTRL_SUB, rftxctrl, LEN_RF_TXCTRL);
 		}
 
 		/* TC_PGDELAY - reg:0x2A, sub-reg:0x0B, table 40 */
-		void _tcpgdelaytune() {
-			byte tcpgdelay[LEN_TC_PGDELAY];	
-			if(_channel == Channel::CHANNEL_1) {
-				DW1000NgUtils::writeValueToBytes(tcpgdelay, 0xC9, LEN_TC_PGDELAY);
-			} else if(_channel == Channel::CHANNEL_2) {
-				DW1000NgUtils::writeValueToBytes(tcpgdelay, 0xC2, LEN_TC_PGDELAY);
-			} else if(_channel == Channel::CHANNEL_3) {
-				DW1000NgUtils::writeValueToBytes(tcpgdelay, 0xC5, LEN_TC_PGDELAY);
-			} else if(_channel == Channel::CHANNEL_4) {
-				DW1000NgUtils::writeValueToBytes(tcpgdelay, 0x95, LEN_TC_PGDELAY);
-			} else if(_channel == Channel::CHANNEL_5) {
-				DW1000NgUtils::writeValueToBytes(tcpgdelay, 0xB5, LEN_TC_PGDELAY);
-			} else if(_channel == Channel::CHANNEL_7) {
-				DW1000NgUtils::writeValueToBytes(tcpgdelay, 0x93, LEN_TC_PGDELAY);
+		byte _tcPgDelayValue(Channel channel) {
+			byte tcpgdelay = 0;
+			if(channel == Channel::CHANNEL_1) {
+				tcpgdelay = 0xC9;
+			} else if(channel == Channel::CHANNEL_2) {
+				tcpgdelay = 0xC2;
+			} else if(channel == Channel::CHANNEL_3) {
+				tcpgdelay = 0xC5;
+			} else if(channel == Channel::CHANNEL_4) {
+				tcpgdelay = 0x95;
+			} else if(channel == Channel::CHANNEL_5) {
+				tcpgdelay = 0xB5;
+			} else if(channel == Channel::CHANNEL_7) {
+				tcpgdelay = 0x93;
 			} else {
 				// TODO proper error/warning handling
 			}
-			_writeBytesToRegister(TX_CAL, TC_PGDELAY_SUB, tcpgdelay, LEN_TC_PGDELAY);
+			return tcpgdelay;
+		}
+
+		void _writeTCPGDelayRegister() {
+			int16_t value = _dev->_tcPgDelay + _dev->_compensationState.pgDelay;
+			byte tcpgdelay = value < 0 ? 0 : (value > 0xFF ? 0xFF : value);
+			_writeBytesToRegister(TX_CAL, TC_PGDELAY_SUB, &tcpgdelay, LEN_TC_PGDELAY);
+		}
+
+		void _tcpgdelaytune() {
+			_dev->_tcPgDelay = _tcPgDelayValue(_dev->_channel);
+			_writeTCPGDelayRegister();
 		}
 
 		// FS_PLLCFG and FS_PLLTUNE - reg:0x2B, sub-reg:0x07-0x0B, tables 43-44
-		void _fspll() {
-			byte fspllcfg[LEN_FS_PLLCFG];
-			byte fsplltune[LEN_FS_PLLTUNE];
-			if(_channel == Channel::CHANNEL_1) {
-				DW1000NgUtils::writeValueToBytes(fspllcfg, 0x09000407L, LEN_FS_PLLCFG);
-				DW1000NgUtils::writeValueToBytes(fsplltune, 0x1E, LEN_FS_PLLTUNE);
-			} else if(_channel == Channel::CHANNEL_2 || _channel == Channel::CHANNEL_4) {
-				DW1000NgUtils::writeValueToBytes(fspllcfg, 0x08400508L, LEN_FS_PLLCFG);
-				DW1000NgUtils::writeValueToBytes(fsplltune, 0x26, LEN_FS_PLLTUNE);
-			} else if(_channel == Channel::CHANNEL_3) {
-				DW1000NgUtils::writeValueToBytes(fspllcfg, 0x08401009L, LEN_FS_PLLCFG);
-				DW1000NgUtils::writeValueToBytes(fsplltune, 0x56, LEN_FS_PLLTUNE);
-			} else if(_channel == Channel::CHANNEL_5 || _channel == Channel::CHANNEL_7) {
-				DW1000NgUtils::writeValueToBytes(fspllcfg, 0x0800041DL, LEN_FS_PLLCFG);
-				DW1000NgUtils::writeValueToBytes(fsplltune, 0xBE, LEN_FS_PLLTUNE);
+		void _fsPllValues(Channel channel, uint32_t& fspllcfg, byte& fsplltune) {
+			if(channel == Channel::CHANNEL_1) {
+				fspllcfg = 0x09000407L;
+				fsplltune = 0x1E;
+			} else if(channel == Channel::CHANNEL_2 || channel == Channel::CHANNEL_4) {
+				fspllcfg = 0x08400508L;
+				fsplltune = 0x26;
+			} else if(channel == Channel::CHANNEL_3) {
+				fspllcfg = 0x08401009L;
+				fsplltune = 0x56;
+			} else if(channel == Channel::CHANNEL_5 || channel == Channel::CHANNEL_7) {
+				fspllcfg = 0x0800041DL;
+				fsplltune = 0xBE;
 			} else {
+				fspllcfg = 0;
+				fsplltune = 0;
 				// TODO proper error/warning handling
 			}
-			_writeBytesToRegister(FS_CTRL, FS_PLLTUNE_SUB, fsplltune, LEN_FS_PLLTUNE);
+		}
+
+		void _fspll() {
+			uint32_t pllcfg;
+			byte fsplltune;
+			_fsPllValues(_dev->_channel, pllcfg, fsplltune);
+			byte fspllcfg[LEN_FS_PLLCFG];
+			DW1000NgUtils::writeValueToBytes(fspllcfg, pllcfg, LEN_FS_PLLCFG);
+			_writeBytesToRegister(FS_CTRL, FS_PLLTUNE_SUB, &fsplltune, LEN_FS_PLLTUNE);
 			_writeBytesToRegister(FS_CTRL, FS_PLLCFG_SUB, fspllcfg, LEN_FS_PLLCFG);
 		}
 
@@ -803,42 +941,92 @@ namespace DW1000Ng {
 			_ldecfg1();
 			_ldecfg2();
 			_lderepc(); 
-			if(_autoTXPower) _txpowertune();
+			if(_dev->_autoTXPower) _txpowertune();
 			_rfrxctrlh();
 			_rftxctrl();
-			if(_autoTCPGDelay) _tcpgdelaytune();
+			if(_dev->_autoTCPGDelay) _tcpgdelaytune();
 			_fspll();
 		}
 
+		/* only the fields the airtime depends on are meaningful */
+		device_configuration_t _currentConfiguration() {
+			return {
+				_dev->_extendedFrameLength != 0,
+				false,
+				_dev->_smartPower,
+				_dev->_frameCheck,
+				_dev->_nlos,
+				_dev->_standardSFD ? SFDMode::STANDARD_SFD : SFDMode::DECAWAVE_SFD,
+				_dev->_channel,
+				_dev->_dataRate,
+				_dev->_pulseFrequency,
+				_dev->_preambleLength,
+				_dev->_preambleCode
+			};
+		}
+
+		void _writeAcknowledgeTurnaround() {
+			byte ackTime = DW1000NgAirtime::acknowledgeTurnaround(_dev->_dataRate);
+			_writeBytesToRegister(ACK_RESP_T, ACK_RESP_T_ACK_TIM_SUB, &ackTime, LEN_ACK_RESP_T_ACK_TIM_SUB);
+		}
+
+		void _writeAutoReceiveTimeouts() {
+			device_configuration_t config = _currentConfiguration();
+			setPreambleDetectionTimeout(DW1000NgAirtime::preambleDetectionTimeout(config, _dev->_responseWait));
+			setSfdDetectionTimeout(DW1000NgAirtime::sfdDetectionTimeout(config));
+			setReceiveFrameWaitTimeoutPeriod(DW1000NgAirtime::frameWaitTimeout(config, _dev->_expectedDataLength, _dev->_responseWait));
+		}
+
 		void _writeNetworkIdAndDeviceAddress() {
-			_writeBytesToRegister(PANADR, NO_SUB, _networkAndAddress, LEN_PANADR);
+			_writeBytesToRegister(PANADR, NO_SUB, _dev->_networkAndAddress, LEN_PANADR);
 		}
 
 		void _writeSystemConfigurationRegister() {
-			_writeBytesToRegister(SYS_CFG, NO_SUB, _syscfg, LEN_SYS_CFG);
+			_writeBytesToRegister(SYS_CFG, NO_SUB, _dev->_syscfg, LEN_SYS_CFG);
 		}
 
 		void _writeChannelControlRegister() {
-			_writeBytesToRegister(CHAN_CTRL, NO_SUB, _chanctrl, LEN_CHAN_CTRL);
+			_writeBytesToRegister(CHAN_CTRL, NO_SUB, _dev->_chanctrl, LEN_CHAN_CTRL);
 		}
 
 		void _writeTransmitFrameControlRegister() {
-			_writeBytesToRegister(TX_FCTRL, NO_SUB, _txfctrl, LEN_TX_FCTRL);
+			_writeBytesToRegister(TX_FCTRL, NO_SUB, _dev->_txfctrl, LEN_TX_FCTRL);
 		}
 
 		void _writeSystemEventMaskRegister() {
-			_writeBytesToRegister(SYS_MASK, NO_SUB, _sysmask, LEN_SYS_MASK);
+			_writeBytesToRegister(SYS_MASK, NO_SUB, _dev->_sysmask, LEN_SYS_MASK);
+		}
+
+		/* antenna delays with the temperature compensation, as written to the device */
+		uint16_t _compensatedAntennaDelay(uint16_t antennaDelay) {
+			int32_t value = (int32_t)antennaDelay + _dev->_compensationState.antennaDelay;
+			return value < 0 ? 0 : (value > 0xFFFF ? 0xFFFF : value);
 		}
 
 		void _writeAntennaDelayRegisters() {
 			byte antennaTxDelayBytes[2];
 			byte antennaRxDelayBytes[2];
-			DW1000NgUtils::writeValueToBytes(antennaTxDelayBytes, _antennaTxDelay, LEN_TX_ANTD);
-			DW1000NgUtils::writeValueToBytes(antennaRxDelayBytes, _antennaRxDelay, LEN_LDE_RXANTD);
+			DW1000NgUtils::writeValueToBytes(antennaTxDelayBytes, _compensatedAntennaDelay(_dev->_antennaTxDelay), LEN_TX_ANTD);
+			DW1000NgUtils::writeValueToBytes(antennaRxDelayBytes, _compensatedAntennaDelay(_dev->_antennaRxDelay), LEN_LDE_RXANTD);
 			_writeBytesToRegister(TX_ANTD, NO_SUB, antennaTxDelayBytes, LEN_TX_ANTD);
 			_writeBytesToRegister(LDE_IF, LDE_RXANTD_SUB, antennaRxDelayBytes, LEN_LDE_RXANTD);
 		}
 
+		/* writes only the registers whose compensation offset changed, returns true if there was any */
+		boolean _applyCompensation(const compensation_state_t& state) {
+			compensation_state_t previous = _dev->_compensationState;
+			_dev->_compensationState = state;
+			if(state.antennaDelay != previous.antennaDelay)
+				_writeAntennaDelayRegisters();
+			if(state.pgDelay != previous.pgDelay)
+				_writeTCPGDelayRegister();
+			if(state.txPower != previous.txPower)
+				_writeTXPowerRegister();
+			return state.antennaDelay != previous.antennaDelay
+				|| state.pgDelay != previous.pgDelay
+				|| state.txPower != previous.txPower;
+		}
+
 		void _writeConfiguration() {
 			// write all configurations back to device
 			_writeSystemConfigurationRegister();
@@ -847,47 +1035,48 @@ namespace DW1000Ng {
 		}
 
 		void _useExtendedFrameLength(boolean val) {
-			DW1000NgUtils::setBit(_syscfg, LEN_SYS_CFG, PHR_MODE_0_BIT, val);
-			DW1000NgUtils::setBit(_syscfg, LEN_SYS_CFG, PHR_MODE_1_BIT, val);
+			_dev->_extendedFrameLength = val;
+			DW1000NgUtils::setBit(_dev->_syscfg, LEN_SYS_CFG, PHR_MODE_0_BIT, val);
+			DW1000NgUtils::setBit(_dev->_syscfg, LEN_SYS_CFG, PHR_MODE_1_BIT, val);
 		}
 
 		void _setReceiverAutoReenable(boolean val) {
-			DW1000NgUtils::setBit(_syscfg, LEN_SYS_CFG, RXAUTR_BIT, val);
+			DW1000NgUtils::setBit(_dev->_syscfg, LEN_SYS_CFG, RXAUTR_BIT, val);
 		}
 
 		void _useFrameCheck(boolean val) {
-			_frameCheck = val;
+			_dev->_frameCheck = val;
 		}
 
 		void _setNlosOptimization(boolean val) {
-			_nlos = val;
-			if(_nlos) {
+			_dev->_nlos = val;
+			if(_dev->_nlos) {
 				_ldecfg1();
 				_ldecfg2();
 			}
 		}
 
 		void _useSmartPower(boolean smartPower) {
-			_smartPower = smartPower;
-			DW1000NgUtils::setBit(_syscfg, LEN_SYS_CFG, DIS_STXP_BIT, !smartPower);
+			_dev->_smartPower = smartPower;
+			DW1000NgUtils::setBit(_dev->_syscfg, LEN_SYS_CFG, DIS_STXP_BIT, !smartPower);
 			_writeSystemConfigurationRegister();
-			if(_autoTXPower)
+			if(_dev->_autoTXPower)
 				_txpowertune();
 		}
 
 		void _setSFDMode(SFDMode mode) {
 			switch(mode) {
 				case SFDMode::STANDARD_SFD:
-					DW1000NgUtils::setBit(_chanctrl, LEN_CHAN_CTRL, DWSFD_BIT, false);
-					DW1000NgUtils::setBit(_chanctrl, LEN_CHAN_CTRL, TNSSFD_BIT, false);
-					DW1000NgUtils::setBit(_chanctrl, LEN_CHAN_CTRL, RNSSFD_BIT, false);
-					_standardSFD = true;
+					DW1000NgUtils::setBit(_dev->_chanctrl, LEN_CHAN_CTRL, DWSFD_BIT, false);
+					DW1000NgUtils::setBit(_dev->_chanctrl, LEN_CHAN_CTRL, TNSSFD_BIT, false);
+					DW1000NgUtils::setBit(_dev->_chanctrl, LEN_CHAN_CTRL, RNSSFD_BIT, false);
+					_dev->_standardSFD = true;
 					break;
 				case SFDMode::DECAWAVE_SFD:
-					DW1000NgUtils::setBit(_chanctrl, LEN_CHAN_CTRL, DWSFD_BIT, true);
-					DW1000NgUtils::setBit(_chanctrl, LEN_CHAN_CTRL, TNSSFD_BIT, true);
-					DW1000NgUtils::setBit(_chanctrl, LEN_CHAN_CTRL, RNSSFD_BIT, true);
-					_standardSFD = false;
+					DW1000NgUtils::setBit(_dev->_chanctrl, LEN_CHAN_CTRL, DWSFD_BIT, true);
+					DW1000NgUtils::setBit(_dev->_chanctrl, LEN_CHAN_CTRL, TNSSFD_BIT, true);
+					DW1000NgUtils::setBit(_dev->_chanctrl, LEN_CHAN_CTRL, RNSSFD_BIT, true);
+					_dev->_standardSFD = false;
 					break;
 				default:
 					return; //TODO Proper error handling
@@ -897,87 +1086,94 @@ namespace DW1000Ng {
 		void _setChannel(Channel channel) {
 			byte chan = static_cast<byte>(channel);
 			chan &= 0xF;
-			_chanctrl[0] = ((chan | (chan << 4)) & 0xFF);
+			_dev->_chanctrl[0] = ((chan | (chan << 4)) & 0xFF);
 
-			_channel = channel;
+			_dev->_channel = channel;
 		}
 
 		void _setDataRate(DataRate data_rate) {
 			byte rate = static_cast<byte>(data_rate);
 			rate &= 0x03;
-			_txfctrl[1] &= 0x83;
-			_txfctrl[1] |= (byte)((rate << 5) & 0xFF);
+			_dev->_txfctrl[1] &= 0x83;
+			_dev->_txfctrl[1] |= (byte)((rate << 5) & 0xFF);
 			// special 110kbps flag
 			if(data_rate == DataRate::RATE_110KBPS) {
-				DW1000NgUtils::setBit(_syscfg, LEN_SYS_CFG, RXM110K_BIT, true);
+				DW1000NgUtils::setBit(_dev->_syscfg, LEN_SYS_CFG, RXM110K_BIT, true);
 			} else {
-				DW1000NgUtils::setBit(_syscfg, LEN_SYS_CFG, RXM110K_BIT, false);
+				DW1000NgUtils::setBit(_dev->_syscfg, LEN_SYS_CFG, RXM110K_BIT, false);
 			}
-			_dataRate = data_rate;
+			_dev->_dataRate = data_rate;
 		}
 
 		void _setPulseFrequency(PulseFrequency frequency) {
 			byte freq = static_cast<byte>(frequency);
 			freq &= 0x03;
-			_txfctrl[2] &= 0xFC;
-			_txfctrl[2] |= (byte)(freq & 0xFF);
-			_chanctrl[2] &= 0xF3;
-			_chanctrl[2] |= (byte)((freq << 2) & 0xFF);
-
-			_pulseFrequency = frequency;
+			_dev->_txfctrl[2] &= 0xFC;
+			_dev->_txfctrl[2] |= (byte)(freq & 0xFF);
+			_dev->_chanctrl[2] &= 0xF3;
+			_dev->_chanctrl[2] |= (byte)((freq << 2) & 0xFF);
+
+			_dev->_pulseFrequency = frequency;
+			if(frequency == PulseFrequency::FREQ_16MHZ) {
+				_dev->_powerOffsetQ16 = POWER_OFFSET_16MHZ_Q16;
+				_dev->_powerCorrectionQ16 = POWER_CORRECTION_16MHZ_Q16;
+			} else {
+				_dev->_powerOffsetQ16 = POWER_OFFSET_64MHZ_Q16;
+				_dev->_powerCorrectionQ16 = POWER_CORRECTION_64MHZ_Q16;
+			}
 		}
 
 		void _setPreambleLength(PreambleLength preamble_length) {
 			byte prealen = static_cast<byte>(preamble_length);
 			prealen &= 0x0F;
-			_txfctrl[2] &= 0xC3;
-			_txfctrl[2] |= (byte)((prealen << 2) & 0xFF);
+			_dev->_txfctrl[2] &= 0xC3;
+			_dev->_txfctrl[2] |= (byte)((prealen << 2) & 0xFF);
 			
 			switch(preamble_length) {
 				case PreambleLength::LEN_64:
-					_pacSize = PacSize::SIZE_8;
+					_dev->_pacSize = PacSize::SIZE_8;
 					break;
 				case PreambleLength::LEN_128:
-					_pacSize = PacSize::SIZE_8;
+					_dev->_pacSize = PacSize::SIZE_8;
 					break;
 				case PreambleLength::LEN_256:
-					_pacSize = PacSize::SIZE_16;
+					_dev->_pacSize = PacSize::SIZE_16;
 					break;
 				case PreambleLength::LEN_512:
-					_pacSize = PacSize::SIZE_16;
+					_dev->_pacSize = PacSize::SIZE_16;
 					break;
 				case PreambleLength::LEN_1024:
-					_pacSize = PacSize::SIZE_32;
+					_dev->_pacSize = PacSize::SIZE_32;
 					break;
 				default:
-					_pacSize = PacSize::SIZE_64; // In case of 1536, 2048 or 4096 preamble length.
+					_dev->_pacSize = PacSize::SIZE_64; // In case of 1536, 2048 or 4096 preamble length.
 			}
 			
-			_preambleLength = preamble_length;
+			_dev->_preambleLength = preamble_length;
 		}
 
 		void _setPreambleCode(PreambleCode preamble_code) {
 			byte preacode = static_cast<byte>(preamble_code);
 			preacode &= 0x1F;
-			_chanctrl[2] &= 0x3F;
-			_chanctrl[2] |= ((preacode << 6) & 0xFF);
-			_chanctrl[3] = 0x00;
-			_chanctrl[3] = ((((preacode >> 2) & 0x07) | (preacode << 3)) & 0xFF);
+			_dev->_chanctrl[2] &= 0x3F;
+			_dev->_chanctrl[2] |= ((preacode << 6) & 0xFF);
+			_dev->_chanctrl[3] = 0x00;
+			_dev->_chanctrl[3] = ((((preacode >> 2) & 0x07) | (preacode << 3)) & 0xFF);
 
-			_preambleCode = preamble_code;
+			_dev->_preambleCode = preamble_code;
 		}
 
-		boolean _checkPreambleCodeValidity() {
-			byte preacode = static_cast<byte>(_preambleCode);
-			if(_pulseFrequency == PulseFrequency::FREQ_16MHZ) {
+		boolean _isPreambleCodeValid(Channel channel, PreambleCode preambleCode) {
+			byte preacode = static_cast<byte>(preambleCode);
+			if(_dev->_pulseFrequency == PulseFrequency::FREQ_16MHZ) {
 				for (auto i = 0; i < 2; i++) {
-					if(preacode == preamble_validity_matrix_PRF16[(int) _channel][i])
+					if(preacode == preamble_validity_matrix_PRF16[(int) channel][i])
 						return true;
 				}
 				return false;
-			} else if (_pulseFrequency == PulseFrequency::FREQ_64MHZ) {
+			} else if (_dev->_pulseFrequency == PulseFrequency::FREQ_64MHZ) {
 				for(auto i = 0; i < 4; i++) {
-					if(preacode == preamble_validity_matrix_PRF64[(int) _channel][i])
+					if(preacode == preamble_validity_matrix_PRF64[(int) channel][i])
 						return true;
 				}
 				return false;
@@ -986,39 +1182,65 @@ namespace DW1000Ng {
 			}
 		}
 
+		boolean _checkPreambleCodeValidity() {
+			return _isPreambleCodeValid(_dev->_channel, _dev->_preambleCode);
+		}
+
+		/* values of the channel and preamble code dependent registers (see _tune()) with the rest of the current configuration */
+		void _channelTuning(Channel channel, PreambleCode preambleCode, channel_tuning_t& tuning) {
+			byte chan = static_cast<byte>(channel) & 0xF;
+			byte preacode = static_cast<byte>(preambleCode) & 0x1F;
+			byte chanctrl[LEN_CHAN_CTRL];
+			memcpy(chanctrl, _dev->_chanctrl, LEN_CHAN_CTRL);
+			chanctrl[0] = ((chan | (chan << 4)) & 0xFF);
+			chanctrl[2] &= 0x3F;
+			chanctrl[2] |= ((preacode << 6) & 0xFF);
+			chanctrl[3] = ((((preacode >> 2) & 0x07) | (preacode << 3)) & 0xFF);
+
+			tuning.channel = channel;
+			tuning.preambleCode = preambleCode;
+			tuning.chanCtrl = DW1000NgUtils::bytesAsValue(chanctrl, LEN_CHAN_CTRL);
+			tuning.ldeRepc = _ldeRepcValue(preambleCode);
+			tuning.txPower = _txPowerValue(channel);
+			tuning.rfTxCtrl = _rfTxCtrlValue(channel);
+			_fsPllValues(channel, tuning.fsPllCfg, tuning.fsPllTune);
+			tuning.rfRxCtrlH = _rfRxCtrlHValue(channel);
+			tuning.tcPgDelay = _tcPgDelayValue(channel);
+		}
+
 		void _setValidPreambleCode() {
 			PreambleCode preamble_code;
 
-			switch(_channel) {
+			switch(_dev->_channel) {
 				case Channel::CHANNEL_1:
-					preamble_code = _pulseFrequency == PulseFrequency::FREQ_16MHZ ? PreambleCode::CODE_2 : PreambleCode::CODE_10;
+					preamble_code = _dev->_pulseFrequency == PulseFrequency::FREQ_16MHZ ? PreambleCode::CODE_2 : PreambleCode::CODE_10;
 					break;
 				case Channel::CHANNEL_3:
-					preamble_code = _pulseFrequency == PulseFrequency::FREQ_16MHZ ? PreambleCode::CODE_6 : PreambleCode::CODE_10;
+					preamble_code = _dev->_pulseFrequency == PulseFrequency::FREQ_16MHZ ? PreambleCode::CODE_6 : PreambleCode::CODE_10;
 					break;
 				case Channel::CHANNEL_4:
 				case Channel::CHANNEL_7:
-					preamble_code = _pulseFrequency == PulseFrequency::FREQ_16MHZ ? PreambleCode::CODE_8 : PreambleCode::CODE_18;
+					preamble_code = _dev->_pulseFrequency == PulseFrequency::FREQ_16MHZ ? PreambleCode::CODE_8 : PreambleCode::CODE_18;
 					break;
 				case Channel::CHANNEL_2:
 				case Channel::CHANNEL_5:
-					preamble_code = _pulseFrequency == PulseFrequency::FREQ_16MHZ ? PreambleCode::CODE_3 : PreambleCode::CODE_10;
+					preamble_code = _dev->_pulseFrequency == PulseFrequency::FREQ_16MHZ ? PreambleCode::CODE_3 : PreambleCode::CODE_10;
 					break;
 				default:
 					return; //TODO Proper Error Handling
 			}
 			byte preacode = static_cast<byte>(preamble_code);
 			preacode &= 0x1F;
-			_chanctrl[2] &= 0x3F;
-			_chanctrl[2] |= ((preacode << 6) & 0xFF);
-			_chanctrl[3] = 0x00;
-			_chanctrl[3] = ((((preacode >> 2) & 0x07) | (preacode << 3)) & 0xFF);
+			_dev->_chanctrl[2] &= 0x3F;
+			_dev->_chanctrl[2] |= ((preacode << 6) & 0xFF);
+			_dev->_chanctrl[3] = 0x00;
+			_dev->_chanctrl[3] = ((((preacode >> 2) & 0x07) | (preacode << 3)) & 0xFF);
 
-			_preambleCode = preamble_code;
+			_dev->_preambleCode = preamble_code;
 		}
 
 		void _setNonStandardSFDLength() {
-			switch(_dataRate) {
+			switch(_dev->_dataRate) {
 				case DataRate::RATE_6800KBPS:
 					_writeSingleByteToRegister(USR_SFD, SFD_LENGTH_SUB, 0x08);
 					break;
@@ -1034,43 +1256,36 @@ namespace DW1000Ng {
 		}
 
 		void _interruptOnSent(boolean val) {
-			DW1000NgUtils::setBit(_sysmask, LEN_SYS_MASK, TXFRS_BIT, val);
+			DW1000NgUtils::setBit(_dev->_sysmask, LEN_SYS_MASK, TXFRS_BIT, val);
 		}
 
 		void _interruptOnReceived(boolean val) {
-			DW1000NgUtils::setBit(_sysmask, LEN_SYS_MASK, RXDFR_BIT, val);
-			DW1000NgUtils::setBit(_sysmask, LEN_SYS_MASK, RXFCG_BIT, val);
+			DW1000NgUtils::setBit(_dev->_sysmask, LEN_SYS_MASK, RXDFR_BIT, val);
+			DW1000NgUtils::setBit(_dev->_sysmask, LEN_SYS_MASK, RXFCG_BIT, val);
 		}
 
 		void _interruptOnReceiveFailed(boolean val) {
-			DW1000NgUtils::setBit(_sysmask, LEN_SYS_STATUS, RXPHE_BIT, val);
-			DW1000NgUtils::setBit(_sysmask, LEN_SYS_STATUS, RXFCE_BIT, val);
-			DW1000NgUtils::setBit(_sysmask, LEN_SYS_STATUS, RXRFSL_BIT, val);
-			DW1000NgUtils::setBit(_sysmask, LEN_SYS_STATUS, LDEERR_BIT, val);
+			DW1000NgUtils::setBit(_dev->_sysmask, LEN_SYS_STATUS, RXPHE_BIT, val);
+			DW1000NgUtils::setBit(_dev->_sysmask, LEN_SYS_STATUS, RXFCE_BIT, val);
+			DW1000NgUtils::setBit(_dev->_sysmask, LEN_SYS_STATUS, RXRFSL_BIT, val);
+			DW1000NgUtils::setBit(_dev->_sysmask, LEN_SYS_STATUS, LDEERR_BIT, val);
 		}
 
 		void _interruptOnReceiveTimeout(boolean val) {
-			DW1000NgUtils::setBit(_sysmask, LEN_SYS_MASK, RXRFTO_BIT, val);
-			DW1000NgUtils::setBit(_sysmask, LEN_SYS_MASK, RXPTO_BIT, val);
-			DW1000NgUtils::setBit(_sysmask, LEN_SYS_MASK, RXSFDTO_BIT, val);
+			DW1000NgUtils::setBit(_dev->_sysmask, LEN_SYS_MASK, RXRFTO_BIT, val);
+			DW1000NgUtils::setBit(_dev->_sysmask, LEN_SYS_MASK, RXPTO_BIT, val);
+			DW1000NgUtils::setBit(_dev->_sysmask, LEN_SYS_MASK, RXSFDTO_BIT, val);
 		}
 
 		void _interruptOnReceiveTimestampAvailable(boolean val) {
-			DW1000NgUtils::setBit(_sysmask, LEN_SYS_MASK, LDEDONE_BIT, val);
+			DW1000NgUtils::setBit(_dev->_sysmask, LEN_SYS_MASK, LDEDONE_BIT, val);
 		}
 
 		void _interruptOnAutomaticAcknowledgeTrigger(boolean val) {
-			DW1000NgUtils::setBit(_sysmask, LEN_SYS_MASK, AAT_BIT, val);
+			DW1000NgUtils::setBit(_dev->_sysmask, LEN_SYS_MASK, AAT_BIT, val);
 		}
 
 		void _manageLDE() {
-			// transfer any ldo tune values
-			byte ldoTune[LEN_OTP_RDAT];
-			uint16_t LDOTUNE_ADDRESS = 0x04;
-			_readBytesOTP(LDOTUNE_ADDRESS, ldoTune); // TODO #define
-			if(ldoTune[0] != 0) {
-				// TODO tuning available, copy over to RAM: use OTP_LDO bit
-			}
 			// tell the chip to load the LDE microcode
 			// TODO remove clock-related code (PMSC_CTRL) as handled separately
 			byte pmscctrl0[LEN_PMSC_CTRL0];
@@ -1086,72 +1301,87 @@ namespace DW1000Ng {
 			_writeBytesToRegister(PMSC, PMSC_CTRL0_SUB, pmscctrl0, 2);
 			// uCode
 			_enableClock(LDE_CLOCK);
-			delay(5);
 			_writeBytesToRegister(OTP_IF, OTP_CTRL_SUB, otpctrl, 2);
-			delay(1);
+			// the load takes up to 120 us, LDELOAD clears when it is done
+			uint32_t start = micros();
+			do {
+				_readBytesFromRegister(OTP_IF, OTP_CTRL_SUB, otpctrl, LEN_OTP_CTRL);
+			} while(DW1000NgUtils::getBit(otpctrl, LEN_OTP_CTRL, LDELOAD_BIT) && micros() - start < LDE_LOAD_TIMEOUT);
 			_enableClock(SYS_AUTO_CLOCK);
-			delay(5);
 			pmscctrl0[0] = 0x00;
 			pmscctrl0[1] &= 0x02;
 			_writeBytesToRegister(PMSC, PMSC_CTRL0_SUB, pmscctrl0, 2);
 		}
 
-		/* Crystal calibration from OTP (if available)
-		* FS_XTALT - reg:0x2B, sub-reg:0x0E
-		* OTP(one-time-programmable) memory map - table 10 */
-		void _fsxtalt() {
+		/* Reads the factory calibration into the cache, one read mode session per block of the OTP memory map (table 10) */
+		void _readOTPCalibration() {
+			byte otp[3 * LEN_OTP_RDAT];
+			_readBytesOTP(OTP_EUI_ADDRESS, otp, 2);
+			memcpy(_dev->_otp.eui, otp, LEN_EUI);
+			_readBytesOTP(OTP_LDOTUNE_ADDRESS, otp, 2);
+			memcpy(_dev->_otp.ldoTune, otp, LEN_OTP_LDOTUNE);
+			_readBytesOTP(OTP_VMEAS_ADDRESS, otp, 2); // the stored 3.3 V and 23C readings
+			_dev->_otp.vmeas3v3 = otp[0];
+			_dev->_otp.tmeas23C = otp[(OTP_TMEAS_ADDRESS - OTP_VMEAS_ADDRESS) * LEN_OTP_RDAT];
+			_readBytesOTP(OTP_ANTENNA_DELAY_ADDRESS, otp, 3); // antenna delay, reserved, crystal trim
+			_dev->_otp.antennaDelay16MHz = DW1000NgUtils::bytesAsValue(&otp[0], 2);
+			_dev->_otp.antennaDelay64MHz = DW1000NgUtils::bytesAsValue(&otp[2], 2);
+			_dev->_otp.xtalTrim = otp[(OTP_XTAL_TRIM_ADDRESS - OTP_ANTENNA_DELAY_ADDRESS) * LEN_OTP_RDAT] & 0x1F;
+		}
+
+		/* Crystal trim (FS_XTALT - reg:0x2B, sub-reg:0x0E) and, if programmed, LDO tune from the cached calibration */
+		void _writeOTPCalibration() {
 			byte fsxtalt[LEN_FS_XTALT];
-			byte buf_otp[4];
-			_readBytesOTP(0x01E, buf_otp); //0x01E -> byte[0]=XTAL_Trim
-			if (buf_otp[0] == 0) {
+			if (_dev->_otp.xtalTrim == 0) {
 				// No trim value available from OTP, use midrange value of 0x10
 				DW1000NgUtils::writeValueToBytes(fsxtalt, ((0x10 & 0x1F) | 0x60), LEN_FS_XTALT);
 			} else {
-				DW1000NgUtils::writeValueToBytes(fsxtalt, ((buf_otp[0] & 0x1F) | 0x60), LEN_FS_XTALT);
+				DW1000NgUtils::writeValueToBytes(fsxtalt, (_dev->_otp.xtalTrim | 0x60), LEN_FS_XTALT);
 			}
-			// write configuration back to chip
 			_writeBytesToRegister(FS_CTRL, FS_XTALT_SUB, fsxtalt, LEN_FS_XTALT);
+			if(_dev->_otp.ldoTune[0] != 0)
+				_writeBytesToRegister(RF_CONF, RF_LDOTUNE_SUB, _dev->_otp.ldoTune, LEN_RF_LDOTUNE);
 		}
 
 		void _clearReceiveStatus() {
 			// clear latched RX bits (i.e. write 1 to clear)
-			DW1000NgUtils::setBit(_sysstatus, LEN_SYS_STATUS, RXDFR_BIT, true);
-			DW1000NgUtils::setBit(_sysstatus, LEN_SYS_STATUS, RXFCG_BIT, true);
-			DW1000NgUtils::setBit(_sysstatus, LEN_SYS_STATUS, RXPRD_BIT, true);
-			DW1000NgUtils::setBit(_sysstatus, LEN_SYS_STATUS, RXSFDD_BIT, true);
-			DW1000NgUtils::setBit(_sysstatus, LEN_SYS_STATUS, RXPHD_BIT, true);
-			DW1000NgUtils::setBit(_sysstatus, LEN_SYS_STATUS, LDEDONE_BIT, true);
-			_writeBytesToRegister(SYS_STATUS, NO_SUB, _sysstatus, LEN_SYS_STATUS);
+			DW1000NgUtils::setBit(_dev->_sysstatus, LEN_SYS_STATUS, RXDFR_BIT, true);
+			DW1000NgUtils::setBit(_dev->_sysstatus, LEN_SYS_STATUS, RXFCG_BIT, true);
+			DW1000NgUtils::setBit(_dev->_sysstatus, LEN_SYS_STATUS, RXPRD_BIT, true);
+			DW1000NgUtils::setBit(_dev->_sysstatus, LEN_SYS_STATUS, RXSFDD_BIT, true);
+			DW1000NgUtils::setBit(_dev->_sysstatus, LEN_SYS_STATUS, RXPHD_BIT, true);
+			DW1000NgUtils::setBit(_dev->_sysstatus, LEN_SYS_STATUS, LDEDONE_BIT, true);
+			_writeBytesToRegister(SYS_STATUS, NO_SUB, _dev->_sysstatus, LEN_SYS_STATUS);
 		}
 
 		void _clearReceiveTimestampAvailableStatus() {
-			DW1000NgUtils::setBit(_sysstatus, LEN_SYS_STATUS, LDEDONE_BIT, true);
-			_writeBytesToRegister(SYS_STATUS, NO_SUB, _sysstatus, LEN_SYS_STATUS);
+			DW1000NgUtils::setBit(_dev->_sysstatus, LEN_SYS_STATUS, LDEDONE_BIT, true);
+			_writeBytesToRegister(SYS_STATUS, NO_SUB, _dev->_sysstatus, LEN_SYS_STATUS);
 		}
 
 		void _clearReceiveTimeoutStatus() {
-			DW1000NgUtils::setBit(_sysstatus, LEN_SYS_STATUS, RXRFTO_BIT, true);
-			DW1000NgUtils::setBit(_sysstatus, LEN_SYS_STATUS, RXPTO_BIT, true);
-			DW1000NgUtils::setBit(_sysstatus, LEN_SYS_STATUS, RXSFDTO_BIT, true);
-			_writeBytesToRegister(SYS_STATUS, NO_SUB, _sysstatus, LEN_SYS_STATUS);
+			DW1000NgUtils::setBit(_dev->_sysstatus, LEN_SYS_STATUS, RXRFTO_BIT, true);
+			DW1000NgUtils::setBit(_dev->_sysstatus, LEN_SYS_STATUS, RXPTO_BIT, true);
+			DW1000NgUtils::setBit(_dev->_sysstatus, LEN_SYS_STATUS, RXSFDTO_BIT, true);
+			_writeBytesToRegister(SYS_STATUS, NO_SUB, _dev->_sysstatus, LEN_SYS_STATUS);
 		}
 
 		void _clearReceiveFailedStatus() {
-			DW1000NgUtils::setBit(_sysstatus, LEN_SYS_STATUS, RXPHE_BIT, true);
-			DW1000NgUtils::setBit(_sysstatus, LEN_SYS_STATUS, RXFCE_BIT, true);
-			DW1000NgUtils::setBit(_sysstatus, LEN_SYS_STATUS, RXRFSL_BIT, true);
-			DW1000NgUtils::setBit(_sysstatus, LEN_SYS_STATUS, AFFREJ_BIT, true);
-			DW1000NgUtils::setBit(_sysstatus, LEN_SYS_STATUS, LDEERR_BIT, true);
-			_writeBytesToRegister(SYS_STATUS, NO_SUB, _sysstatus, LEN_SYS_STATUS);
+			DW1000NgUtils::setBit(_dev->_sysstatus, LEN_SYS_STATUS, RXPHE_BIT, true);
+			DW1000NgUtils::setBit(_dev->_sysstatus, LEN_SYS_STATUS, RXFCE_BIT, true);
+			DW1000NgUtils::setBit(_dev->_sysstatus, LEN_SYS_STATUS, RXRFSL_BIT, true);
+			DW1000NgUtils::setBit(_dev->_sysstatus, LEN_SYS_STATUS, AFFREJ_BIT, true);
+			DW1000NgUtils::setBit(_dev->_sysstatus, LEN_SYS_STATUS, LDEERR_BIT, true);
+			_writeBytesToRegister(SYS_STATUS, NO_SUB, _dev->_sysstatus, LEN_SYS_STATUS);
 		}
 
 		void _clearTransmitStatus() {
-			DW1000NgUtils::setBit(_sysstatus, LEN_SYS_STATUS, AAT_BIT, true);
-			DW1000NgUtils::setBit(_sysstatus, LEN_SYS_STATUS, TXFRB_BIT, true);
-			DW1000NgUtils::setBit(_sysstatus, LEN_SYS_STATUS, TXPRS_BIT, true);
-			DW1000NgUtils::setBit(_sysstatus, LEN_SYS_STATUS, TXPHS_BIT, true);
-			DW1000NgUtils::setBit(_sysstatus, LEN_SYS_STATUS, TXFRS_BIT, true);
-			_writeBytesToRegister(SYS_STATUS, NO_SUB, _sysstatus, LEN_SYS_STATUS);
+			DW1000NgUtils::setBit(_dev->_sysstatus, LEN_SYS_STATUS, AAT_BIT, true);
+			DW1000NgUtils::setBit(_dev->_sysstatus, LEN_SYS_STATUS, TXFRB_BIT, true);
+			DW1000NgUtils::setBit(_dev->_sysstatus, LEN_SYS_STATUS, TXPRS_BIT, true);
+			DW1000NgUtils::setBit(_dev->_sysstatus, LEN_SYS_STATUS, TXPHS_BIT, true);
+			DW1000NgUtils::setBit(_dev->_sysstatus, LEN_SYS_STATUS, TXFRS_BIT, true);
+			_writeBytesToRegister(SYS_STATUS, NO_SUB, _dev->_sysstatus, LEN_SYS_STATUS);
 		}
 
 		void _resetReceiver() {
@@ -1164,61 +1394,80 @@ namespace DW1000Ng {
 		/* Internal helpers to read configuration */
 
 		void _readSystemConfigurationRegister() {
-			_readBytesFromRegister(SYS_CFG, NO_SUB, _syscfg, LEN_SYS_CFG);
+			_readBytesFromRegister(SYS_CFG, NO_SUB, _dev->_syscfg, LEN_SYS_CFG);
 		}
 
 		void _readSystemEventStatusRegister() {
-			_readBytesFromRegister(SYS_STATUS, NO_SUB, _sysstatus, LEN_SYS_STATUS);
+			_readBytesFromRegister(SYS_STATUS, NO_SUB, _dev->_sysstatus, LEN_SYS_STATUS);
 		}
 
 		void _readNetworkIdAndDeviceAddress() {
-			_readBytesFromRegister(PANADR, NO_SUB, _networkAndAddress, LEN_PANADR);
+			_readBytesFromRegister(PANADR, NO_SUB, _dev->_networkAndAddress, LEN_PANADR);
+		}
+
+		void _readExtendedUniqueIdentifier() {
+			_readBytesFromRegister(EUI, NO_SUB, _dev->_eui, LEN_EUI);
 		}
 
 		void _readSystemEventMaskRegister() {
-			_readBytesFromRegister(SYS_MASK, NO_SUB, _sysmask, LEN_SYS_MASK);
+			_readBytesFromRegister(SYS_MASK, NO_SUB, _dev->_sysmask, LEN_SYS_MASK);
 		}
 
 		void _readChannelControlRegister() {
-			_readBytesFromRegister(CHAN_CTRL, NO_SUB, _chanctrl, LEN_CHAN_CTRL);
+			_readBytesFromRegister(CHAN_CTRL, NO_SUB, _dev->_chanctrl, LEN_CHAN_CTRL);
 		}
 
 		void _readTransmitFrameControlRegister() {
-			_readBytesFromRegister(TX_FCTRL, NO_SUB, _txfctrl, LEN_TX_FCTRL);
+			_readBytesFromRegister(TX_FCTRL, NO_SUB, _dev->_txfctrl, LEN_TX_FCTRL);
 		}
 
 		boolean _isTransmitDone() {
-			return DW1000NgUtils::getBit(_sysstatus, LEN_SYS_STATUS, TXFRS_BIT);
+			return DW1000NgUtils::getBit(_dev->_sysstatus, LEN_SYS_STATUS, TXFRS_BIT);
 		}
 
 		boolean _isReceiveTimestampAvailable() {
-			return DW1000NgUtils::getBit(_sysstatus, LEN_SYS_STATUS, LDEDONE_BIT);
+			return DW1000NgUtils::getBit(_dev->_sysstatus, LEN_SYS_STATUS, LDEDONE_BIT);
 		}
 
 		boolean _isReceiveDone() {
-			if(_frameCheck) {
-				return (DW1000NgUtils::getBit(_sysstatus, LEN_SYS_STATUS, RXFCG_BIT) &&
-						DW1000NgUtils::getBit(_sysstatus, LEN_SYS_STATUS, RXDFR_BIT));
+			if(_dev->_frameCheck) {
+				return (DW1000NgUtils::getBit(_dev->_sysstatus, LEN_SYS_STATUS, RXFCG_BIT) &&
+						DW1000NgUtils::getBit(_dev->_sysstatus, LEN_SYS_STATUS, RXDFR_BIT));
 			}
-			return DW1000NgUtils::getBit(_sysstatus, LEN_SYS_STATUS, RXDFR_BIT);
+			return DW1000NgUtils::getBit(_dev->_sysstatus, LEN_SYS_STATUS, RXDFR_BIT);
 		}
 
 		boolean _isReceiveFailed() {
-			return (DW1000NgUtils::getBit(_sysstatus, LEN_SYS_STATUS, RXPHE_BIT) ||
-					DW1000NgUtils::getBit(_sysstatus, LEN_SYS_STATUS, RXFCE_BIT) ||
-					DW1000NgUtils::getBit(_sysstatus, LEN_SYS_STATUS, RXRFSL_BIT) ||
-					DW1000NgUtils::getBit(_sysstatus, LEN_SYS_STATUS, LDEERR_BIT));
+			return (DW1000NgUtils::getBit(_dev->_sysstatus, LEN_SYS_STATUS, RXPHE_BIT) ||
+					DW1000NgUtils::getBit(_dev->_sysstatus, LEN_SYS_STATUS, RXFCE_BIT) ||
+					DW1000NgUtils::getBit(_dev->_sysstatus, LEN_SYS_STATUS, RXRFSL_BIT) ||
+					DW1000NgUtils::getBit(_dev->_sysstatus, LEN_SYS_STATUS, LDEERR_BIT));
 		}
 
 		boolean _isReceiveTimeout() {
-			return (DW1000NgUtils::getBit(_sysstatus, LEN_SYS_STATUS, RXRFTO_BIT) || 
-					DW1000NgUtils::getBit(_sysstatus, LEN_SYS_STATUS, RXPTO_BIT) || 
-					DW1000NgUtils::getBit(_sysstatus, LEN_SYS_STATUS, RXSFDTO_BIT));
+			return (DW1000NgUtils::getBit(_dev->_sysstatus, LEN_SYS_STATUS, RXRFTO_BIT) || 
+					DW1000NgUtils::getBit(_dev->_sysstatus, LEN_SYS_STATUS, RXPTO_BIT) || 
+					DW1000NgUtils::getBit(_dev->_sysstatus, LEN_SYS_STATUS, RXSFDTO_BIT));
+		}
+
+		/* HPDWARN (bit 27) and TXPUTE (bit 34): the 16 bits from SYS_STATUS byte 3 are read, as the reference driver does,
+		   so other latched events in _dev->_sysstatus are not touched */
+		boolean _isDelayedTransmitError() {
+			byte status[2];
+			_readBytesFromRegister(SYS_STATUS, HPDWARN_BIT / 8, status, 2);
+			return bitRead(status[0], HPDWARN_BIT % 8) || bitRead(status[1], TXPUTE_BIT);
+		}
+
+		void _clearDelayedTransmitError() {
+			byte status[2] = {0, 0};
+			bitSet(status[0], HPDWARN_BIT % 8);
+			bitSet(status[1], TXPUTE_BIT);
+			_writeBytesToRegister(SYS_STATUS, HPDWARN_BIT / 8, status, 2);
 		}
 
 		boolean _isClockProblem() {
-			return (DW1000NgUtils::getBit(_sysstatus, LEN_SYS_STATUS, CLKPLL_LL_BIT) ||
-					DW1000NgUtils::getBit(_sysstatus, LEN_SYS_STATUS, RFPLL_LL_BIT));
+			return (DW1000NgUtils::getBit(_dev->_sysstatus, LEN_SYS_STATUS, CLKPLL_LL_BIT) ||
+					DW1000NgUtils::getBit(_dev->_sysstatus, LEN_SYS_STATUS, RFPLL_LL_BIT));
 		}
 
 		void _disableSequencing() {
@@ -1235,6 +1484,59 @@ namespace DW1000Ng {
             _writeBytesToRegister(RF_CONF, RF_CONF_SUB, enable_mask, LEN_RX_CONF_SUB);
         }
 
+		/* Converts log2(power ratio) to dBm, see 4.7.1 and 4.7.2 of the User Manual. Everything is Q16.16 */
+		int32_t _correctPowerQ16(int32_t log2RatioQ16) {
+			constexpr int64_t TEN_LOG10_2_Q16 = 197283; // 10*log10(2)
+			int32_t estPwr = static_cast<int32_t>((log2RatioQ16 * TEN_LOG10_2_Q16) / 65536) - _dev->_powerOffsetQ16;
+			constexpr int32_t threshold = -(static_cast<int32_t>(88) << 16);
+			if(estPwr <= threshold) {
+				return estPwr;
+			}
+			// approximation of Fig. 22 in user manual for dbm correction
+			return estPwr + static_cast<int32_t>((static_cast<int64_t>(estPwr - threshold) * _dev->_powerCorrectionQ16) / 65536);
+		}
+
+		boolean _isDeviceIdValid() {
+			byte deviceId[LEN_DEV_ID];
+			_readBytesFromRegister(DEV_ID, NO_SUB, deviceId, LEN_DEV_ID);
+			return DW1000NgUtils::bytesAsValue(deviceId, LEN_DEV_ID) == 0xDECA0130;
+		}
+
+		/* Polls DEV_ID until the device answers, returns false if it still does not after timeout μs */
+		boolean _waitForDeviceId(uint32_t start, uint32_t timeout) {
+			while(!_isDeviceIdValid()) {
+				if(micros() - start >= timeout)
+					return false;
+				#if defined(ESP8266)
+				yield();
+				#endif
+			}
+			return true;
+		}
+
+		/* Polls SYS_STATUS until bit is set, returns false if it is still clear after timeout μs */
+		boolean _waitForStatusBit(uint16_t bit, uint32_t start, uint32_t timeout) {
+			byte status;
+			do {
+				_readBytesFromRegister(SYS_STATUS, bit / 8, &status, 1);
+				if(bitRead(status, bit % 8))
+					return true;
+			} while(micros() - start < timeout);
+			return false;
+		}
+
+		/* FACE and AMCE must be set to read the accumulator memory, and the RX clock forced to the 125 MHz PLL (RXCLKS = 10):
+		   after a reception the receiver is off and RXCLKS auto has gated it. Disabling goes back to RXCLKS auto */
+		void _enableAccumulatorClock(boolean enable) {
+			byte pmscctrl0[LEN_PMSC_CTRL0];
+			_readBytesFromRegister(PMSC, PMSC_CTRL0_SUB, pmscctrl0, LEN_PMSC_CTRL0);
+			DW1000NgUtils::setBit(pmscctrl0, LEN_PMSC_CTRL0, RXCLKS_BIT, false);
+			DW1000NgUtils::setBit(pmscctrl0, LEN_PMSC_CTRL0, RXCLKS_BIT + 1, enable);
+			DW1000NgUtils::setBit(pmscctrl0, LEN_PMSC_CTRL0, FACE_BIT, enable);
+			DW1000NgUtils::setBit(pmscctrl0, LEN_PMSC_CTRL0, AMCE_BIT, enable);
+			_writeBytesToRegister(PMSC, PMSC_CTRL0_SUB, pmscctrl0, 2);
+		}
+
 		void _uploadConfigToAON() {
 			/* Write 1 in UPL_CFG_BIT */
 			_writeValueToRegister(AON, AON_CTRL_SUB, 0x04, LEN_AON_CTRL);
@@ -1245,54 +1547,80 @@ namespace DW1000Ng {
 
 	/* ####################### PUBLIC ###################### */
 
-	void initialize(uint8_t ss, uint8_t irq, uint8_t rst, SPIClass&spi) {
-		// generous initial init/wake-up-idle delay
-		delay(5);
-		_ss = ss;
-		_irq = irq;
-		_rst = rst;
+	boolean initialize(uint8_t ss, uint8_t irq, uint8_t rst, SPIClass&spi) {
+		uint32_t start = micros();
+		uint32_t step = start;
+		_dev->_bootTiming = boot_timing_t();
+		_dev->_ss = ss;
+		_dev->_irq = irq;
+		_dev->_rst = rst;
 
 		if(rst != 0xff) {
 			// DW1000 data sheet v2.08 §5.6.1 page 20, the RSTn pin should not be driven high but left floating.
-			pinMode(_rst, INPUT);
+			pinMode(_dev->_rst, INPUT);
 		}
 
+		_dev->_spi = &spi;
 		SPIporting::SPIinit(spi);
 		// pin and basic member setup
 		// attach interrupt
 		// TODO throw error if pin is not a interrupt pin
-		if(_irq != 0xff)
-			attachInterrupt(digitalPinToInterrupt(_irq), interruptServiceRoutine, RISING);
-		SPIporting::SPIselect(_ss, _irq);
+		if(_dev->_irq != 0xff) {
+			/* the reset restores the active high polarity */
+			_dev->_interruptActiveHigh = true;
+			_registerInterruptDevice(_dev);
+			attachInterrupt(digitalPinToInterrupt(_dev->_irq), _dispatchInterrupt, RISING);
+		}
+		SPIporting::SPIselect(_dev->_ss, _dev->_irq);
+		// the clock PLL is not locked before the end of the initialization
+		_setSPIspeed(SPIClock::SLOW);
+		// wait for the power-up (crystal start-up), instead of a generous fixed delay
+		boolean ready = _waitForDeviceId(step, POWER_UP_TIMEOUT);
+		_dev->_bootTiming.powerUp = micros() - step;
+		step = micros();
+		if(!ready) {
+			_dev->_bootTiming.total = micros() - start;
+			return false;
+		}
+
 		// reset chip (either soft or hard)
-		reset();
+		ready = reset();
+		_dev->_bootTiming.reset = micros() - step;
+		step = micros();
+		if(!ready) {
+			_dev->_bootTiming.total = micros() - start;
+			return false;
+		}
 		
-		SPIporting::setSPIspeed(SPIClock::SLOW);
+		_setSPIspeed(SPIClock::SLOW);
 		_enableClock(SYS_XTI_CLOCK);
-		delay(5);
 
 		// Configure the CPLL lock detect
 		_writeBitToRegister(EXT_SYNC, EC_CTRL_SUB, LEN_EC_CTRL, PLLLDT_BIT, true);
 
-		// Configure XTAL trim
-		_fsxtalt();
+		// read the factory calibration (XTAL trim, LDO tune, temp and vbat readings recorded during production test, ...)
+		// see 6.3.1 OTP memory map
+		_readOTPCalibration();
+		_writeOTPCalibration();
+		_dev->_bootTiming.otp = micros() - step;
+		step = micros();
 
 		// load LDE micro-code
 		_manageLDE();
-
-		// read the temp and vbat readings from OTP that were recorded during production test
-		// see 6.3.1 OTP memory map
-		byte buf_otp[4];
-		_readBytesOTP(0x008, buf_otp); // the stored 3.3 V reading
-		_vmeas3v3 = buf_otp[0];
-		_readBytesOTP(0x009, buf_otp); // the stored 23C reading
-		_tmeas23C = buf_otp[0];
+		_dev->_bootTiming.lde = micros() - step;
+		step = micros();
 
 		_enableClock(SYS_AUTO_CLOCK);
-		delay(5);
-		SPIporting::setSPIspeed(SPIClock::FAST);
+		ready = _waitForStatusBit(CPLOCK_BIT, step, PLL_LOCK_TIMEOUT);
+		_dev->_bootTiming.pllLock = micros() - step;
+		if(!ready) {
+			_dev->_bootTiming.total = micros() - start;
+			return false;
+		}
+		_setSPIspeed(SPIClock::FAST);
 
 		_readNetworkIdAndDeviceAddress();
+		_readExtendedUniqueIdentifier();
 		_readSystemConfigurationRegister();
 		_readChannelControlRegister();
 		_readTransmitFrameControlRegister();
@@ -1300,36 +1628,63 @@ namespace DW1000Ng {
 
 		/* Cleared AON:CFG1(0x2C:0x0A) for proper operation of deepSleep */
 		_writeValueToRegister(AON, AON_CFG1_SUB, 0x00, LEN_AON_CFG1);
-		
+		_dev->_bootTiming.total = micros() - start;
+		return true;
+	}
+
+	boolean initializeNoInterrupt(uint8_t ss, uint8_t rst) {
+		return initialize(ss, 0xff, rst);
+	}
+
+	boolean initialize(DW1000NgDevice& device, uint8_t ss, uint8_t irq, uint8_t rst, SPIClass&spi) {
+		select(device);
+		return initialize(ss, irq, rst, spi);
+	}
+
+	void getOTPCalibration(otp_calibration_t& calibration) {
+		calibration = _dev->_otp;
+	}
+
+	void getBootTiming(boot_timing_t& timing) {
+		timing = _dev->_bootTiming;
+	}
+
+	void select(DW1000NgDevice& device) {
+		if(_dev != &device)
+			_bindDevice(&device);
+	}
+
+	DW1000NgDevice& getSelectedDevice() {
+		return *_dev;
 	}
 
-	void initializeNoInterrupt(uint8_t ss, uint8_t rst) {
-		initialize(ss, 0xff, rst);
+	DW1000NgDevice& getDefaultDevice() {
+		return _defaultDevice;
 	}
 
 	/* callback handler management. */
 	void attachErrorHandler(void (* handleError)(void)) {
-		_handleError = handleError;
+		_dev->_handleError = handleError;
 	}
 	
 	void attachSentHandler(void (* handleSent)(void)) {
-		_handleSent = handleSent;
+		_dev->_handleSent = handleSent;
 	}
 	
 	void attachReceivedHandler(void (* handleReceived)(void)) {
-		_handleReceived = handleReceived;
+		_dev->_handleReceived = handleReceived;
 	}
 	
 	void attachReceiveFailedHandler(void (* handleReceiveFailed)(void)) {
-		_handleReceiveFailed = handleReceiveFailed;
+		_dev->_handleReceiveFailed = handleReceiveFailed;
 	}
 	
 	void attachReceiveTimeoutHandler(void (* handleReceiveTimeout)(void)) {
-		_handleReceiveTimeout = handleReceiveTimeout;
+		_dev->_handleReceiveTimeout = handleReceiveTimeout;
 	}
 	
 	void attachReceiveTimestampAvailableHandler(void (* handleReceiveTimestampAvailable)(void)) {
-		_handleReceiveTimestampAvailable = handleReceiveTimestampAvailable;
+		_dev->_handleReceiveTimestampAvailable = handleReceiveTimestampAvailable;
 	}
 
 #if defined(ESP8266)
@@ -1337,42 +1692,48 @@ namespace DW1000Ng {
 #else
 	void interruptServiceRoutine() {
 #endif		// read current status and handle via callbacks
+		DW1000NG_PROBE_MARK();
 		_readSystemEventStatusRegister();
-		if(_isClockProblem() /* TODO and others */ && _handleError != 0) {
-			(*_handleError)();
+		DW1000NG_PROBE(ProbePoint::STATUS_READ);
+		if(_isClockProblem() /* TODO and others */ && _dev->_handleError != 0) {
+			(*_dev->_handleError)();
 		}
 		if(_isTransmitDone()) {
 			_clearTransmitStatus();
-			if(_handleSent != nullptr)
-				(*_handleSent)();
+			if(_dev->_handleSent != nullptr)
+				(*_dev->_handleSent)();
 		}
 		if(_isReceiveTimestampAvailable()) {
 			_clearReceiveTimestampAvailableStatus();
-			if(_handleReceiveTimestampAvailable != nullptr)
-				(*_handleReceiveTimestampAvailable)();
+			if(_dev->_handleReceiveTimestampAvailable != nullptr)
+				(*_dev->_handleReceiveTimestampAvailable)();
 		}
 		if(_isReceiveFailed()) {
 			_clearReceiveFailedStatus();
 			forceTRxOff();
 			_resetReceiver();
-			if(_handleReceiveFailed != nullptr)
-				(*_handleReceiveFailed)();
+			if(_dev->_handleReceiveFailed != nullptr)
+				(*_dev->_handleReceiveFailed)();
 		} else if(_isReceiveTimeout()) {
 			_clearReceiveTimeoutStatus();
 			forceTRxOff();
 			_resetReceiver();
-			if(_handleReceiveTimeout != nullptr)
-				(*_handleReceiveTimeout)();
+			if(_dev->_handleReceiveTimeout != nullptr)
+				(*_dev->_handleReceiveTimeout)();
 		} else if(_isReceiveDone()) {
 			_clearReceiveStatus();
-			if(_handleReceived != nullptr)
-				(*_handleReceived)();
+			if(_dev->_handleReceived != nullptr)
+				(*_dev->_handleReceived)();
 		}
+		DW1000NG_PROBE(ProbePoint::ISR);
 	}
 
 	boolean isTransmitDone(){
 		_readSystemEventStatusRegister();
-		return _isTransmitDone();
+		if(!_isTransmitDone())
+			return false;
+		DW1000NG_PROBE_MARK();
+		return true;
 	}
 
 	void clearTransmitStatus() {
@@ -1381,7 +1742,10 @@ namespace DW1000Ng {
 
 	boolean isReceiveDone() {
 		_readSystemEventStatusRegister();
-		return _isReceiveDone();
+		if(!_isReceiveDone())
+			return false;
+		DW1000NG_PROBE_MARK();
+		return true;
 	}
 
 	void clearReceiveStatus() {
@@ -1410,6 +1774,11 @@ namespace DW1000Ng {
 		_resetReceiver();
 	}
 
+	boolean isAutoAcknowledgeTriggered() {
+		_readSystemEventStatusRegister();
+		return DW1000NgUtils::getBit(_dev->_sysstatus, LEN_SYS_STATUS, AAT_BIT);
+	}
+
 	void enableDebounceClock() {
 		byte pmscctrl0[LEN_PMSC_CTRL0];
 		memset(pmscctrl0, 0, LEN_PMSC_CTRL0);
@@ -1417,7 +1786,7 @@ namespace DW1000Ng {
 		DW1000NgUtils::setBit(pmscctrl0, LEN_PMSC_CTRL0, GPDCE_BIT, 1);
 		DW1000NgUtils::setBit(pmscctrl0, LEN_PMSC_CTRL0, KHZCLKEN_BIT, 1);
 		_writeBytesToRegister(PMSC, PMSC_CTRL0_SUB, pmscctrl0, LEN_PMSC_CTRL0);
-		_debounceClockEnabled = true;
+		_dev->_debounceClockEnabled = true;
 	}
 
 	void enableLedBlinking() {
@@ -1459,6 +1828,9 @@ namespace DW1000Ng {
 		DW1000NgUtils::setBit(aon_cfg0, 1, WAKE_CNT_BIT, false);
 		DW1000NgUtils::setBit(aon_cfg0, 1, SLEEP_EN_BIT, sleep_config.enableSLP);
 		_writeBytesToRegister(AON, AON_CFG0_SUB, aon_cfg0, 1); //Deletes 3 bits of the unused LPCLKDIVA
+		_dev->_loadEUIOnWake = sleep_config.onWakeUpLoadEUI;
+
+		_uploadConfigToAON();
 	}
 
 	/*Puts the device into sleep/deepSleep mode. This function also upload sleep config to AON. */
@@ -1469,38 +1841,58 @@ namespace DW1000Ng {
 		_writeValueToRegister(AON, AON_CTRL_SUB, 0x02, LEN_AON_CTRL);
 	}
 
-	void spiWakeup(){
-		byte deviceId[LEN_DEV_ID];
-		byte expectedDeviceId[LEN_DEV_ID];
-		DW1000NgUtils::writeValueToBytes(expectedDeviceId, 0xDECA0130, LEN_DEV_ID);
-		_readBytesFromRegister(DEV_ID, NO_SUB, deviceId, LEN_DEV_ID);
-		if (memcmp(deviceId, expectedDeviceId, LEN_DEV_ID)) {
-			digitalWrite(_ss, LOW);
-			delay(1);
-			digitalWrite(_ss, HIGH);
-			delay(5);
-			setTxAntennaDelay(_antennaTxDelay);
-			if (_debounceClockEnabled){
-					enableDebounceClock();
-			}
+	boolean spiWakeup(){
+		if(_isDeviceIdValid()) {
+			_dev->_bootTiming.wakeup = 0;
+			return true;
 		}
+
+		uint32_t start = micros();
+		digitalWrite(_dev->_ss, LOW);
+		delayMicroseconds(WAKEUP_CS_LOW_TIME);
+		digitalWrite(_dev->_ss, HIGH);
+
+		/* the device answers once its crystal runs, and is ready when the AON restore ends with the clock PLL lock */
+		SPIporting::setSPIspeed(SPIClock::SLOW);
+		boolean ready = _waitForDeviceId(start, WAKEUP_TIMEOUT) && _waitForStatusBit(CPLOCK_BIT, start, WAKEUP_TIMEOUT);
+		_dev->_bootTiming.wakeup = micros() - start;
+		SPIporting::setSPIspeed(_dev->_spiClock);
+		if(!ready)
+			return false;
+
+		/* not kept in AON: TX_ANTD, and LDE_RXANTD overwritten by the LDE microcode load (ONW_LLDE);
+		   the calibration is written from the cache, OTP is not read again */
+		_writeAntennaDelayRegisters();
+		_writeOTPCalibration();
+		if (_dev->_debounceClockEnabled){
+			enableDebounceClock();
+		}
+		/* the EUI register was reloaded from OTP (ONW_LEUI) */
+		if(_dev->_loadEUIOnWake) {
+			memcpy(_dev->_eui, _dev->_otp.eui, LEN_EUI);
+		}
+		return true;
 	}
 
-	void reset() {
-		if(_rst == 0xff) { /* Fallback to Software Reset */
+	boolean reset() {
+		uint32_t start = micros();
+		if(_dev->_rst == 0xff) { /* Fallback to Software Reset */
 			softwareReset();
 		} else {
 			// DW1000Ng data sheet v2.08 §5.6.1 page 20, the RSTn pin should not be driven high but left floating.
-			pinMode(_rst, OUTPUT);
-			digitalWrite(_rst, LOW);
-			delay(2);  // DW1000Ng data sheet v2.08 §5.6.1 page 20: nominal 50ns, to be safe take more time
-			pinMode(_rst, INPUT);
-			delay(5); // dw1000Ng data sheet v1.2 page 5: nominal 3 ms, to be safe take more time
+			pinMode(_dev->_rst, OUTPUT);
+			digitalWrite(_dev->_rst, LOW);
+			delayMicroseconds(10);  // DW1000Ng data sheet v2.08 §5.6.1 page 20: nominal 50ns, to be safe take more time
+			pinMode(_dev->_rst, INPUT);
+			// the clock PLL is not locked after the reset
+			_setSPIspeed(SPIClock::SLOW);
 		}
+		// dw1000Ng data sheet v1.2 page 5: nominal 3 ms until the device is ready
+		return _waitForDeviceId(start, POWER_UP_TIMEOUT);
 	}
 
 	void softwareReset() {
-		SPIporting::setSPIspeed(SPIClock::SLOW);
+		_setSPIspeed(SPIClock::SLOW);
 		
 		/* Disable sequencing and go to state "INIT" - (a) Sets SYSCLKS to 01 */
 		_disableSequencing();
@@ -1512,7 +1904,7 @@ namespace DW1000Ng {
 		_writeValueToRegister(AON, AON_CTRL_SUB, 0x02, LEN_AON_CTRL);
 		/* (b) Clear SOFTRESET to all zero’s */
 		_writeValueToRegister(PMSC, PMSC_SOFTRESET_SUB, 0x00, LEN_PMSC_SOFTRESET);
-		delay(1);
+		delayMicroseconds(10); // the clock PLL needs 10 us to lock after the reset
 		/* (c) Set SOFTRESET to all ones */
 		_writeValueToRegister(PMSC, PMSC_SOFTRESET_SUB, 0xF0, LEN_PMSC_SOFTRESET);
 	}
@@ -1619,27 +2011,25 @@ namespace DW1000Ng {
 	* ######################################################################### */
 
 	void setNetworkId(uint16_t val) {
-		_networkAndAddress[2] = (byte)(val & 0xFF);
-		_networkAndAddress[3] = (byte)((val >> 8) & 0xFF);
+		_dev->_networkAndAddress[2] = (byte)(val & 0xFF);
+		_dev->_networkAndAddress[3] = (byte)((val >> 8) & 0xFF);
 		_writeNetworkIdAndDeviceAddress();
 	}
 
 	void getNetworkId(byte id[]) {
-		_readNetworkIdAndDeviceAddress();
-		id[0] = _networkAndAddress[2];
-		id[1] = _networkAndAddress[3];
+		id[0] = _dev->_networkAndAddress[2];
+		id[1] = _dev->_networkAndAddress[3];
 	}
 
 	void setDeviceAddress(uint16_t val) {
-		_networkAndAddress[0] = (byte)(val & 0xFF);
-		_networkAndAddress[1] = (byte)((val >> 8) & 0xFF);
+		_dev->_networkAndAddress[0] = (byte)(val & 0xFF);
+		_dev->_networkAndAddress[1] = (byte)((val >> 8) & 0xFF);
 		_writeNetworkIdAndDeviceAddress();
 	}
 
 	void getDeviceAddress(byte address[]) {
-		_readNetworkIdAndDeviceAddress();
-		address[0] = _networkAndAddress[0];
-		address[1] = _networkAndAddress[1];
+		address[0] = _dev->_networkAndAddress[0];
+		address[1] = _dev->_networkAndAddress[1];
 	}
 
 	void setEUI(const char eui[]) {
@@ -1650,28 +2040,27 @@ namespace DW1000Ng {
 
 	void setEUI(byte eui[]) {
 		//we reverse the address->
-		byte    reverseEUI[8];
 		uint8_t     size = 8;
 		for(uint8_t i    = 0; i < size; i++) {
-			*(reverseEUI+i) = *(eui+size-i-1);
+			*(_dev->_eui+i) = *(eui+size-i-1);
 		}
-		_writeBytesToRegister(EUI, NO_SUB, reverseEUI, LEN_EUI);
+		_writeBytesToRegister(EUI, NO_SUB, _dev->_eui, LEN_EUI);
 	}
 
 	void getEUI(byte eui[]) {
-		_readBytesFromRegister(EUI, NO_SUB, eui, LEN_EUI);
+		memcpy(eui, _dev->_eui, LEN_EUI);
 	}
 
 	float getTemperature() {
 		_vbatAndTempSteps();
 		byte sar_ltemp = 0; _readBytesFromRegister(TX_CAL, 0x04, &sar_ltemp, 1);
-		return (sar_ltemp - _tmeas23C) * 1.14f + 23.0f;
+		return _temperatureFromSAR(sar_ltemp);
 	}
 
 	float getBatteryVoltage() {
 		_vbatAndTempSteps();
 		byte sar_lvbat = 0; _readBytesFromRegister(TX_CAL, 0x03, &sar_lvbat, 1);
-		return (sar_lvbat - _vmeas3v3) / 173.0f + 3.3f;
+		return _batteryVoltageFromSAR(sar_lvbat);
 	}
 
 	void getTemperatureAndBatteryVoltage(float& temp, float& vbat) {
@@ -1682,36 +2071,90 @@ namespace DW1000Ng {
 		byte sar_ltemp = 0; _readBytesFromRegister(TX_CAL, 0x04, &sar_ltemp, 1);
 		
 		// calculate voltage and temperature
-		vbat = (sar_lvbat - _vmeas3v3) / 173.0f + 3.3f;
-		temp = (sar_ltemp - _tmeas23C) * 1.14f + 23.0f;
+		vbat = _batteryVoltageFromSAR(sar_lvbat);
+		temp = _temperatureFromSAR(sar_ltemp);
+	}
+
+	void enableCompensation(const compensation_configuration_t& config) {
+		_dev->_compensation = true;
+		_dev->_compensationConfig = config;
+		/* the next updateCompensation() samples */
+		_dev->_compensationSample = millis() - config.interval;
+	}
+
+	void disableCompensation() {
+		_dev->_compensation = false;
+		compensation_state_t state = _dev->_compensationState;
+		state.antennaDelay = 0;
+		state.pgDelay = 0;
+		state.txPower = 0;
+		_applyCompensation(state);
+	}
+
+	boolean updateCompensation() {
+		if(!_dev->_compensation || millis() - _dev->_compensationSample < _dev->_compensationConfig.interval)
+			return false;
+		_dev->_compensationSample = millis();
+
+		_vbatAndTempSteps();
+		/* LVBAT and LTEMP are adjacent */
+		byte sar[2];
+		_readBytesFromRegister(TX_CAL, 0x03, sar, 2);
+		compensation_state_t state;
+		state.batteryVoltage = _batteryVoltageFromSAR(sar[0]);
+		state.temperature = _temperatureFromSAR(sar[1]);
+		_compensationOffsets(state);
+		return _applyCompensation(state);
+	}
+
+	void getCompensation(compensation_state_t& state) {
+		state = _dev->_compensationState;
 	}
 
 	void enableFrameFiltering(frame_filtering_configuration_t config) {
-		DW1000NgUtils::setBit(_syscfg, LEN_SYS_CFG, FFEN_BIT, true);
-		DW1000NgUtils::setBit(_syscfg, LEN_SYS_CFG, FFBC_BIT, config.behaveAsCoordinator);
-		DW1000NgUtils::setBit(_syscfg, LEN_SYS_CFG, FFAB_BIT, config.allowBeacon);
-		DW1000NgUtils::setBit(_syscfg, LEN_SYS_CFG, FFAD_BIT, config.allowData);
-		DW1000NgUtils::setBit(_syscfg, LEN_SYS_CFG, FFAA_BIT, config.allowAcknowledgement);
-		DW1000NgUtils::setBit(_syscfg, LEN_SYS_CFG, FFAM_BIT, config.allowMacCommand);
-		DW1000NgUtils::setBit(_syscfg, LEN_SYS_CFG, FFAR_BIT, config.allowAllReserved);
-		DW1000NgUtils::setBit(_syscfg, LEN_SYS_CFG, FFA4_BIT, config.allowReservedFour);
-		DW1000NgUtils::setBit(_syscfg, LEN_SYS_CFG, FFA5_BIT, config.allowReservedFive);
+		DW1000NgUtils::setBit(_dev->_syscfg, LEN_SYS_CFG, FFEN_BIT, true);
+		DW1000NgUtils::setBit(_dev->_syscfg, LEN_SYS_CFG, FFBC_BIT, config.behaveAsCoordinator);
+		DW1000NgUtils::setBit(_dev->_syscfg, LEN_SYS_CFG, FFAB_BIT, config.allowBeacon);
+		DW1000NgUtils::setBit(_dev->_syscfg, LEN_SYS_CFG, FFAD_BIT, config.allowData);
+		DW1000NgUtils::setBit(_dev->_syscfg, LEN_SYS_CFG, FFAA_BIT, config.allowAcknowledgement);
+		DW1000NgUtils::setBit(_dev->_syscfg, LEN_SYS_CFG, FFAM_BIT, config.allowMacCommand);
+		DW1000NgUtils::setBit(_dev->_syscfg, LEN_SYS_CFG, FFAR_BIT, config.allowAllReserved);
+		DW1000NgUtils::setBit(_dev->_syscfg, LEN_SYS_CFG, FFA4_BIT, config.allowReservedFour);
+		DW1000NgUtils::setBit(_dev->_syscfg, LEN_SYS_CFG, FFA5_BIT, config.allowReservedFive);
 
 		_writeSystemConfigurationRegister();
 	}
 
 	void disableFrameFiltering() {
-		DW1000NgUtils::setBit(_syscfg, LEN_SYS_CFG, FFEN_BIT, false);
+		DW1000NgUtils::setBit(_dev->_syscfg, LEN_SYS_CFG, FFEN_BIT, false);
+		_writeSystemConfigurationRegister();
+	}
+
+	void enableAutoAcknowledge() {
+		_dev->_autoAcknowledge = true;
+		_writeAcknowledgeTurnaround();
+		DW1000NgUtils::setBit(_dev->_syscfg, LEN_SYS_CFG, AUTOACK_BIT, true);
+		_writeSystemConfigurationRegister();
+	}
+
+	void disableAutoAcknowledge() {
+		_dev->_autoAcknowledge = false;
+		DW1000NgUtils::setBit(_dev->_syscfg, LEN_SYS_CFG, AUTOACK_BIT, false);
+		_writeSystemConfigurationRegister();
+	}
+
+	void setAutoAcknowledgeFramePending(boolean val) {
+		DW1000NgUtils::setBit(_dev->_syscfg, LEN_SYS_CFG, AACKPEND_BIT, val);
 		_writeSystemConfigurationRegister();
 	}
 
 	void setDoubleBuffering(boolean val) {
-		DW1000NgUtils::setBit(_syscfg, LEN_SYS_CFG, DIS_DRXB_BIT, !val);
+		DW1000NgUtils::setBit(_dev->_syscfg, LEN_SYS_CFG, DIS_DRXB_BIT, !val);
 	}
 
 	void setAntennaDelay(uint16_t value) {
-		_antennaTxDelay = value;
-		_antennaRxDelay = value;
+		_dev->_antennaTxDelay = value;
+		_dev->_antennaRxDelay = value;
 		_writeAntennaDelayRegisters();
 	}
 
@@ -1736,51 +2179,65 @@ namespace DW1000Ng {
 	#endif
 
 	void setTxAntennaDelay(uint16_t value) {
-		_antennaTxDelay = value;
+		_dev->_antennaTxDelay = value;
 		_writeAntennaDelayRegisters();	
 	}
 	void setRxAntennaDelay(uint16_t value) {
-		_antennaRxDelay = value;
+		_dev->_antennaRxDelay = value;
 		_writeAntennaDelayRegisters();
 	}
 
 	uint16_t getTxAntennaDelay() {
-		return _antennaTxDelay;
+		return _dev->_antennaTxDelay;
 	}
 	uint16_t getRxAntennaDelay() {
-		return _antennaRxDelay;
+		return _dev->_antennaRxDelay;
 	}
 
 	void forceTRxOff() {
-		memset(_sysctrl, 0, LEN_SYS_CTRL);
-		DW1000NgUtils::setBit(_sysctrl, LEN_SYS_CTRL, TRXOFF_BIT, true);
-		_writeBytesToRegister(SYS_CTRL, NO_SUB, _sysctrl, LEN_SYS_CTRL);
+		memset(_dev->_sysctrl, 0, LEN_SYS_CTRL);
+		DW1000NgUtils::setBit(_dev->_sysctrl, LEN_SYS_CTRL, TRXOFF_BIT, true);
+		_writeBytesToRegister(SYS_CTRL, NO_SUB, _dev->_sysctrl, LEN_SYS_CTRL);
 	}
 
 	void startReceive(ReceiveMode mode) {
-		memset(_sysctrl, 0, LEN_SYS_CTRL);
-		DW1000NgUtils::setBit(_sysctrl, LEN_SYS_CTRL, SFCST_BIT, !_frameCheck);
+		memset(_dev->_sysctrl, 0, LEN_SYS_CTRL);
+		DW1000NgUtils::setBit(_dev->_sysctrl, LEN_SYS_CTRL, SFCST_BIT, !_dev->_frameCheck);
 		if(mode == ReceiveMode::DELAYED)
-			DW1000NgUtils::setBit(_sysctrl, LEN_SYS_CTRL, RXDLYS_BIT, true);
-		DW1000NgUtils::setBit(_sysctrl, LEN_SYS_CTRL, RXENAB_BIT, true);
-		_writeBytesToRegister(SYS_CTRL, NO_SUB, _sysctrl, LEN_SYS_CTRL);
+			DW1000NgUtils::setBit(_dev->_sysctrl, LEN_SYS_CTRL, RXDLYS_BIT, true);
+		DW1000NgUtils::setBit(_dev->_sysctrl, LEN_SYS_CTRL, RXENAB_BIT, true);
+		_writeBytesToRegister(SYS_CTRL, NO_SUB, _dev->_sysctrl, LEN_SYS_CTRL);
 	}
 
-	void startTransmit(TransmitMode mode) {
-		memset(_sysctrl, 0, LEN_SYS_CTRL);
-		DW1000NgUtils::setBit(_sysctrl, LEN_SYS_CTRL, SFCST_BIT, !_frameCheck);
+	boolean startTransmit(TransmitMode mode) {
+		memset(_dev->_sysctrl, 0, LEN_SYS_CTRL);
+		DW1000NgUtils::setBit(_dev->_sysctrl, LEN_SYS_CTRL, SFCST_BIT, !_dev->_frameCheck);
 		if(mode == TransmitMode::DELAYED)
-			DW1000NgUtils::setBit(_sysctrl, LEN_SYS_CTRL, TXDLYS_BIT, true);
-		if(_wait4resp)
-			DW1000NgUtils::setBit(_sysctrl, LEN_SYS_CTRL, WAIT4RESP_BIT, true);
+			DW1000NgUtils::setBit(_dev->_sysctrl, LEN_SYS_CTRL, TXDLYS_BIT, true);
+		if(_dev->_wait4resp)
+			DW1000NgUtils::setBit(_dev->_sysctrl, LEN_SYS_CTRL, WAIT4RESP_BIT, true);
 
-		DW1000NgUtils::setBit(_sysctrl, LEN_SYS_CTRL, TXSTRT_BIT, true);
-		_writeBytesToRegister(SYS_CTRL, NO_SUB, _sysctrl, LEN_SYS_CTRL);
+		DW1000NgUtils::setBit(_dev->_sysctrl, LEN_SYS_CTRL, TXSTRT_BIT, true);
+		_writeBytesToRegister(SYS_CTRL, NO_SUB, _dev->_sysctrl, LEN_SYS_CTRL);
+		DW1000NG_PROBE(ProbePoint::START_TRANSMIT);
+
+		if(mode == TransmitMode::DELAYED && _isDelayedTransmitError()) {
+			/* Target time already passed: the device would wait for the counter to wrap (~17 s) (HPDWARN),
+			   or it falls in the TX power-up and the frame would leave with a shortened preamble (TXPUTE) */
+			forceTRxOff();
+			_clearDelayedTransmitError();
+			return false;
+		}
+		return true;
 	}
 
 	void setInterruptPolarity(boolean val) {
-		DW1000NgUtils::setBit(_syscfg, LEN_SYS_CFG, HIRQ_POL_BIT, val);
+		DW1000NgUtils::setBit(_dev->_syscfg, LEN_SYS_CFG, HIRQ_POL_BIT, val);
 		_writeSystemConfigurationRegister();
+		_dev->_interruptActiveHigh = val;
+		if(_dev->_irq != 0xff) {
+			attachInterrupt(digitalPinToInterrupt(_dev->_irq), _dispatchInterrupt, val ? RISING : FALLING);
+		}
 	}
 
 	void applyConfiguration(device_configuration_t config) {
@@ -1801,21 +2258,88 @@ namespace DW1000Ng {
 		if(!_checkPreambleCodeValidity())
 			_setValidPreambleCode();
 
-		if(!_standardSFD)
+		if(!_dev->_standardSFD)
 			_setNonStandardSFDLength();
 
 		// writes configuration to registers
 		_writeConfiguration();
 		// tune according to configuration
 		_tune();
+
+		if(_dev->_autoReceiveTimeouts)
+			_writeAutoReceiveTimeouts();
+		if(_dev->_autoAcknowledge)
+			_writeAcknowledgeTurnaround();
+	}
+
+	void getConfiguration(device_configuration_t& config) {
+		config = _currentConfiguration();
+		config.receiverAutoReenable = DW1000NgUtils::getBit(_dev->_syscfg, LEN_SYS_CFG, RXAUTR_BIT);
 	}
 
 	Channel getChannel() {
-		return _channel;
+		return _dev->_channel;
 	}
 
 	PulseFrequency getPulseFrequency() {
-		return _pulseFrequency;
+		return _dev->_pulseFrequency;
+	}
+
+	PreambleLength getPreambleLength() {
+		return _dev->_preambleLength;
+	}
+
+	boolean getChannelTuning(Channel channel, PreambleCode preambleCode, channel_tuning_t& tuning) {
+		if(!_isPreambleCodeValid(channel, preambleCode))
+			return false;
+		_channelTuning(channel, preambleCode, tuning);
+		return true;
+	}
+
+	void applyChannelTuning(const channel_tuning_t& tuning) {
+		channel_tuning_t current;
+		_channelTuning(_dev->_channel, _dev->_preambleCode, current);
+
+		forceTRxOff();
+
+		if(tuning.chanCtrl != current.chanCtrl) {
+			DW1000NgUtils::writeValueToBytes(_dev->_chanctrl, tuning.chanCtrl, LEN_CHAN_CTRL);
+			_writeChannelControlRegister();
+		}
+		_dev->_channel = tuning.channel;
+		_dev->_preambleCode = tuning.preambleCode;
+
+		if(tuning.ldeRepc != current.ldeRepc) {
+			byte lderepc[LEN_LDE_REPC];
+			DW1000NgUtils::writeValueToBytes(lderepc, tuning.ldeRepc, LEN_LDE_REPC);
+			_writeBytesToRegister(LDE_IF, LDE_REPC_SUB, lderepc, LEN_LDE_REPC);
+		}
+		if(_dev->_autoTXPower && tuning.txPower != current.txPower) {
+			_dev->_txPower = tuning.txPower;
+			_writeTXPowerRegister();
+		}
+		if(tuning.rfRxCtrlH != current.rfRxCtrlH) {
+			byte rfrxctrlh = tuning.rfRxCtrlH;
+			_writeBytesToRegister(RF_CONF, RF_RXCTRLH_SUB, &rfrxctrlh, LEN_RF_RXCTRLH);
+		}
+		if(tuning.rfTxCtrl != current.rfTxCtrl) {
+			byte rftxctrl[LEN_RF_TXCTRL];
+			DW1000NgUtils::writeValueToBytes(rftxctrl, tuning.rfTxCtrl, LEN_RF_TXCTRL);
+			_writeBytesToRegister(RF_CONF, RF_TXCTRL_SUB, rftxctrl, LEN_RF_TXCTRL);
+		}
+		if(_dev->_autoTCPGDelay && tuning.tcPgDelay != current.tcPgDelay) {
+			_dev->_tcPgDelay = tuning.tcPgDelay;
+			_writeTCPGDelayRegister();
+		}
+		if(tuning.fsPllTune != current.fsPllTune) {
+			byte fsplltune = tuning.fsPllTune;
+			_writeBytesToRegister(FS_CTRL, FS_PLLTUNE_SUB, &fsplltune, LEN_FS_PLLTUNE);
+		}
+		if(tuning.fsPllCfg != current.fsPllCfg) {
+			byte fspllcfg[LEN_FS_PLLCFG];
+			DW1000NgUtils::writeValueToBytes(fspllcfg, tuning.fsPllCfg, LEN_FS_PLLCFG);
+			_writeBytesToRegister(FS_CTRL, FS_PLLCFG_SUB, fspllcfg, LEN_FS_PLLCFG);
+		}
 	}
 
 	void setPreambleDetectionTimeout(uint16_t pacSize) {
@@ -1831,20 +2355,36 @@ namespace DW1000Ng {
 	}
 
 	void setReceiveFrameWaitTimeoutPeriod(uint16_t timeMicroSeconds) {
+		_dev->_frameWaitTimeout = timeMicroSeconds;
 		if (timeMicroSeconds > 0) {
 			byte rx_wfto[LEN_RX_WFTO];
 			DW1000NgUtils::writeValueToBytes(rx_wfto, timeMicroSeconds, LEN_RX_WFTO);
 			_writeBytesToRegister(RX_WFTO, NO_SUB, rx_wfto, LEN_RX_WFTO);
 			/* enable frame wait timeout bit */
-			DW1000NgUtils::setBit(_syscfg, LEN_SYS_CFG, RXWTOE_BIT, true);
+			DW1000NgUtils::setBit(_dev->_syscfg, LEN_SYS_CFG, RXWTOE_BIT, true);
 			_writeSystemConfigurationRegister();
 		} else {
 			/* disable frame wait timeout bit */
-			DW1000NgUtils::setBit(_syscfg, LEN_SYS_CFG, RXWTOE_BIT, false);
+			DW1000NgUtils::setBit(_dev->_syscfg, LEN_SYS_CFG, RXWTOE_BIT, false);
 			_writeSystemConfigurationRegister();
 		}
 	}
 
+	uint16_t getReceiveFrameWaitTimeoutPeriod() {
+		return _dev->_frameWaitTimeout;
+	}
+
+	void enableAutoReceiveTimeouts(uint16_t expectedDataLength, uint16_t responseWait) {
+		_dev->_autoReceiveTimeouts = true;
+		_dev->_expectedDataLength = expectedDataLength;
+		_dev->_responseWait = responseWait;
+		_writeAutoReceiveTimeouts();
+	}
+
+	void disableAutoReceiveTimeouts() {
+		_dev->_autoReceiveTimeouts = false;
+	}
+
 	void applyInterruptConfiguration(interrupt_configuration_t interrupt_config) {
 		forceTRxOff();
 
@@ -1859,11 +2399,12 @@ namespace DW1000Ng {
 	}
 
 	void setWait4Response(uint32_t timeMicroSeconds) {
-		_wait4resp = timeMicroSeconds == 0 ? false : true;
+		_dev->_wait4resp = timeMicroSeconds == 0 ? false : true;
 
 		/* Check if it overflows 20 bits */
 		if(timeMicroSeconds > 1048575)
 			timeMicroSeconds = 1048575;
+		_dev->_wait4respTime = timeMicroSeconds;
 
 		byte W4R_TIME[LEN_ACK_RESP_T_W4R_TIME_SUB];
 		DW1000NgUtils::writeValueToBytes(W4R_TIME, timeMicroSeconds, LEN_ACK_RESP_T_W4R_TIME_SUB);
@@ -1871,10 +2412,20 @@ namespace DW1000Ng {
 		_writeBytesToRegister(ACK_RESP_T, ACK_RESP_T_W4R_TIME_SUB, W4R_TIME, LEN_ACK_RESP_T_W4R_TIME_SUB);
 	}
 
+	void setWait4Acknowledge(boolean val) {
+		if(val) {
+			_dev->_wait4resp = true;
+			_writeValueToRegister(ACK_RESP_T, ACK_RESP_T_W4R_TIME_SUB, 0, LEN_ACK_RESP_T_W4R_TIME_SUB);
+		} else {
+			setWait4Response(_dev->_wait4respTime);
+		}
+	}
+
 	void setTXPower(byte power[]) {
 		//TODO Check byte length
-		_writeBytesToRegister(TX_POWER, NO_SUB, power, LEN_TX_POWER);
-		_autoTXPower = false;
+		_dev->_txPower = DW1000NgUtils::bytesAsValue(power, LEN_TX_POWER);
+		_writeTXPowerRegister();
+		_dev->_autoTXPower = false;
 	}
 
 	void setTXPower(int32_t power) {
@@ -1898,26 +2449,25 @@ namespace DW1000Ng {
 	}
 
 	void setTXPowerAuto() {
-		_autoTXPower = true;
+		_dev->_autoTXPower = true;
 		_txpowertune();
 	}
 
 	void setTCPGDelay(byte tcpgdelay) {
-		byte tcpgBytes[LEN_TC_PGDELAY];
-		DW1000NgUtils::writeValueToBytes(tcpgBytes, tcpgdelay, LEN_TC_PGDELAY);
-		_writeBytesToRegister(TX_CAL, TC_PGDELAY_SUB, tcpgBytes, LEN_TC_PGDELAY);
-		_autoTCPGDelay = false;
+		_dev->_tcPgDelay = tcpgdelay;
+		_writeTCPGDelayRegister();
+		_dev->_autoTCPGDelay = false;
 	}
 
 	void setTCPGDelayAuto() {
 		_tcpgdelaytune();
-		_autoTCPGDelay = true;
+		_dev->_autoTCPGDelay = true;
 	}
 
 	void enableTransmitPowerSpectrumTestMode(int32_t repeat_interval) {
 		/* DW1000 clocks must be set to crystal speed so SPI rate have to be lowered and will
       	not be increased again */
-		SPIporting::setSPIspeed(SPIClock::SLOW);
+		_setSPIspeed(SPIClock::SLOW);
 
         _disableSequencing();
         _configureRFTransmitPowerSpectrumTestMode();
@@ -1943,24 +2493,33 @@ namespace DW1000Ng {
 		_writeBytesToRegister(DX_TIME, NO_SUB, futureTimeBytes, LEN_DX_TIME);
 	}
 
+	uint64_t setDelayedTransmitTime(uint64_t targetTime) {
+		DW1000NgTime::Timestamp deviceTime = DW1000NgTime::delayedTRXTime(DW1000NgTime::Timestamp(targetTime));
+		byte futureTimeBytes[LEN_DX_TIME];
+		DW1000NgUtils::writeValueToBytes(futureTimeBytes, deviceTime.ticks(), LEN_DX_TIME);
+		setDelayedTRX(futureTimeBytes);
+		return (deviceTime + _compensatedAntennaDelay(_dev->_antennaTxDelay)).ticks();
+	}
+
 	void setTransmitData(byte data[], uint16_t n) {
-		if(_frameCheck) {
+		if(_dev->_frameCheck) {
 			n += 2; // two bytes CRC-16
 		}
 		if(n > LEN_EXT_UWB_FRAMES) {
 			return; // TODO proper error handling: frame/buffer size
 		}
-		if(n > LEN_UWB_FRAMES && !_extendedFrameLength) {
+		if(n > LEN_UWB_FRAMES && !_dev->_extendedFrameLength) {
 			return; // TODO proper error handling: frame/buffer size
 		}
 		// transmit data and length
 		_writeBytesToRegister(TX_BUFFER, NO_SUB, data, n);
 		
 		/* Sets up transmit frame control length based on data length */
-		_txfctrl[0] = (byte)(n & 0xFF); // 1 byte (regular length + 1 bit)
-		_txfctrl[1] &= 0xE0;
-		_txfctrl[1] |= (byte)((n >> 8) & 0x03);  // 2 added bits if extended length
+		_dev->_txfctrl[0] = (byte)(n & 0xFF); // 1 byte (regular length + 1 bit)
+		_dev->_txfctrl[1] &= 0xE0;
+		_dev->_txfctrl[1] |= (byte)((n >> 8) & 0x03);  // 2 added bits if extended length
 		_writeTransmitFrameControlRegister();
+		DW1000NG_PROBE(ProbePoint::TX_BUFFER_WRITE);
 	}
 
 	void setTransmitData(const String& data) {
@@ -1980,7 +2539,7 @@ namespace DW1000Ng {
 		_readBytesFromRegister(RX_FINFO, NO_SUB, rxFrameInfo, LEN_RX_FINFO);
 		len = ((((uint16_t)rxFrameInfo[1] << 8) | (uint16_t)rxFrameInfo[0]) & 0x03FF);
 		
-		if(_frameCheck && len > 2) {
+		if(_dev->_frameCheck && len > 2) {
 			return len-2;
 		}
 		return len;
@@ -1991,6 +2550,7 @@ namespace DW1000Ng {
 			return;
 		}
 		_readBytesFromRegister(RX_BUFFER, NO_SUB, data, n);
+		DW1000NG_PROBE(ProbePoint::FRAME_READ);
 	}
 
 	void getReceivedData(String& data) {
@@ -2022,6 +2582,7 @@ namespace DW1000Ng {
 		byte data[LEN_RX_STAMP];
 		memset(data, 0, LEN_RX_STAMP);
 		_readBytesFromRegister(RX_TIME, RX_STAMP_SUB, data, LEN_RX_STAMP);
+		DW1000NG_PROBE(ProbePoint::TIMESTAMP_READ);
 		return DW1000NgUtils::bytesAsValue(data, LEN_RX_STAMP);
 	}
 
@@ -2043,66 +2604,126 @@ namespace DW1000Ng {
 		return (float)f2/noise;
 	}
 
+	uint16_t getPreambleAccumulationCount() {
+		byte rxFrameInfo[LEN_RX_FINFO];
+		_readBytesFromRegister(RX_FINFO, NO_SUB, rxFrameInfo, LEN_RX_FINFO);
+		return (((uint16_t)rxFrameInfo[2] >> 4) & 0xFF) | ((uint16_t)rxFrameInfo[3] << 4);
+	}
+
+	void enableEventCounters() {
+		byte evcCtrl[LEN_EVC_CTRL];
+		memset(evcCtrl, 0, LEN_EVC_CTRL);
+		DW1000NgUtils::setBit(evcCtrl, LEN_EVC_CTRL, EVC_CLR_BIT, true);
+		_writeBytesToRegister(DIG_DIAG, EVC_CTRL_SUB, evcCtrl, LEN_EVC_CTRL);
+		memset(evcCtrl, 0, LEN_EVC_CTRL);
+		DW1000NgUtils::setBit(evcCtrl, LEN_EVC_CTRL, EVC_EN_BIT, true);
+		_writeBytesToRegister(DIG_DIAG, EVC_CTRL_SUB, evcCtrl, LEN_EVC_CTRL);
+		memset(_dev->_eventCounters, 0, sizeof(_dev->_eventCounters));
+	}
+
+	void disableEventCounters() {
+		byte evcCtrl[LEN_EVC_CTRL];
+		memset(evcCtrl, 0, LEN_EVC_CTRL);
+		_writeBytesToRegister(DIG_DIAG, EVC_CTRL_SUB, evcCtrl, LEN_EVC_CTRL);
+	}
+
+	void getEventCounters(event_counters_t& counters) {
+		byte evc[LEN_EVC_COUNTERS];
+		uint16_t delta[LEN_EVC_COUNTERS / 2];
+		_readBytesFromRegister(DIG_DIAG, EVC_PHE_SUB, evc, LEN_EVC_COUNTERS);
+		for(uint8_t i = 0; i < LEN_EVC_COUNTERS / 2; i++) {
+			uint16_t value = ((uint16_t)evc[2*i] | ((uint16_t)evc[2*i+1] << 8)) & EVC_COUNTER_MASK;
+			delta[i] = (value - _dev->_eventCounters[i]) & EVC_COUNTER_MASK;
+			_dev->_eventCounters[i] = value;
+		}
+		counters.phrErrors = delta[0];
+		counters.rsdErrors = delta[1];
+		counters.fcsGood = delta[2];
+		counters.fcsErrors = delta[3];
+		counters.frameFilterRejections = delta[4];
+		counters.rxOverruns = delta[5];
+		counters.sfdTimeouts = delta[6];
+		counters.preambleTimeouts = delta[7];
+		counters.frameWaitTimeouts = delta[8];
+		counters.txFramesSent = delta[9];
+		counters.halfPeriodWarnings = delta[10];
+		counters.txPowerUpWarnings = delta[11];
+	}
+
+	uint16_t getFirstPathIndex() {
+		byte fpIndex[LEN_FP_INDEX];
+		_readBytesFromRegister(RX_TIME, FP_INDEX_SUB, fpIndex, LEN_FP_INDEX);
+		return DW1000NgUtils::bytesAsValue(fpIndex, LEN_FP_INDEX);
+	}
+
+	uint16_t readCIR(cir_sample_t samples[], uint16_t first, uint16_t count) {
+		uint16_t length = _dev->_pulseFrequency == PulseFrequency::FREQ_16MHZ ? ACC_SAMPLES_16MHZ : ACC_SAMPLES_64MHZ;
+		if(first >= length)
+			return 0;
+		if(count > length - first)
+			count = length - first;
+
+		/* every read of the accumulator starts with a dummy byte */
+		byte chunk[1 + DW1000NG_CIR_CHUNK * LEN_ACC_SAMPLE];
+		_enableAccumulatorClock(true);
+		for(uint16_t done = 0; done < count;) {
+			uint16_t n = count - done < DW1000NG_CIR_CHUNK ? count - done : DW1000NG_CIR_CHUNK;
+			_readBytesFromRegister(ACC_MEM, (first + done) * LEN_ACC_SAMPLE, chunk, 1 + n * LEN_ACC_SAMPLE);
+			for(uint16_t i = 0; i < n; i++) {
+				const byte* sample = &chunk[1 + i * LEN_ACC_SAMPLE];
+				samples[done + i].real = static_cast<int16_t>(sample[0] | (sample[1] << 8));
+				samples[done + i].imaginary = static_cast<int16_t>(sample[2] | (sample[3] << 8));
+			}
+			done += n;
+		}
+		_enableAccumulatorClock(false);
+		return count;
+	}
+
+	uint16_t readCIRAroundFirstPath(cir_sample_t samples[], uint16_t before, uint16_t count) {
+		uint16_t firstPath = getFirstPathIndex() >> 6;
+		return readCIR(samples, firstPath > before ? firstPath - before : 0, count);
+	}
+
 	float getFirstPathPower() {
+		return getFirstPathPowerQ16() / 65536.0f;
+	}
+
+	float getReceivePower() {
+		return getReceivePowerQ16() / 65536.0f;
+	}
+
+	int32_t getFirstPathPowerQ16() {
 		byte         fpAmpl1Bytes[LEN_FP_AMPL1];
 		byte         fpAmpl2Bytes[LEN_FP_AMPL2];
 		byte         fpAmpl3Bytes[LEN_FP_AMPL3];
 		byte         rxFrameInfo[LEN_RX_FINFO];
-		uint16_t     f1, f2, f3, N;
-		float        A, corrFac;
+		uint32_t     f1, f2, f3;
+		uint16_t     N;
 		_readBytesFromRegister(RX_TIME, FP_AMPL1_SUB, fpAmpl1Bytes, LEN_FP_AMPL1);
 		_readBytesFromRegister(RX_FQUAL, FP_AMPL2_SUB, fpAmpl2Bytes, LEN_FP_AMPL2);
 		_readBytesFromRegister(RX_FQUAL, FP_AMPL3_SUB, fpAmpl3Bytes, LEN_FP_AMPL3);
 		_readBytesFromRegister(RX_FINFO, NO_SUB, rxFrameInfo, LEN_RX_FINFO);
-		f1 = (uint16_t)fpAmpl1Bytes[0] | ((uint16_t)fpAmpl1Bytes[1] << 8);
-		f2 = (uint16_t)fpAmpl2Bytes[0] | ((uint16_t)fpAmpl2Bytes[1] << 8);
-		f3 = (uint16_t)fpAmpl3Bytes[0] | ((uint16_t)fpAmpl3Bytes[1] << 8);
+		f1 = (uint32_t)fpAmpl1Bytes[0] | ((uint32_t)fpAmpl1Bytes[1] << 8);
+		f2 = (uint32_t)fpAmpl2Bytes[0] | ((uint32_t)fpAmpl2Bytes[1] << 8);
+		f3 = (uint32_t)fpAmpl3Bytes[0] | ((uint32_t)fpAmpl3Bytes[1] << 8);
 		N  = (((uint16_t)rxFrameInfo[2] >> 4) & 0xFF) | ((uint16_t)rxFrameInfo[3] << 4);
 
-		if(_pulseFrequency == PulseFrequency::FREQ_16MHZ) {
-			A       = 113.77;
-			corrFac = 2.3334;
-		} else {
-			A       = 121.74;
-			corrFac = 1.1667;
-		}
-		float estFpPwr = 10.0*log10(((float)f1*(float)f1+(float)f2*(float)f2+(float)f3*(float)f3)/((float)N*(float)N))-A;
-		if(estFpPwr <= -88) {
-			return estFpPwr;
-		} else {
-			// approximation of Fig. 22 in user manual for dbm correction
-			estFpPwr += (estFpPwr+88)*corrFac;
-		}
-		return estFpPwr;
+		uint64_t fpPower = (uint64_t)f1*f1 + (uint64_t)f2*f2 + (uint64_t)f3*f3;
+		return _correctPowerQ16(DW1000NgUtils::log2Q16(fpPower) - 2*DW1000NgUtils::log2Q16(N));
 	}
 
-	float getReceivePower() {
+	int32_t getReceivePowerQ16() {
 		byte     cirPwrBytes[LEN_CIR_PWR];
 		byte     rxFrameInfo[LEN_RX_FINFO];
-		uint32_t twoPower17 = 131072;
 		uint16_t C, N;
-		float    A, corrFac;
 		_readBytesFromRegister(RX_FQUAL, CIR_PWR_SUB, cirPwrBytes, LEN_CIR_PWR);
 		_readBytesFromRegister(RX_FINFO, NO_SUB, rxFrameInfo, LEN_RX_FINFO);
 		C = (uint16_t)cirPwrBytes[0] | ((uint16_t)cirPwrBytes[1] << 8);
 		N = (((uint16_t)rxFrameInfo[2] >> 4) & 0xFF) | ((uint16_t)rxFrameInfo[3] << 4);
 
-		if(_pulseFrequency == PulseFrequency::FREQ_16MHZ) {
-			A       = 113.77;
-			corrFac = 2.3334;
-		} else {
-			A       = 121.74;
-			corrFac = 1.1667;
-		}
-		
-		float estRxPwr = 10.0*log10(((float)C*(float)twoPower17)/((float)N*(float)N))-A;
-		if(estRxPwr <= -88) {
-			return estRxPwr;
-		} else {
-			// approximation of Fig. 22 in user manual for dbm correction
-			estRxPwr += (estRxPwr+88)*corrFac;
-		}
-		return estRxPwr;
+		/* log2(C * 2^17) = log2(C) + 17 */
+		return _correctPowerQ16(DW1000NgUtils::log2Q16(C) + (static_cast<int32_t>(17) << 16) - 2*DW1000NgUtils::log2Q16(N));
 	}
 
 	#if DW1000NG_DEBUG
@@ -51,6 +51,7 @@
 #include "DW1000NgConstants.hpp"
 #include "DW1000NgConfiguration.hpp"
 #include "DW1000NgCompileOptions.hpp"
+#include "DW1000NgDevice.hpp"
 
 namespace DW1000Ng {
 	/** 
@@ -60,8 +61,10 @@ namespace DW1000Ng {
 	@param[in] ss  The SPI Selection pin used to identify the specific connection
 	@param[in] irq The interrupt line/pin that connects the Arduino.
 	@param[in] rst The reset line/pin for hard resets of ICs that connect to the Arduino. Value 0xff means soft reset.
+
+	returns false if the device did not answer on SPI or its clock PLL did not lock in time, it is then left unconfigured
 	*/
-	void initialize(uint8_t ss, uint8_t irq, uint8_t rst = 0xff, SPIClass&spi = SPI);
+	boolean initialize(uint8_t ss, uint8_t irq, uint8_t rst = 0xff, SPIClass&spi = SPI);
 
 	/** 
 	Initiates and starts a sessions with a DW1000 without interrupt. If rst is not set or value 0xff, a soft resets (i.e. command
@@ -69,8 +72,59 @@ namespace DW1000Ng {
 	
 	@param[in] ss  The SPI Selection pin used to identify the specific connection
 	@param[in] rst The reset line/pin for hard resets of ICs that connect to the Arduino. Value 0xff means soft reset.
+
+	returns false if the device did not get ready, see initialize(uint8_t, uint8_t, uint8_t, SPIClass&)
+	*/
+	boolean initializeNoInterrupt(uint8_t ss, uint8_t rst = 0xff);
+
+	/** 
+	Selects device and initiates a session with it, see initialize(uint8_t, uint8_t, uint8_t, SPIClass&).
+	Every DW1000 wired to the MCU needs its own DW1000NgDevice; devices may share an SPI bus
+	and must have distinct ss (and irq) pins.
+
+	@param[in] device The state holder of the DW1000, selected on return
+	@param[in] ss  The SPI Selection pin used to identify the specific connection
+	@param[in] irq The interrupt line/pin that connects the Arduino.
+	@param[in] rst The reset line/pin for hard resets of ICs that connect to the Arduino. Value 0xff means soft reset.
+	@param[in] spi The SPI bus the DW1000 is wired to
+
+	returns false if the device did not get ready, see initialize(uint8_t, uint8_t, uint8_t, SPIClass&)
+	*/
+	boolean initialize(DW1000NgDevice& device, uint8_t ss, uint8_t irq, uint8_t rst = 0xff, SPIClass&spi = SPI);
+
+	/**
+	Gets the factory calibration read from OTP by initialize(). It is read once and cached,
+	spiWakeup() restores it without accessing OTP again.
+
+	@param [out] calibration the calibration values, zero where not programmed
+	*/
+	void getOTPCalibration(otp_calibration_t& calibration);
+
+	/**
+	Gets how long the steps of the last initialize() and the last spiWakeup() took. The waits for the device are polled, so this
+	shows where the start-up time goes on a given board. Steps not reached after a failed initialize() are 0.
+
+	@param [out] timing the duration of each step, in μs
+	*/
+	void getBootTiming(boot_timing_t& timing);
+
+	/**
+	Selects the DW1000 every other function of the driver acts on.
+	Interrupts of all initialized devices are handled regardless of the selection.
+
+	@param [in] device the DW1000 to address
 	*/
-	void initializeNoInterrupt(uint8_t ss, uint8_t rst = 0xff);
+	void select(DW1000NgDevice& device);
+
+	/**
+	returns the DW1000 currently addressed by the driver
+	*/
+	DW1000NgDevice& getSelectedDevice();
+
+	/**
+	returns the device used when select() is never called
+	*/
+	DW1000NgDevice& getDefaultDevice();
 	
 	/** 
 	Enable debounce Clock, used to clock the LED blinking
@@ -88,8 +142,9 @@ namespace DW1000Ng {
 	void setGPIOMode(uint8_t msgp, uint8_t mode);
 
 	/**
-	Applies the common sleep configuration and on-wake mode to the DW1000 for both DEEP_SLEEP and SLEEP modes.
-	ONW_LLDO_BIT and ONW_LLDE_BIT are 1 to default.
+	Applies the common sleep configuration and on-wake mode to the DW1000 for both DEEP_SLEEP and SLEEP modes
+	and uploads it to the AON block.
+	ONW_LDC_BIT, ONW_LLDO_BIT and ONW_LLDE_BIT are 1 to default, so the configuration is restored on wake-up.
 
 	@param [in] config struct	The sleep/deepsleep configuration to apply to the DW1000
 	*/
@@ -98,20 +153,28 @@ namespace DW1000Ng {
 	/**
 	Enter in DeepSleep. applySleepConfiguration must be called first.
 	Either spi wakeup or pin wakeup must be enabled.
-	-- In case of future implementation of Sleep mode, you must reset proper antenna delay with setTxAntennaDelay() after wakeUp event. --
 	*/
 	void deepSleep();
 
 	/**
-	Wake-up from deep sleep by toggle chip select pin
+	Wake-up from deep sleep by toggle chip select pin.
+	Instead of fixed delays the device is polled until the clock PLL locks (at most 5 ms), then the registers
+	AON does not keep (antenna delays, debounce clock) are restored.
+
+	The wake-up to ready latency is reported by getBootTiming(), 0 if the device was already awake.
+
+	returns false if the device did not get ready within the timeout, the registers are then not restored
 	*/
-	void spiWakeup();
+	boolean spiWakeup();
 	
 	/**
 	Resets all connected or the currently selected DW1000 chip.
 	Uses hardware reset or in case the reset pin is not wired it falls back to software Reset. 
+	Waits until the device answers on SPI again (at most 5 ms), its configuration is then the power-on one.
+
+	returns false if the device did not answer within the timeout
 	*/
-	void reset();
+	boolean reset();
 	
 	/** 
 	Resets the currently selected DW1000 chip programmatically (via corresponding commands).
@@ -128,7 +191,7 @@ namespace DW1000Ng {
 	void setNetworkId(uint16_t val);
 
 	/**
-	Gets the network identifier (a.k.a PAN id) set for the device
+	Gets the network identifier (a.k.a PAN id) set for the device, from the driver copy (no SPI access)
 
 	@param[out] id the bytes that represent the PAN id (2 bytes)
 	*/
@@ -143,7 +206,7 @@ namespace DW1000Ng {
 	void setDeviceAddress(uint16_t val);
 
 	/**
-	Gets the short address identifier set for the device
+	Gets the short address identifier set for the device, from the driver copy (no SPI access)
 
 	@param[out] address the bytes that represent the short address of the device(2 bytes)
 	*/
@@ -166,7 +229,7 @@ namespace DW1000Ng {
 	void setEUI(byte eui[]);
 	
 	/**
-	Gets the device Extended Unique Identifier.
+	Gets the device Extended Unique Identifier, from the driver copy (no SPI access).
 
 	@param[out] eui The 8 bytes of the EUI.
 	*/
@@ -228,6 +291,16 @@ namespace DW1000Ng {
 	*/
 	void setDelayedTRX(byte futureTimeBytes[]);
 
+	/**
+	Sets the time for the next delayed transmission.
+	The device ignores the low 9 bits of DX_TIME, the target is rounded down the same way.
+
+	@param [in] targetTime the system time (UWB time) at which to transmit
+
+	returns the exact TX timestamp the frame will carry (tx antenna delay included)
+	*/
+	uint64_t setDelayedTransmitTime(uint64_t targetTime);
+
 	/**
 	Sets the transmission bytes inside the tx buffer of the DW1000
 
@@ -302,6 +375,20 @@ namespace DW1000Ng {
 	*/ 
 	float getFirstPathPower();
 
+	/**
+	Gets the receive power of the device (last receive) using integer math only
+
+	returns the last receive power in dBm, Q16.16 fixed point
+	*/
+	int32_t getReceivePowerQ16();
+
+	/**
+	Gets the power of the first path using integer math only
+
+	returns the first path power in dBm, Q16.16 fixed point
+	*/
+	int32_t getFirstPathPowerQ16();
+
 	/**
 	Gets the last receive quality
 
@@ -309,6 +396,63 @@ namespace DW1000Ng {
 	*/
 	float getReceiveQuality();
 
+	/**
+	Gets the number of preamble symbols accumulated for the last received frame (RXPACC)
+
+	returns the preamble accumulation count
+	*/
+	uint16_t getPreambleAccumulationCount();
+
+	/**
+	Clears and starts the event counters of the DW1000 (frame errors, filter rejections, timeouts, overruns...).
+	Counters are 12 bit wide and are lost on reset and sleep.
+	*/
+	void enableEventCounters();
+
+	/**
+	Stops the event counters.
+	*/
+	void disableEventCounters();
+
+	/**
+	Reads all the event counters in a single SPI transaction.
+	Each counter wraps at 4096: call it often enough to see less events than that between two calls.
+
+	@param [out] counters the events counted since the previous call (or since enableEventCounters())
+	*/
+	void getEventCounters(event_counters_t& counters);
+
+	/**
+	Gets the first path position found by the LDE in the accumulator for the last received frame
+
+	returns the first path index in samples (~1 ns each), 10.6 fixed point
+	*/
+	uint16_t getFirstPathIndex();
+
+	/**
+	Reads accumulator (channel impulse response) samples of the last received frame, DW1000NG_CIR_CHUNK
+	samples per SPI transaction. The accumulator clocks are enabled for the read and disabled afterwards.
+	The receiver must not be re-enabled before the read, or the accumulator is overwritten.
+
+	@param [out] samples the buffer receiving the samples
+	@param [in] first the index of the first sample
+	@param [in] count the number of samples to read
+
+	returns the number of samples read, less than count at the end of the accumulator (992 samples at 16 MHz PRF, 1016 at 64 MHz)
+	*/
+	uint16_t readCIR(cir_sample_t samples[], uint16_t first, uint16_t count);
+
+	/**
+	Reads a window of the accumulator around the first path of the last received frame, see readCIR()
+
+	@param [out] samples the buffer receiving the samples
+	@param [in] before the number of samples before the first path
+	@param [in] count the number of samples to read
+
+	returns the number of samples read
+	*/
+	uint16_t readCIRAroundFirstPath(cir_sample_t samples[], uint16_t before, uint16_t count);
+
 	/**
 	Sets both tx and rx antenna delay value
 
@@ -434,6 +578,14 @@ namespace DW1000Ng {
 
 	void clearReceiveTimeoutStatus();
 
+	/**
+	Checks if the last received frame triggered an automatic acknowledgement (see enableAutoAcknowledge()).
+	The ACK transmission ends with the transmit done event, AAT is cleared with clearTransmitStatus().
+
+	returns true if an ACK is being or has been sent
+	*/
+	boolean isAutoAcknowledgeTriggered();
+
 	/**
 	Stops the transceiver immediately, this actually sets the device in Idle mode.
 	*/
@@ -444,7 +596,7 @@ namespace DW1000Ng {
 
 	By default this is set to true by the DW1000
 
-	@param [in] val True here means active high
+	@param [in] val True here means active high, the interrupt is then attached to the rising edge (falling otherwise)
 	*/
 	void setInterruptPolarity(boolean val);
 
@@ -455,6 +607,13 @@ namespace DW1000Ng {
 	*/
 	void applyConfiguration(device_configuration_t config);
 
+	/**
+	Gets the configuration in use, e.g. to derive timeouts with DW1000NgAirtime
+
+	@param [out] config the current configuration
+	*/
+	void getConfiguration(device_configuration_t& config);
+
 	/**
 	Enables the interrupts for the target events
 
@@ -475,6 +634,34 @@ namespace DW1000Ng {
 	returns the current PRF
 	*/
 	PulseFrequency getPulseFrequency();
+
+	/**
+	Gets the current preamble length of the device
+
+	returns the current preamble length
+	*/
+	PreambleLength getPreambleLength();
+
+	/**
+	Computes the registers to write to move to another channel and preamble code, keeping the rest of the
+	current configuration (PRF, data rate, smart power). The result is valid until the next applyConfiguration().
+
+	@param [in] channel the target channel
+	@param [in] preambleCode the target preamble code
+	@param [out] tuning the register values
+
+	returns false if the preamble code is not valid on the channel with the current PRF
+	*/
+	boolean getChannelTuning(Channel channel, PreambleCode preambleCode, channel_tuning_t& tuning);
+
+	/**
+	Moves to the channel and preamble code of a tuning computed by getChannelTuning().
+	Turns the transceiver off and writes only the registers whose value differs from the current one,
+	instead of the full configuration and tuning of applyConfiguration().
+
+	@param [in] tuning the target channel tuning
+	*/
+	void applyChannelTuning(const channel_tuning_t& tuning);
 	
 	/**
 	Sets the timeout for Raceive Frame.
@@ -500,6 +687,28 @@ namespace DW1000Ng {
 	*/
 	void setReceiveFrameWaitTimeoutPeriod(uint16_t timeMicroSeconds);
 
+	/**
+	Gets the frame wait timeout last set, 0 when disabled
+
+	returns the timeout in μs (see setReceiveFrameWaitTimeoutPeriod())
+	*/
+	uint16_t getReceiveFrameWaitTimeoutPeriod();
+
+	/**
+	Derives the preamble detection, SFD detection and frame wait timeouts from the current configuration
+	(see DW1000NgAirtime) and keeps them updated on every applyConfiguration().
+	The receiver gives up as soon as a frame starting within responseWait can no longer arrive.
+
+	@param [in] expectedDataLength the data length of the longest frame expected
+	@param [in] responseWait how long, in μs, after startReceive() the preamble of the expected frame may start
+	*/
+	void enableAutoReceiveTimeouts(uint16_t expectedDataLength, uint16_t responseWait);
+
+	/**
+	Stops updating the receiver timeouts on applyConfiguration(), the last values stay in use
+	*/
+	void disableAutoReceiveTimeouts();
+
 	/**
 	Sets the device in receive mode
 
@@ -511,8 +720,11 @@ namespace DW1000Ng {
 	Sets the device in transmission mode
 
 	@param [in] mode IMMEDIATE or DELAYED transmission
+
+	returns false if a DELAYED transmission was requested too late (HPDWARN), or so close to its target
+	that the transmitter could not power up in time (TXPUTE), in that case the transceiver is turned off
 	*/
-	void startTransmit(TransmitMode mode = TransmitMode::IMMEDIATE);
+	boolean startTransmit(TransmitMode mode = TransmitMode::IMMEDIATE);
 		
 	/**
 	Gets the temperature inside the DW1000 Device
@@ -536,6 +748,38 @@ namespace DW1000Ng {
 	*/ 
 	void getTemperatureAndBatteryVoltage(float& temp, float& vbat);
 
+	/**
+	Enables the temperature and voltage compensation of the antenna delays, TC_PGDELAY and TX power.
+	The offsets of the table are added to the values set with the usual functions (setAntennaDelay(),
+	setTXPower(), setTCPGDelay() or their automatic values), which stay the calibrated ones.
+	Nothing is written until updateCompensation() samples.
+
+	@param [in] config the coefficient table, its points must stay valid while the compensation is enabled
+	*/
+	void enableCompensation(const compensation_configuration_t& config);
+
+	/**
+	Disables the compensation and writes back the calibrated values that had an offset
+	*/
+	void disableCompensation();
+
+	/**
+	Samples temperature and battery voltage once the interval of the configuration has elapsed,
+	and writes only the registers whose offset changed.
+	Call it from the loop while the transceiver is idle, between two exchanges: a sample costs 6 SPI transactions.
+	The antenna delays written to the device and the time returned by setDelayedTransmitTime() include the offset.
+
+	returns true if registers were written
+	*/
+	boolean updateCompensation();
+
+	/**
+	Gets the last sample and the offsets applied from it
+
+	@param [out] state temperature, battery voltage and offsets
+	*/
+	void getCompensation(compensation_state_t& state);
+
 	/**
 	Enables the frame filtering functionality using the provided configuration.
 	Messages must be formatted using 802.15.4-2011 format.
@@ -548,6 +792,27 @@ namespace DW1000Ng {
 	Disables the frame filtering functionality
 	*/
 	void disableFrameFiltering();
+
+	/**
+	Enables the automatic acknowledgement: the device answers on its own, with no MCU round trip, to the
+	data and MAC command frames that request an ACK and are addressed to it (broadcasts are never acknowledged).
+	Frame filtering must be enabled (see enableFrameFiltering()). The ACK is sent
+	DW1000NgAirtime::acknowledgeTurnaround() preamble symbols after the frame, the value follows applyConfiguration().
+	The transmission of the ACK raises the transmit events as well, the receiver is off after it.
+	*/
+	void enableAutoAcknowledge();
+
+	/**
+	Disables the automatic acknowledgement
+	*/
+	void disableAutoAcknowledge();
+
+	/**
+	Sets the frame pending bit of the automatic ACKs sent in reply to MAC command data requests
+
+	@param [in] val true if data is pending for the requester
+	*/
+	void setAutoAcknowledgeFramePending(boolean val);
 	
 	/**
 	WARNING: this just sets the relative bits inside the register.
@@ -570,6 +835,16 @@ namespace DW1000Ng {
 	*/
 	void setWait4Response(uint32_t timeMicroSeconds);
 
+	/**
+	Turns the receiver on right after every transmission, with no delay, to receive the automatic acknowledgement
+	of frames sent with the ACK request bit (see DW1000NgFrame::DataFrame::requestAcknowledge()).
+	Replaces the delay of setWait4Response(). Pair it with a frame wait timeout of
+	DW1000NgAirtime::acknowledgeWaitTimeout(), and allow acknowledgements if frame filtering is enabled.
+
+	@param [in] val true to wait for an ACK after each transmission, false to restore the delay of setWait4Response()
+	*/
+	void setWait4Acknowledge(boolean val);
+
 	#if DW1000NG_PRINTABLE
 
 	/* ##### Print device id, address, etc. ###################################### */
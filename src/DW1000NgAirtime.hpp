@@ -0,0 +1,232 @@
+/*
+ * MIT License
+ * 
+ * Copyright (c) 2018 Michele Biondi, Andrea Salvatori
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+*/
+
+#pragma once
+
+#include <Arduino.h>
+#include "DW1000NgConstants.hpp"
+#include "DW1000NgConfiguration.hpp"
+#include "DW1000NgTime.hpp"
+
+/* Durations of the parts of a frame on air, in UWB time units (see DW1000NgTime) */
+typedef struct frame_airtime_t {
+    uint64_t preamble;
+    uint64_t shr;       /* preamble and SFD, the RMARKER is at its end */
+    uint64_t phr;
+    uint64_t payload;   /* data and FCS, with the Reed Solomon parity */
+    uint64_t total;
+} frame_airtime_t;
+
+namespace DW1000NgAirtime {
+
+    /* preamble symbol: 496 (16 MHz PRF) or 508 (64 MHz PRF) chips of 1 / 499.2 MHz */
+    constexpr uint64_t PREAMBLE_SYMBOL_16MHZ = 63488;
+    constexpr uint64_t PREAMBLE_SYMBOL_64MHZ = 65024;
+
+    /* data symbols, one bit each */
+    constexpr uint64_t DATA_SYMBOL_110KBPS = 524288;
+    constexpr uint64_t DATA_SYMBOL_850KBPS = 65536;
+    constexpr uint64_t DATA_SYMBOL_6800KBPS = 8192;
+
+    /* the PHR is sent at 850 kbps, or at 110 kbps in 110 kbps mode */
+    constexpr uint8_t PHR_SYMBOLS = 21;
+
+    /* Reed Solomon adds 48 parity bits to every block of up to 330 data bits */
+    constexpr uint16_t REED_SOLOMON_BLOCK_BITS = 330;
+    constexpr uint8_t REED_SOLOMON_PARITY_BITS = 48;
+
+    /* unit of the frame wait timeout (RX_WFTO) and of the wait for response delay (W4R_TIM): 512 / 499.2 MHz */
+    constexpr uint64_t WAIT_TIME_UNIT = 65536;
+
+    /* shortest preamble timeout, in PACs, suggested by Decawave for short range */
+    constexpr uint16_t MINIMUM_PREAMBLE_TIMEOUT_PACS = 5;
+
+    constexpr uint16_t preambleSymbols(PreambleLength length) {
+        return length == PreambleLength::LEN_64 ? 64 :
+               length == PreambleLength::LEN_128 ? 128 :
+               length == PreambleLength::LEN_256 ? 256 :
+               length == PreambleLength::LEN_512 ? 512 :
+               length == PreambleLength::LEN_1024 ? 1024 :
+               length == PreambleLength::LEN_1536 ? 1536 :
+               length == PreambleLength::LEN_2048 ? 2048 : 4096;
+    }
+
+    /* PAC size the driver uses for a preamble length (see DW1000Ng::applyConfiguration) */
+    constexpr uint16_t pacSymbols(PreambleLength length) {
+        return preambleSymbols(length) <= 128 ? 8 :
+               preambleSymbols(length) <= 512 ? 16 :
+               preambleSymbols(length) <= 1024 ? 32 : 64;
+    }
+
+    constexpr uint16_t sfdSymbols(DataRate rate, SFDMode mode) {
+        return rate == DataRate::RATE_110KBPS ? 64 :
+               (rate == DataRate::RATE_850KBPS && mode == SFDMode::DECAWAVE_SFD) ? 16 : 8;
+    }
+
+    constexpr uint64_t preambleSymbolDuration(PulseFrequency prf) {
+        return prf == PulseFrequency::FREQ_64MHZ ? PREAMBLE_SYMBOL_64MHZ : PREAMBLE_SYMBOL_16MHZ;
+    }
+
+    constexpr uint64_t dataSymbolDuration(DataRate rate) {
+        return rate == DataRate::RATE_110KBPS ? DATA_SYMBOL_110KBPS :
+               rate == DataRate::RATE_850KBPS ? DATA_SYMBOL_850KBPS : DATA_SYMBOL_6800KBPS;
+    }
+
+    /* data symbols of a frame of the given length (FCS included) */
+    constexpr uint32_t payloadSymbols(uint16_t frameLength) {
+        return static_cast<uint32_t>(frameLength) * 8
+            + (static_cast<uint32_t>(frameLength) * 8 + REED_SOLOMON_BLOCK_BITS - 1) / REED_SOLOMON_BLOCK_BITS * REED_SOLOMON_PARITY_BITS;
+    }
+
+    /**
+    Airtime of a frame
+
+    @param [in] length the preamble length
+    @param [in] prf the pulse repetition frequency
+    @param [in] rate the data rate
+    @param [in] sfd the SFD mode
+    @param [in] frameLength the frame length as sent, FCS included (TX_FCTRL TFLEN)
+
+    returns the durations in UWB time units
+    */
+    constexpr frame_airtime_t frameAirtime(PreambleLength length, PulseFrequency prf, DataRate rate, SFDMode sfd, uint16_t frameLength) {
+        return {
+            preambleSymbols(length) * preambleSymbolDuration(prf),
+            (preambleSymbols(length) + sfdSymbols(rate, sfd)) * preambleSymbolDuration(prf),
+            PHR_SYMBOLS * (rate == DataRate::RATE_110KBPS ? DATA_SYMBOL_110KBPS : DATA_SYMBOL_850KBPS),
+            payloadSymbols(frameLength) * dataSymbolDuration(rate),
+            (preambleSymbols(length) + sfdSymbols(rate, sfd)) * preambleSymbolDuration(prf)
+                + PHR_SYMBOLS * (rate == DataRate::RATE_110KBPS ? DATA_SYMBOL_110KBPS : DATA_SYMBOL_850KBPS)
+                + payloadSymbols(frameLength) * dataSymbolDuration(rate)
+        };
+    }
+
+    /**
+    Airtime of a frame sent with a configuration
+
+    @param [in] config the device configuration
+    @param [in] dataLength the data length, as given to DW1000Ng::setTransmitData() (the FCS is added when enabled)
+
+    returns the durations in UWB time units
+    */
+    constexpr frame_airtime_t frameAirtime(const device_configuration_t& config, uint16_t dataLength) {
+        return frameAirtime(config.preambleLen, config.pulseFreq, config.dataRate, config.sfd,
+                            dataLength + (config.frameCheck ? 2 : 0));
+    }
+
+    /**
+    Converts an airtime to microseconds, rounded up so that timeouts derived from it are never short
+
+    @param [in] ticks the time in UWB time units
+    */
+    constexpr uint32_t microseconds(uint64_t ticks) {
+        return static_cast<uint32_t>((ticks * 10 + 638975) / 638976);
+    }
+
+    /**
+    SFD detection timeout, for DW1000Ng::setSfdDetectionTimeout(): preamble length + 1 + SFD length - PAC size
+
+    @param [in] config the device configuration
+    */
+    constexpr uint16_t sfdDetectionTimeout(const device_configuration_t& config) {
+        return preambleSymbols(config.preambleLen) + 1 + sfdSymbols(config.dataRate, config.sfd) - pacSymbols(config.preambleLen);
+    }
+
+    /**
+    Preamble detection timeout, for DW1000Ng::setPreambleDetectionTimeout(): the receiver gives up if no preamble
+    starts within wait, plus half of the preamble (at least 5 PACs) to detect it.
+
+    @param [in] config the device configuration
+    @param [in] waitMicroseconds how long before the expected preamble the receiver is turned on
+
+    returns the timeout in PACs
+    */
+    constexpr uint16_t preambleDetectionTimeout(const device_configuration_t& config, uint32_t waitMicroseconds) {
+        return (DW1000NgTime::microsecondsToTicks(waitMicroseconds) + pacSymbols(config.preambleLen) * preambleSymbolDuration(config.pulseFreq) - 1)
+                / (pacSymbols(config.preambleLen) * preambleSymbolDuration(config.pulseFreq))
+            + (preambleSymbols(config.preambleLen) / pacSymbols(config.preambleLen) / 2 > MINIMUM_PREAMBLE_TIMEOUT_PACS ?
+               preambleSymbols(config.preambleLen) / pacSymbols(config.preambleLen) / 2 : MINIMUM_PREAMBLE_TIMEOUT_PACS);
+    }
+
+    /**
+    Frame wait timeout, for DW1000Ng::setReceiveFrameWaitTimeoutPeriod(): the receiver gives up once a frame
+    whose preamble starts within wait had the time to be received completely.
+
+    @param [in] config the device configuration
+    @param [in] dataLength the data length of the expected frame
+    @param [in] waitMicroseconds how long before the expected preamble the receiver is turned on
+
+    returns the timeout in RX_WFTO units (~1.026 us), saturated to the 16 bit register
+    */
+    constexpr uint16_t frameWaitTimeout(const device_configuration_t& config, uint16_t dataLength, uint32_t waitMicroseconds) {
+        return (DW1000NgTime::microsecondsToTicks(waitMicroseconds) + frameAirtime(config, dataLength).total + WAIT_TIME_UNIT - 1) / WAIT_TIME_UNIT > 0xFFFF ?
+            0xFFFF : (DW1000NgTime::microsecondsToTicks(waitMicroseconds) + frameAirtime(config, dataLength).total + WAIT_TIME_UNIT - 1) / WAIT_TIME_UNIT;
+    }
+
+    /* data length of an ACK frame (frame control and sequence number), the FCS is added by the device */
+    constexpr uint8_t ACKNOWLEDGEMENT_LENGTH = 3;
+    /* RX_WFTO units (~1 us) added to the ACK wait for the antenna delays and the propagation (up to ~300 m) */
+    constexpr uint16_t ACKNOWLEDGEMENT_MARGIN = 2;
+
+    /**
+    Turnaround of the automatic acknowledgement (ACK_TIM), see DW1000Ng::enableAutoAcknowledge().
+    At 6.8 Mbps the preamble is short: 3 symbols leave the sender time to turn its receiver on.
+
+    @param [in] rate the data rate
+
+    returns the turnaround in preamble symbols
+    */
+    constexpr uint8_t acknowledgeTurnaround(DataRate rate) {
+        return rate == DataRate::RATE_6800KBPS ? 3 : 0;
+    }
+
+    /**
+    Frame wait timeout covering an automatic acknowledgement, for DW1000Ng::setReceiveFrameWaitTimeoutPeriod()
+    on a sender waiting for it with DW1000Ng::setWait4Acknowledge()
+
+    @param [in] config the device configuration
+
+    returns the timeout in RX_WFTO units (~1.026 us)
+    */
+    constexpr uint16_t acknowledgeWaitTimeout(const device_configuration_t& config) {
+        return (acknowledgeTurnaround(config.dataRate) * preambleSymbolDuration(config.pulseFreq)
+            + frameAirtime(config.preambleLen, config.pulseFreq, config.dataRate, config.sfd, ACKNOWLEDGEMENT_LENGTH + 2).total
+            + WAIT_TIME_UNIT - 1) / WAIT_TIME_UNIT + ACKNOWLEDGEMENT_MARGIN;
+    }
+
+    /**
+    Wait for response delay, for DW1000Ng::setWait4Response(): the receiver is turned on right when the preamble of a
+    response sent replyDelay after the request (RMARKER to RMARKER, as in DW1000NgRTLS) starts.
+
+    @param [in] config the device configuration
+    @param [in] requestLength the data length of the request
+    @param [in] replyDelayMicroseconds the reply delay of the responder
+
+    returns the delay in W4R_TIM units (~1.026 us), 0 if the response starts before the request ends
+    */
+    constexpr uint32_t wait4ResponseDelay(const device_configuration_t& config, uint16_t requestLength, uint32_t replyDelayMicroseconds) {
+        return DW1000NgTime::microsecondsToTicks(replyDelayMicroseconds) > frameAirtime(config, requestLength).phr + frameAirtime(config, requestLength).payload + frameAirtime(config, 0).shr ?
+            (DW1000NgTime::microsecondsToTicks(replyDelayMicroseconds) - frameAirtime(config, requestLength).phr - frameAirtime(config, requestLength).payload - frameAirtime(config, 0).shr) / WAIT_TIME_UNIT : 0;
+    }
+}
@@ -61,6 +61,77 @@
  */
 #define DWM1000_OPTIMIZED false
 
+/**
+ * Uses integer (Q-format) math for ranging instead of double/float.
+ * Enabled by default on AVR, where floating point is software emulated and double is only 32 bit wide.
+ * Receive power estimation always uses integer math.
+ */
+#if defined(__AVR__)
+	#define DW1000NG_FIXED_POINT true
+#else
+	#define DW1000NG_FIXED_POINT false
+#endif
+
+/**
+ * Maximum number of DW1000 devices with an interrupt line driven by one MCU
+ * (see DW1000Ng::select())
+ */
+#define DW1000NG_MAX_DEVICES 4
+
+/**
+ * Frames buffered by the multi radio anchor mode (DW1000NgMultiRadio), each takes about 50 byte of ram
+ */
+#define DW1000NG_MULTI_RADIO_QUEUE_SIZE 8
+
+/**
+ * Records every SPI transaction (register, sub-address, direction, length, first data bytes, micros())
+ * in a ring buffer of DW1000NG_SPI_TRACE_SIZE entries, 14 byte of ram each.
+ * Dump it with SPIporting::dumpSPItrace(Serial) and decode it with extras/spitrace
+ */
+#define DW1000NG_SPI_TRACE false
+#define DW1000NG_SPI_TRACE_SIZE 64
+
+/**
+ * Latency histograms of the driver hot path (see DW1000NgProbes.hpp), measured with the cycle counter
+ * on ESP32, ESP8266 and Cortex-M3/M4/M7 and with micros() elsewhere.
+ * When false the probes compile to nothing.
+ */
+#define DW1000NG_PROBES false
+#define DW1000NG_PROBE_BINS 32
+#define DW1000NG_PROBE_BIN_WIDTH 20
+
+/**
+ * Accumulator (CIR) samples read per SPI transaction by DW1000Ng::readCIR(), 4 byte of stack each
+ */
+#define DW1000NG_CIR_CHUNK 16
+
+/**
+ * Reliable transport (DW1000NgTransport): peers with their own sequence numbers and duplicate window,
+ * retransmissions of an unacknowledged fragment, fragment payload (113 fills a standard frame, up to 1009
+ * with extended frame length) and largest message reassembled, in byte of ram for every peer.
+ * Smaller by default on AVR, where the peers and the frame buffer would otherwise take most of the ram.
+ */
+#if defined(__AVR__)
+	#define DW1000NG_TRANSPORT_PEERS 2
+	#define DW1000NG_TRANSPORT_MESSAGE_SIZE 128
+#else
+	#define DW1000NG_TRANSPORT_PEERS 4
+	#define DW1000NG_TRANSPORT_MESSAGE_SIZE 256
+#endif
+#define DW1000NG_TRANSPORT_RETRIES 3
+#define DW1000NG_TRANSPORT_FRAGMENT_SIZE 113
+
+/**
+ * Rows of the range bias calibration table kept by every device (DW1000NgRanging::setBiasCorrectionTable()),
+ * 4 byte of ram each
+ */
+#define DW1000NG_BIAS_TABLE_ROWS 18
+
+/**
+ * Channel and preamble code pairs of a hopping schedule (DW1000NgHopping), up to 28 byte of ram each
+ */
+#define DW1000NG_HOPPING_SLOTS 8
+
 /**
  * Printable DW1000NgDeviceConfiguration about: rom:2494 byte ; ram 256 byte
  * This option is needed because compiler can not optimize unused codes from inheritanced methods 
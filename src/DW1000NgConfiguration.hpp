@@ -70,4 +70,92 @@ typedef struct sleep_configuration_t {
     boolean enableSLP;
     boolean enableWakePIN;
     boolean enableWakeSPI;
-} sleep_configuration_t;
\ No newline at end of file
+} sleep_configuration_t;
+
+/* Events counted by the DW1000 (DIG_DIAG) since the previous DW1000Ng::getEventCounters() */
+typedef struct event_counters_t {
+    uint16_t phrErrors;             /* PHY header errors */
+    uint16_t rsdErrors;             /* Reed Solomon decoder (frame sync loss) errors */
+    uint16_t fcsGood;               /* frames received with a good CRC */
+    uint16_t fcsErrors;             /* frames received with a bad CRC */
+    uint16_t frameFilterRejections;
+    uint16_t rxOverruns;
+    uint16_t sfdTimeouts;
+    uint16_t preambleTimeouts;
+    uint16_t frameWaitTimeouts;
+    uint16_t txFramesSent;
+    uint16_t halfPeriodWarnings;    /* delayed TX/RX started late */
+    uint16_t txPowerUpWarnings;
+} event_counters_t;
+
+/* One sample of the accumulator (channel impulse response) */
+typedef struct cir_sample_t {
+    int16_t real;
+    int16_t imaginary;
+} cir_sample_t;
+
+/* Factory calibration read from OTP by DW1000Ng::initialize(), zero where not programmed */
+typedef struct otp_calibration_t {
+    byte eui[8];
+    byte ldoTune[5];
+    byte vmeas3v3;                  /* SAR reading at 3.3 V */
+    byte tmeas23C;                  /* SAR reading at 23 C */
+    byte xtalTrim;
+    uint16_t antennaDelay16MHz;
+    uint16_t antennaDelay64MHz;
+} otp_calibration_t;
+
+/* Values of the registers that depend on the channel and the preamble code (see DW1000Ng::getChannelTuning()) */
+typedef struct channel_tuning_t {
+    Channel channel;
+    PreambleCode preambleCode;
+    uint32_t chanCtrl;
+    uint16_t ldeRepc;
+    uint32_t txPower;       /* written only with the automatic TX power */
+    uint32_t rfTxCtrl;
+    uint32_t fsPllCfg;
+    byte fsPllTune;
+    byte rfRxCtrlH;
+    byte tcPgDelay;         /* written only with the automatic TC_PGDELAY */
+} channel_tuning_t;
+
+/* Point of a compensation table (see DW1000Ng::enableCompensation()), offsets from the calibrated values */
+typedef struct compensation_point_t {
+    int8_t temperature;     /* degrees C */
+    int16_t antennaDelay;   /* UWB time units added to the TX and RX antenna delays */
+    int8_t pgDelay;         /* added to TC_PGDELAY */
+    int8_t txPower;         /* 0.5 dB steps added to every TX power field */
+} compensation_point_t;
+
+typedef struct compensation_configuration_t {
+    const compensation_point_t* points;   /* sorted by temperature, interpolated linearly, not copied */
+    uint8_t pointsCount;
+    int8_t txPowerPerVolt;                /* 0.5 dB steps added per volt of battery below 3.3 V */
+    uint16_t interval;                    /* ms between two samples */
+} compensation_configuration_t;
+
+/* Last sample of DW1000Ng::updateCompensation() and offsets applied from it */
+typedef struct compensation_state_t {
+    float temperature;
+    float batteryVoltage;
+    int16_t antennaDelay;
+    int8_t pgDelay;
+    int8_t txPower;
+} compensation_state_t;
+
+/* Duration of the steps of the last DW1000Ng::initialize() and of the last DW1000Ng::spiWakeup(), in μs */
+typedef struct boot_timing_t {
+    uint16_t powerUp;   /* until the device answers on SPI */
+    uint16_t reset;     /* reset, until the device answers again */
+    uint16_t otp;       /* factory calibration read from OTP and applied */
+    uint16_t lde;       /* LDE microcode load */
+    uint16_t pllLock;   /* until the clock PLL locks */
+    uint16_t total;
+    uint16_t wakeup;    /* spiWakeup(), until the clock PLL locks */
+} boot_timing_t;
+
+/* A row of a range bias correction table, see APS011 */
+typedef struct bias_correction_point_t {
+    uint8_t rxPower; // receive power as -dBm (61 means -61 dBm)
+    int16_t correction; // millimeters added to the range
+} bias_correction_point_t;
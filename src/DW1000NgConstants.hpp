@@ -36,6 +36,9 @@
 	/* Speed of radio waves (light) [m/s] * timestamp resolution [~15.65ps] of DW1000Ng */
 	constexpr float DISTANCE_OF_RADIO     = 0.0046917639786159f;
 	constexpr float DISTANCE_OF_RADIO_INV = 213.139451293f;
+
+	/* DISTANCE_OF_RADIO in millimeters, Q24 fixed point */
+	constexpr int64_t DISTANCE_OF_RADIO_MM_Q24 = 78714738;
 	
 	// timestamp byte length - 40 bit -> 5 byte
 	constexpr uint8_t LENGTH_TIMESTAMP = 5;
@@ -157,6 +160,12 @@ constexpr byte SYS_PLL_CLOCK  = 0x02;
 constexpr byte TX_PLL_CLOCK = 0x20;
 constexpr byte LDE_CLOCK = 0x03;
 
+/* receive power estimation (user manual 4.7.1) per PRF, Q16.16: A and the slope of the Fig. 22 correction */
+constexpr int32_t POWER_OFFSET_16MHZ_Q16 = 7456031; // 113.77
+constexpr int32_t POWER_CORRECTION_16MHZ_Q16 = 152922; // 2.3334
+constexpr int32_t POWER_OFFSET_64MHZ_Q16 = 7978353; // 121.74
+constexpr int32_t POWER_CORRECTION_64MHZ_Q16 = 76461; // 1.1667
+
 /* range bias tables - APS011*/
 
 constexpr double BIAS_TABLE[18][5] = {
@@ -0,0 +1,122 @@
+/*
+ * MIT License
+ * 
+ * Copyright (c) 2018 Michele Biondi, Andrea Salvatori
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+*/
+
+#pragma once
+
+#include <Arduino.h>
+#include <SPI.h>
+#include "DW1000NgCompileOptions.hpp"
+#include "DW1000NgConstants.hpp"
+#include "DW1000NgConfiguration.hpp"
+
+/**
+Driver state of a single DW1000: pins, SPI bus, register mirrors and current configuration.
+Declare one for each radio and address it with DW1000Ng::select(), the DW1000Ng functions
+always act on the selected device (a default one if select() was never called).
+Fields are internal to the driver and must not be modified directly.
+*/
+class DW1000NgDevice {
+public:
+	/* SPI bus, select pin, interrupt pin and polarity, reset pin */
+	SPIClass*	_spi = nullptr;
+	SPIClock	_spiClock = SPIClock::FAST;
+	uint8_t		_ss = 0xff;
+	uint8_t		_irq = 0xff;
+	uint8_t		_rst = 0xff;
+	boolean		_interruptActiveHigh = true;
+
+	/* IRQ callbacks */
+	void (* _handleSent)(void)                      = nullptr;
+	void (* _handleError)(void)                     = nullptr;
+	void (* _handleReceived)(void)                  = nullptr;
+	void (* _handleReceiveFailed)(void)             = nullptr;
+	void (* _handleReceiveTimeout)(void)            = nullptr;
+	void (* _handleReceiveTimestampAvailable)(void) = nullptr;
+
+	/* registers (sizes checked against DW1000NgRegisters.hpp in DW1000Ng.cpp) */
+	byte       _syscfg[4] = {};
+	byte       _sysctrl[4] = {};
+	byte       _sysstatus[4] = {};
+	byte       _txfctrl[5] = {};
+	byte       _sysmask[4] = {};
+	byte       _chanctrl[4] = {};
+	byte       _networkAndAddress[4] = {};
+	byte       _eui[8] = {};
+
+	/* factory calibration, read once from OTP (temperature and voltage references, crystal trim, ...) */
+	otp_calibration_t _otp = {};
+
+	/* Driver Internal State Trackers */
+	byte        	_extendedFrameLength = 0;
+	PacSize        	_pacSize = PacSize::SIZE_8;
+	PulseFrequency	_pulseFrequency = PulseFrequency::FREQ_16MHZ;
+	DataRate        _dataRate = DataRate::RATE_110KBPS;
+	PreambleLength	_preambleLength = PreambleLength::LEN_64;
+	PreambleCode	_preambleCode = PreambleCode::CODE_1;
+	Channel        	_channel = Channel::CHANNEL_1;
+	boolean     	_smartPower = false;
+	boolean     	_frameCheck = false;
+	boolean     	_debounceClockEnabled = false;
+	boolean     	_nlos = false;
+	boolean			_standardSFD = true;
+	boolean     	_autoTXPower = true;
+	boolean     	_autoTCPGDelay = true;
+	boolean 		_wait4resp = false;
+	uint32_t		_wait4respTime = 0;
+	boolean			_loadEUIOnWake = false;
+	boolean			_autoAcknowledge = false;
+	uint16_t		_antennaTxDelay = 0;
+	uint16_t		_antennaRxDelay = 0;
+	uint32_t		_txPower = 0;
+	byte			_tcPgDelay = 0;
+
+	/* temperature and voltage compensation (enableCompensation), offsets added to the values above */
+	boolean			_compensation = false;
+	compensation_configuration_t _compensationConfig = {};
+	compensation_state_t _compensationState = {};
+	uint32_t		_compensationSample = 0;
+
+	/* receive power constants of the current PRF, set with the PRF */
+	int32_t			_powerOffsetQ16 = POWER_OFFSET_16MHZ_Q16;
+	int32_t			_powerCorrectionQ16 = POWER_CORRECTION_16MHZ_Q16;
+
+	/* receiver timeouts derived from the configuration (enableAutoReceiveTimeouts) */
+	boolean			_autoReceiveTimeouts = false;
+	uint16_t		_expectedDataLength = 0;
+	uint16_t		_responseWait = 0;
+	uint16_t		_frameWaitTimeout = 0;
+
+	/* range bias calibration of the antenna (DW1000NgRanging::setBiasCorrectionTable()),
+	   used only on the channel and PRF it was measured on */
+	bias_correction_point_t _biasCorrection[DW1000NG_BIAS_TABLE_ROWS] = {};
+	uint8_t			_biasCorrectionRows = 0;
+	Channel			_biasCorrectionChannel = Channel::CHANNEL_5;
+	PulseFrequency	_biasCorrectionPulseFrequency = PulseFrequency::FREQ_16MHZ;
+
+	/* event counters at the last getEventCounters() */
+	uint16_t		_eventCounters[12] = {};
+
+	/* steps of the last initialize() */
+	boot_timing_t	_bootTiming = {};
+};
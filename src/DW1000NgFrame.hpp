@@ -0,0 +1,204 @@
+/*
+ * MIT License
+ * 
+ * Copyright (c) 2018 Michele Biondi, Andrea Salvatori
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+*/
+
+
+#pragma once
+
+#include <Arduino.h>
+#include "DW1000Ng.hpp"
+#include "DW1000NgRTLS.hpp"
+
+namespace DW1000NgFrame {
+
+    /* standard and extended (see DW1000Ng::useExtendedFrameLength) frame size with the 2 bytes CRC, and size of a long address (EUI) */
+    constexpr uint8_t MAX_LENGTH = 127;
+    constexpr uint16_t MAX_EXTENDED_LENGTH = 1023;
+    constexpr uint8_t LONG_ADDRESS_LENGTH = 8;
+
+    /* 
+    MAC header layout of the data frames for each addressing mode (second frame control byte):
+    frame control (2), sequence number (1), destination PAN ID (2), destination and source addresses.
+    PAN ID compression is always set, the source PAN ID is omitted.
+    */
+    template<byte ADDRESSING> struct Layout;
+
+    template<> struct Layout<SHORT_SRC_AND_DEST> {
+        static constexpr uint8_t DESTINATION_LENGTH = 2;
+        static constexpr uint8_t SOURCE_LENGTH = 2;
+    };
+
+    template<> struct Layout<SHORT_SRC_LONG_DEST> {
+        static constexpr uint8_t DESTINATION_LENGTH = LONG_ADDRESS_LENGTH;
+        static constexpr uint8_t SOURCE_LENGTH = 2;
+    };
+
+    template<> struct Layout<LONG_SRC_SHORT_DEST> {
+        static constexpr uint8_t DESTINATION_LENGTH = 2;
+        static constexpr uint8_t SOURCE_LENGTH = LONG_ADDRESS_LENGTH;
+    };
+
+    template<> struct Layout<LONG_SRC_AND_DEST> {
+        static constexpr uint8_t DESTINATION_LENGTH = LONG_ADDRESS_LENGTH;
+        static constexpr uint8_t SOURCE_LENGTH = LONG_ADDRESS_LENGTH;
+    };
+
+    constexpr uint8_t SEQUENCE_NUMBER = 2;
+    constexpr uint8_t PAN_ID = 3;
+    constexpr uint8_t DESTINATION = 5;
+
+    template<byte ADDRESSING> constexpr uint8_t source() {
+        return DESTINATION + Layout<ADDRESSING>::DESTINATION_LENGTH;
+    }
+
+    template<byte ADDRESSING> constexpr uint8_t headerLength() {
+        return source<ADDRESSING>() + Layout<ADDRESSING>::SOURCE_LENGTH;
+    }
+
+    /* blink: frame control (1), sequence number (1), source EUI (8) */
+    constexpr uint8_t BLINK_SOURCE = 2;
+    constexpr uint8_t BLINK_HEADER_LENGTH = BLINK_SOURCE + LONG_ADDRESS_LENGTH;
+
+    /**
+    A data frame built in place: the header (PAN ID and source address of the selected device) is filled
+    on construction, the payload is written through payload() and the frame is sent with transmit().
+    Offsets and size are known at compile time, the frame lives in a single buffer of the exact size.
+    Frames longer than MAX_LENGTH need extended frame length enabled.
+
+    @param ADDRESSING one of SHORT_SRC_AND_DEST, SHORT_SRC_LONG_DEST, LONG_SRC_SHORT_DEST, LONG_SRC_AND_DEST
+    @param PAYLOAD_LENGTH the payload size in bytes
+    */
+    template<byte ADDRESSING, uint16_t PAYLOAD_LENGTH>
+    class DataFrame {
+    public:
+        static constexpr uint8_t SOURCE = source<ADDRESSING>();
+        static constexpr uint8_t HEADER_LENGTH = headerLength<ADDRESSING>();
+        static constexpr uint16_t LENGTH = HEADER_LENGTH + PAYLOAD_LENGTH;
+        static_assert(LENGTH + 2 <= MAX_EXTENDED_LENGTH, "Frame does not fit an extended frame with its CRC");
+
+        /**
+        @param [in] sequenceNumber the MAC sequence number
+        @param [in] destination the destination address, 2 or 8 bytes depending on ADDRESSING
+        */
+        DataFrame(byte sequenceNumber, const byte destination[]) {
+            _data[0] = DATA;
+            _data[1] = ADDRESSING;
+            _data[SEQUENCE_NUMBER] = sequenceNumber;
+            DW1000Ng::getNetworkId(&_data[PAN_ID]);
+            memcpy(&_data[DESTINATION], destination, Layout<ADDRESSING>::DESTINATION_LENGTH);
+            if(Layout<ADDRESSING>::SOURCE_LENGTH == LONG_ADDRESS_LENGTH)
+                DW1000Ng::getEUI(&_data[SOURCE]);
+            else
+                DW1000Ng::getDeviceAddress(&_data[SOURCE]);
+        }
+
+        byte* payload() {
+            return &_data[HEADER_LENGTH];
+        }
+
+        byte sequenceNumber() const {
+            return _data[SEQUENCE_NUMBER];
+        }
+
+        /**
+        Sets the ACK request bit: a receiver with automatic acknowledgement answers with an ACK
+        (see DW1000Ng::enableAutoAcknowledge() and DW1000Ng::setWait4Acknowledge())
+        */
+        void requestAcknowledge() {
+            _data[0] |= ACK_REQUEST;
+        }
+
+        /**
+        Writes the frame to the TX buffer and starts the transmission
+
+        @param [in] mode IMMEDIATE or DELAYED (see DW1000Ng::startTransmit)
+
+        returns false if a delayed transmission was too late
+        */
+        boolean transmit(TransmitMode mode = TransmitMode::IMMEDIATE) {
+            DW1000Ng::setTransmitData(_data, LENGTH);
+            return DW1000Ng::startTransmit(mode);
+        }
+
+        /**
+        Sends the frame with only the first payloadLength bytes of the payload, see transmit()
+
+        @param [in] payloadLength the payload bytes to send, at most PAYLOAD_LENGTH
+        @param [in] mode IMMEDIATE or DELAYED
+        */
+        boolean transmit(uint16_t payloadLength, TransmitMode mode = TransmitMode::IMMEDIATE) {
+            DW1000Ng::setTransmitData(_data, HEADER_LENGTH + (payloadLength < PAYLOAD_LENGTH ? payloadLength : PAYLOAD_LENGTH));
+            return DW1000Ng::startTransmit(mode);
+        }
+
+    private:
+        byte _data[LENGTH];
+    };
+
+    /**
+    Checks that a received frame is the acknowledgement of the frame with the given sequence number
+
+    @param [in] frame the received data (see DW1000Ng::getReceivedData)
+    @param [in] length the received data length
+    @param [in] sequenceNumber the sequence number of the frame sent with the ACK request bit
+
+    returns true if the frame is the ACK
+    */
+    inline boolean isAcknowledgement(const byte frame[], uint16_t length, byte sequenceNumber) {
+        return length >= SEQUENCE_NUMBER + 1 && (frame[0] & 0x07) == ACKNOWLEDGEMENT && frame[SEQUENCE_NUMBER] == sequenceNumber;
+    }
+
+    /**
+    A blink frame (IEEE 802.15.4 blink with the EUI of the selected device as source), see DataFrame
+
+    @param PAYLOAD_LENGTH the payload size in bytes
+    */
+    template<uint8_t PAYLOAD_LENGTH>
+    class BlinkFrame {
+    public:
+        static constexpr uint8_t HEADER_LENGTH = BLINK_HEADER_LENGTH;
+        static constexpr uint8_t LENGTH = HEADER_LENGTH + PAYLOAD_LENGTH;
+        static_assert(LENGTH + 2 <= MAX_LENGTH, "Frame does not fit a standard frame with its CRC");
+
+        /**
+        @param [in] sequenceNumber the MAC sequence number
+        */
+        explicit BlinkFrame(byte sequenceNumber) {
+            _data[0] = BLINK;
+            _data[1] = sequenceNumber;
+            DW1000Ng::getEUI(&_data[BLINK_SOURCE]);
+        }
+
+        byte* payload() {
+            return &_data[HEADER_LENGTH];
+        }
+
+        boolean transmit(TransmitMode mode = TransmitMode::IMMEDIATE) {
+            DW1000Ng::setTransmitData(_data, LENGTH);
+            return DW1000Ng::startTransmit(mode);
+        }
+
+    private:
+        byte _data[LENGTH];
+    };
+}
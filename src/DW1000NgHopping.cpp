@@ -0,0 +1,111 @@
+/*
+ * MIT License
+ * 
+ * Copyright (c) 2018 Michele Biondi, Andrea Salvatori
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+*/
+
+
+#include <Arduino.h>
+#include "DW1000NgHopping.hpp"
+#include "DW1000Ng.hpp"
+
+namespace DW1000NgHopping {
+
+    namespace {
+        /* computed for the device selected at setSchedule(), not per device */
+        channel_tuning_t _schedule[DW1000NG_HOPPING_SLOTS];
+        uint8_t _slotsCount = 0;
+        uint8_t _slot = 0;
+    }
+
+    boolean setSchedule(const hop_t schedule[], uint8_t count) {
+        if(count == 0 || count > DW1000NG_HOPPING_SLOTS)
+            return false;
+        for(uint8_t i = 0; i < count; i++) {
+            if(!DW1000Ng::getChannelTuning(schedule[i].channel, schedule[i].preambleCode, _schedule[i])) {
+                _slotsCount = 0;
+                return false;
+            }
+        }
+        _slotsCount = count;
+        hopTo(0);
+        return true;
+    }
+
+    void hopTo(uint8_t slot) {
+        if(slot >= _slotsCount)
+            return;
+        DW1000Ng::applyChannelTuning(_schedule[slot]);
+        _slot = slot;
+    }
+
+    void hop() {
+        hopTo(_slot + 1 < _slotsCount ? _slot + 1 : 0);
+    }
+
+    uint8_t getSlot() {
+        return _slot;
+    }
+
+    uint8_t slotOf(byte sequenceNumber) {
+        if(_slotsCount < 2)
+            return 0;
+        return 1 + sequenceNumber % (_slotsCount - 1);
+    }
+
+    void synchronize(byte blinkSequenceNumber) {
+        hopTo(slotOf(blinkSequenceNumber));
+    }
+
+    RangeInfrastructureResult tagTwrLocalize(uint16_t finalMessageDelay) {
+        hopTo(0);
+        byte blinkSequenceNumber = DW1000NgRTLS::getSequenceNumber();
+        RangeRequestResult request = DW1000NgRTLS::tagRangeRequest();
+        if(!request.success)
+            return {false, 0};
+
+        synchronize(blinkSequenceNumber);
+        RangeInfrastructureResult result = DW1000NgRTLS::tagRangeInfrastructure(request.target_anchor, finalMessageDelay);
+        hopTo(0);
+
+        if(result.success)
+            return result;
+        return {false, 0};
+    }
+
+    RangeInfrastructureResult tagTwrLocalize() {
+        return tagTwrLocalize(DW1000NgRTLS::getReplyDelay());
+    }
+
+    RangeAcceptResult anchorRangeAccept(byte blinkSequenceNumber, NextActivity next, uint16_t value, uint16_t waitMilliseconds) {
+        synchronize(blinkSequenceNumber);
+        RangeAcceptResult result = {false, 0};
+        uint32_t start = millis();
+        while(!result.success && millis() - start < waitMilliseconds) {
+            result = DW1000NgRTLS::anchorRangeAccept(next, value);
+            #if defined(ESP8266)
+            yield();
+            #endif
+        }
+        hopTo(0);
+        return result;
+    }
+}
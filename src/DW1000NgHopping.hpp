@@ -0,0 +1,114 @@
+/*
+ * MIT License
+ * 
+ * Copyright (c) 2018 Michele Biondi, Andrea Salvatori
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+*/
+
+
+#pragma once
+
+#include <Arduino.h>
+#include "DW1000NgCompileOptions.hpp"
+#include "DW1000NgConstants.hpp"
+#include "DW1000NgRTLS.hpp"
+
+typedef struct hop_t {
+    Channel channel;
+    PreambleCode preambleCode;
+} hop_t;
+
+/**
+Channel and preamble code hopping for the RTLS exchange.
+A schedule lists the channel/preamble code pairs (slots) used by a cell. Slot 0 is the rendezvous slot:
+tags blink and anchors wait for blinks there. The rest of the exchange runs on slotOf() the blink sequence number,
+which the tag and every anchor that heard the blink know, then everybody goes back to slot 0.
+Neighbouring cells with different schedules range at the same time without hearing each other.
+
+The register values of every slot are computed once by setSchedule() (see DW1000Ng::getChannelTuning()),
+a hop writes only the registers that differ between the two slots.
+There is a single schedule, and the current slot is kept with it: both belong to the DW1000 selected
+when setSchedule() was called (see DW1000Ng::select()), which must stay selected while hopping.
+*/
+namespace DW1000NgHopping {
+    /**
+    Sets the schedule and moves to slot 0. Call it again after DW1000Ng::applyConfiguration().
+
+    @param [in] schedule the channel/preamble code pairs, the first one is the rendezvous slot
+    @param [in] count number of slots, at most DW1000NG_HOPPING_SLOTS
+
+    returns false if a preamble code is not valid on its channel with the current PRF, or count is out of range
+    */
+    boolean setSchedule(const hop_t schedule[], uint8_t count);
+
+    /**
+    Moves to a slot of the schedule, the transceiver is turned off
+
+    @param [in] slot the slot index
+    */
+    void hopTo(uint8_t slot);
+
+    /**
+    Moves to the next slot of the schedule, after the last one comes slot 0
+    */
+    void hop();
+
+    /**
+    returns the current slot
+    */
+    uint8_t getSlot();
+
+    /**
+    Gets the slot of the exchange that follows a blink, never the rendezvous slot unless the schedule has a single slot
+
+    @param [in] sequenceNumber the sequence number of the blink
+
+    returns the slot index
+    */
+    uint8_t slotOf(byte sequenceNumber);
+
+    /**
+    Moves to the slot of the exchange that follows a blink
+
+    @param [in] blinkSequenceNumber the sequence number of the blink (second byte of the frame)
+    */
+    void synchronize(byte blinkSequenceNumber);
+
+    /**
+    DW1000NgRTLS::tagTwrLocalize() with the ranging on the hopped slot: blink and ranging initiation on slot 0,
+    polls and finals on slotOf() the blink sequence number, back to slot 0 at the end.
+    */
+    RangeInfrastructureResult tagTwrLocalize(uint16_t finalMessageDelay);
+
+    /* Same as above, using the reply delay of DW1000NgRTLS */
+    RangeInfrastructureResult tagTwrLocalize();
+
+    /**
+    DW1000NgRTLS::anchorRangeAccept() after a blink heard on slot 0: moves to the slot of the exchange,
+    waits for the poll of the tag for up to waitMilliseconds (the tag may range other anchors first) and goes back to slot 0.
+    The anchor answering the blink sends its ranging initiation before calling this.
+
+    @param [in] blinkSequenceNumber the sequence number of the blink
+    @param [in] next see DW1000NgRTLS::anchorRangeAccept()
+    @param [in] value see DW1000NgRTLS::anchorRangeAccept()
+    @param [in] waitMilliseconds how long to wait for the poll
+    */
+    RangeAcceptResult anchorRangeAccept(byte blinkSequenceNumber, NextActivity next, uint16_t value, uint16_t waitMilliseconds);
+}
@@ -0,0 +1,140 @@
+/*
+ * MIT License
+ * 
+ * Copyright (c) 2018 Michele Biondi, Andrea Salvatori
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+*/
+
+#include <Arduino.h>
+#include "DW1000NgMultiRadio.hpp"
+#include "DW1000Ng.hpp"
+#include "DW1000NgTime.hpp"
+
+namespace DW1000NgMultiRadio {
+
+    namespace {
+        DW1000NgDevice* _radios[DW1000NG_MAX_DEVICES];
+        uint8_t _radiosCount = 0;
+
+        /* Ring of frames sorted by arrival, _head is the oldest */
+        MultiRadioFrame _queue[DW1000NG_MULTI_RADIO_QUEUE_SIZE];
+        volatile uint8_t _head = 0;
+        volatile uint8_t _count = 0;
+        volatile uint16_t _dropped = 0;
+
+        uint8_t _selectedRadio() {
+            DW1000NgDevice* device = &DW1000Ng::getSelectedDevice();
+            for(uint8_t i = 0; i < _radiosCount; i++) {
+                if(_radios[i] == device)
+                    return i;
+            }
+            return 0xff;
+        }
+
+        void _enqueue(const MultiRadioFrame& frame) {
+            if(_count == DW1000NG_MULTI_RADIO_QUEUE_SIZE) {
+                _dropped++;
+                return;
+            }
+            /* insertion from the tail, the new frame is usually the newest */
+            uint8_t position = _count;
+            while(position > 0) {
+                MultiRadioFrame& previous = _queue[(_head + position - 1) % DW1000NG_MULTI_RADIO_QUEUE_SIZE];
+                if((int32_t)(frame.arrival - previous.arrival) >= 0)
+                    break;
+                _queue[(_head + position) % DW1000NG_MULTI_RADIO_QUEUE_SIZE] = previous;
+                position--;
+            }
+            _queue[(_head + position) % DW1000NG_MULTI_RADIO_QUEUE_SIZE] = frame;
+            _count++;
+        }
+
+        void _handleReceived() {
+            uint8_t radio = _selectedRadio();
+            if(radio != 0xff) {
+                MultiRadioFrame frame;
+                frame.radio = radio;
+                frame.timestamp = DW1000Ng::getReceiveTimestamp();
+                uint64_t age = (DW1000NgTime::Timestamp(DW1000Ng::getSystemTimestamp()) - DW1000NgTime::Timestamp(frame.timestamp));
+                frame.arrival = micros() - (uint32_t)DW1000NgTime::ticksToMicroseconds(age);
+                frame.firstPathPower = DW1000Ng::getFirstPathPower();
+                frame.length = DW1000Ng::getReceivedDataLength();
+                DW1000Ng::getReceivedData(frame.data, frame.length < MULTI_RADIO_FRAME_SIZE ? frame.length : MULTI_RADIO_FRAME_SIZE);
+                _enqueue(frame);
+            }
+            DW1000Ng::startReceive();
+        }
+
+        void _handleReceiveError() {
+            DW1000Ng::startReceive();
+        }
+    }
+
+    void begin(DW1000NgDevice* radios[], uint8_t count) {
+        DW1000NgDevice& previous = DW1000Ng::getSelectedDevice();
+        _radiosCount = count < DW1000NG_MAX_DEVICES ? count : DW1000NG_MAX_DEVICES;
+        _head = 0;
+        _count = 0;
+        _dropped = 0;
+        for(uint8_t i = 0; i < _radiosCount; i++) {
+            _radios[i] = radios[i];
+            DW1000Ng::select(*_radios[i]);
+            DW1000Ng::attachReceivedHandler(_handleReceived);
+            DW1000Ng::attachReceiveFailedHandler(_handleReceiveError);
+            DW1000Ng::attachReceiveTimeoutHandler(_handleReceiveError);
+            DW1000Ng::startReceive();
+        }
+        DW1000Ng::select(previous);
+    }
+
+    void end() {
+        DW1000NgDevice& previous = DW1000Ng::getSelectedDevice();
+        for(uint8_t i = 0; i < _radiosCount; i++) {
+            DW1000Ng::select(*_radios[i]);
+            DW1000Ng::attachReceivedHandler(nullptr);
+            DW1000Ng::attachReceiveFailedHandler(nullptr);
+            DW1000Ng::attachReceiveTimeoutHandler(nullptr);
+            DW1000Ng::forceTRxOff();
+        }
+        DW1000Ng::select(previous);
+        _radiosCount = 0;
+    }
+
+    uint8_t available() {
+        return _count;
+    }
+
+    boolean read(MultiRadioFrame& frame) {
+        noInterrupts();
+        if(_count == 0) {
+            interrupts();
+            return false;
+        }
+        frame = _queue[_head];
+        _head = (_head + 1) % DW1000NG_MULTI_RADIO_QUEUE_SIZE;
+        _count--;
+        interrupts();
+        return true;
+    }
+
+    uint16_t getDroppedFrames() {
+        return _dropped;
+    }
+}
@@ -0,0 +1,81 @@
+/*
+ * MIT License
+ * 
+ * Copyright (c) 2018 Michele Biondi, Andrea Salvatori
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+*/
+
+#pragma once
+
+#include <Arduino.h>
+#include "DW1000NgCompileOptions.hpp"
+#include "DW1000NgDevice.hpp"
+
+/* Frame bytes kept for each received frame, longer frames are truncated (length holds the full size) */
+constexpr uint8_t MULTI_RADIO_FRAME_SIZE = 32;
+
+typedef struct MultiRadioFrame {
+    uint8_t radio;              /* index of the radio in the array given to begin() */
+    uint32_t arrival;           /* MCU time (us, micros()) of the frame, used for ordering */
+    uint64_t timestamp;         /* RX timestamp, in the time base of the radio that received it */
+    float firstPathPower;       /* dBm */
+    uint16_t length;
+    byte data[MULTI_RADIO_FRAME_SIZE];
+} MultiRadioFrame;
+
+namespace DW1000NgMultiRadio {
+    /**
+    Starts the anchor mode: every radio gets the receive handlers of this module and its receiver armed.
+    Radios must already be initialized with an interrupt pin and configured (see DW1000Ng::initialize(DW1000NgDevice&, ...)),
+    with at least the receive, receive failed and receive timeout interrupts enabled.
+    Receivers are re-armed right after each event, from the interrupt handler.
+
+    @param [in] radios the devices, their index is the radio number reported in MultiRadioFrame
+    @param [in] count number of devices (at most DW1000NG_MAX_DEVICES)
+    */
+    void begin(DW1000NgDevice* radios[], uint8_t count);
+
+    /**
+    Detaches the handlers and turns off the receivers. Frames still queued can be read.
+    */
+    void end();
+
+    /**
+    returns the number of frames waiting to be read
+    */
+    uint8_t available();
+
+    /**
+    Pops the oldest frame of the merged stream.
+    Frames are ordered by their estimated arrival time: the age of the frame is measured on the radio
+    that received it (system time - RX timestamp), so frames of radios serviced later in the same
+    interrupt keep their real order regardless of the radio clocks.
+
+    @param [out] frame the oldest frame
+
+    returns false if no frame is available
+    */
+    boolean read(MultiRadioFrame& frame);
+
+    /**
+    returns the number of frames dropped because the queue was full, since begin()
+    */
+    uint16_t getDroppedFrames();
+}
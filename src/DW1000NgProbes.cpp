@@ -0,0 +1,191 @@
+/*
+ * MIT License
+ * 
+ * Copyright (c) 2018 Michele Biondi, Andrea Salvatori
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+*/
+
+#include "DW1000NgProbes.hpp"
+
+#if DW1000NG_PROBES
+
+namespace DW1000NgProbes {
+
+    namespace {
+        probe_histogram_t _histograms[PROBE_POINTS];
+        volatile uint32_t _reference = 0;
+
+        const char* const _names[PROBE_POINTS] = {
+            "isr", "status read", "frame read", "timestamp read", "tx buffer write", "start transmit"
+        };
+
+        /* durations past 4.29 s (e.g. polling, one blink after the last mark) must land in the overflow bin */
+        inline uint32_t _saturate(uint64_t nanoseconds) {
+            return nanoseconds > UINT32_MAX ? UINT32_MAX : static_cast<uint32_t>(nanoseconds);
+        }
+
+        /* time source: cycle counter when available, micros() otherwise */
+        #if defined(ESP32) || defined(ESP8266)
+            inline uint32_t _ticks() {
+                return ESP.getCycleCount();
+            }
+
+            void _startCounter() { }
+
+            inline uint32_t _ticksToNanoseconds(uint32_t ticks) {
+                return _saturate(static_cast<uint64_t>(ticks) * 1000 / ESP.getCpuFreqMHz());
+            }
+        #elif (defined(__ARM_ARCH_7M__) || defined(__ARM_ARCH_7EM__)) && defined(F_CPU)
+            /* Cortex-M3/M4/M7 DWT cycle counter */
+            volatile uint32_t* const DEMCR = reinterpret_cast<volatile uint32_t*>(0xE000EDFC);
+            volatile uint32_t* const DWT_CTRL = reinterpret_cast<volatile uint32_t*>(0xE0001000);
+            volatile uint32_t* const DWT_CYCCNT = reinterpret_cast<volatile uint32_t*>(0xE0001004);
+
+            inline uint32_t _ticks() {
+                return *DWT_CYCCNT;
+            }
+
+            void _startCounter() {
+                *DEMCR |= 0x01000000; // TRCENA
+                *DWT_CTRL |= 0x00000001; // CYCCNTENA
+            }
+
+            inline uint32_t _ticksToNanoseconds(uint32_t ticks) {
+                return _saturate(static_cast<uint64_t>(ticks) * 1000 / (F_CPU / 1000000));
+            }
+        #else
+            inline uint32_t _ticks() {
+                return micros();
+            }
+
+            void _startCounter() { }
+
+            inline uint32_t _ticksToNanoseconds(uint32_t ticks) {
+                return ticks > UINT32_MAX / 1000 ? UINT32_MAX : ticks * 1000;
+            }
+        #endif
+
+        boolean _counterStarted = false;
+    }
+
+#if defined(ESP8266)
+    void ICACHE_RAM_ATTR mark() {
+#else
+    void mark() {
+#endif
+        if(!_counterStarted) {
+            _startCounter();
+            _counterStarted = true;
+        }
+        _reference = _ticks();
+    }
+
+#if defined(ESP8266)
+    void ICACHE_RAM_ATTR record(ProbePoint point) {
+#else
+    void record(ProbePoint point) {
+#endif
+        uint32_t nanoseconds = _ticksToNanoseconds(_ticks() - _reference);
+        uint32_t bin = nanoseconds / (1000UL * DW1000NG_PROBE_BIN_WIDTH);
+        if(bin >= DW1000NG_PROBE_BINS)
+            bin = DW1000NG_PROBE_BINS - 1;
+
+        /* also called from the interrupt handler, which must not see or make a half updated histogram.
+           On AVR the handler runs with interrupts disabled, so their state is restored */
+        #if defined(__AVR__)
+        uint8_t sreg = SREG;
+        #endif
+        noInterrupts();
+        probe_histogram_t& histogram = _histograms[static_cast<uint8_t>(point)];
+        if(histogram.count == 0 || nanoseconds < histogram.minimum)
+            histogram.minimum = nanoseconds;
+        if(nanoseconds > histogram.maximum)
+            histogram.maximum = nanoseconds;
+        histogram.count++;
+        histogram.total += nanoseconds;
+        if(histogram.bins[bin] < UINT16_MAX)
+            histogram.bins[bin]++;
+        #if defined(__AVR__)
+        SREG = sreg;
+        #else
+        interrupts();
+        #endif
+    }
+
+    void reset() {
+        noInterrupts();
+        memset(_histograms, 0, sizeof(_histograms));
+        interrupts();
+    }
+
+    void getHistogram(ProbePoint point, probe_histogram_t& histogram) {
+        noInterrupts();
+        histogram = _histograms[static_cast<uint8_t>(point)];
+        interrupts();
+    }
+
+    uint32_t getPercentile(ProbePoint point, uint8_t percent) {
+        probe_histogram_t histogram;
+        getHistogram(point, histogram);
+
+        uint32_t samples = 0;
+        for(uint8_t i = 0; i < DW1000NG_PROBE_BINS; i++)
+            samples += histogram.bins[i];
+        if(samples == 0)
+            return 0;
+
+        uint32_t target = (samples * percent + 99) / 100;
+        uint32_t cumulated = 0;
+        for(uint8_t i = 0; i < DW1000NG_PROBE_BINS - 1; i++) {
+            cumulated += histogram.bins[i];
+            if(cumulated >= target)
+                return static_cast<uint32_t>(i + 1) * DW1000NG_PROBE_BIN_WIDTH;
+        }
+        return (histogram.maximum + 999) / 1000;
+    }
+
+    void printHistograms(Print& out) {
+        for(uint8_t point = 0; point < PROBE_POINTS; point++) {
+            probe_histogram_t histogram;
+            getHistogram(static_cast<ProbePoint>(point), histogram);
+            if(histogram.count == 0)
+                continue;
+
+            out.print(_names[point]); out.print(": "); out.print(histogram.count);
+            out.print(" samples, min "); out.print(histogram.minimum / 1000.0, 3);
+            out.print(" us, mean "); out.print(histogram.total / histogram.count / 1000.0, 3);
+            out.print(" us, max "); out.print(histogram.maximum / 1000.0, 3); out.println(" us");
+            for(uint8_t i = 0; i < DW1000NG_PROBE_BINS; i++) {
+                if(histogram.bins[i] == 0)
+                    continue;
+                out.print("  "); out.print(i * DW1000NG_PROBE_BIN_WIDTH);
+                if(i == DW1000NG_PROBE_BINS - 1) {
+                    out.print("+ us: ");
+                } else {
+                    out.print("-"); out.print((i + 1) * DW1000NG_PROBE_BIN_WIDTH); out.print(" us: ");
+                }
+                out.println(histogram.bins[i]);
+            }
+        }
+    }
+
+}
+
+#endif
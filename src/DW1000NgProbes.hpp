@@ -0,0 +1,103 @@
+/*
+ * MIT License
+ * 
+ * Copyright (c) 2018 Michele Biondi, Andrea Salvatori
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+*/
+
+#pragma once
+
+#include <Arduino.h>
+#include "DW1000NgCompileOptions.hpp"
+
+/* Probe points of the driver hot path. Each one records the time elapsed since the last reference mark:
+ * the start of the interrupt handler, or in polling mode the status read that reported the event */
+enum class ProbePoint : byte {
+    ISR,                /* end of the interrupt handler, user callbacks included */
+    STATUS_READ,        /* status register read in the interrupt handler */
+    FRAME_READ,         /* received frame read (getReceivedData) */
+    TIMESTAMP_READ,     /* receive timestamp read (getReceiveTimestamp) */
+    TX_BUFFER_WRITE,    /* frame written to the transmit buffer (setTransmitData) */
+    START_TRANSMIT      /* transmission started (startTransmit) */
+};
+
+constexpr uint8_t PROBE_POINTS = 6;
+
+typedef struct probe_histogram_t {
+    uint32_t count;
+    uint32_t minimum;       /* ns */
+    uint32_t maximum;       /* ns */
+    uint64_t total;         /* ns, total/count is the mean */
+    uint16_t bins[DW1000NG_PROBE_BINS]; /* DW1000NG_PROBE_BIN_WIDTH us each, the last one also counts everything above */
+} probe_histogram_t;
+
+#if DW1000NG_PROBES
+    #define DW1000NG_PROBE_MARK() DW1000NgProbes::mark()
+    #define DW1000NG_PROBE(point) DW1000NgProbes::record(point)
+#else
+    #define DW1000NG_PROBE_MARK()
+    #define DW1000NG_PROBE(point)
+#endif
+
+namespace DW1000NgProbes {
+    /**
+    Sets the reference of the following probes to now.
+    Called by the driver at the start of the interrupt handler and when isReceiveDone() or isTransmitDone() return true,
+    call it from the sketch to measure from another point.
+    */
+    void mark();
+
+    /**
+    Adds the time elapsed since the last mark() to the histogram of a probe point.
+
+    @param [in] point the probe point
+    */
+    void record(ProbePoint point);
+
+    /**
+    Empties all the histograms.
+    */
+    void reset();
+
+    /**
+    Copies the histogram of a probe point.
+
+    @param [in] point the probe point
+    @param [out] histogram the histogram
+    */
+    void getHistogram(ProbePoint point, probe_histogram_t& histogram);
+
+    /**
+    returns the upper edge (us) of the bin containing the given percentile of the samples of a probe point,
+    the maximum when it falls in the last bin, 0 without samples.
+    e.g. getPercentile(ProbePoint::START_TRANSMIT, 99) bounds the reply delay of 99% of the responses
+
+    @param [in] point the probe point
+    @param [in] percent 0 to 100
+    */
+    uint32_t getPercentile(ProbePoint point, uint8_t percent);
+
+    /**
+    Prints count, min, mean, max and the non empty bins of every probe point.
+
+    @param [in] out where to print, usually Serial
+    */
+    void printHistograms(Print& out);
+}
@@ -28,8 +28,23 @@
 #include "DW1000NgUtils.hpp"
 #include "DW1000NgTime.hpp"
 #include "DW1000NgRanging.hpp"
+#include "DW1000NgFrame.hpp"
 
 static byte SEQ_NUMBER = 0;
+/* shared by all the devices (see DW1000Ng::select()) */
+static uint16_t REPLY_DELAY = 1500;
+
+/* Lower bound and resolution (us) of the reply delay search, the upper bound is REPLY_DELAY_LIMIT */
+constexpr uint16_t REPLY_DELAY_MIN = 50;
+constexpr uint16_t REPLY_DELAY_RESOLUTION = 10;
+/* Every trial at a given delay must succeed */
+constexpr uint8_t REPLY_DELAY_TRIALS = 8;
+
+/* Offsets of the source address and of the payload in the received frames */
+constexpr uint8_t SOURCE = DW1000NgFrame::source<SHORT_SRC_AND_DEST>();
+constexpr uint8_t PAYLOAD = DW1000NgFrame::headerLength<SHORT_SRC_AND_DEST>();
+constexpr uint8_t INITIATION_SOURCE = DW1000NgFrame::source<SHORT_SRC_LONG_DEST>();
+constexpr uint8_t INITIATION_PAYLOAD = DW1000NgFrame::headerLength<SHORT_SRC_LONG_DEST>();
 
 namespace DW1000NgRTLS {
 
@@ -37,88 +52,78 @@ namespace DW1000NgRTLS {
         return ++SEQ_NUMBER;
     }
 
+    byte getSequenceNumber() {
+        return SEQ_NUMBER;
+    }
+
     void transmitTwrShortBlink() {
-        byte Blink[] = {BLINK, SEQ_NUMBER++, 0,0,0,0,0,0,0,0, NO_BATTERY_STATUS | NO_EX_ID, TAG_LISTENING_NOW};
-        DW1000Ng::getEUI(&Blink[2]);
-        DW1000Ng::setTransmitData(Blink, sizeof(Blink));
-        DW1000Ng::startTransmit();
+        DW1000NgFrame::BlinkFrame<2> blink(SEQ_NUMBER++);
+        blink.payload()[0] = NO_BATTERY_STATUS | NO_EX_ID;
+        blink.payload()[1] = TAG_LISTENING_NOW;
+        blink.transmit();
     }
 
     void transmitRangingInitiation(byte tag_eui[], byte tag_short_address[]) {
-        byte RangingInitiation[] = {DATA, SHORT_SRC_LONG_DEST, SEQ_NUMBER++, 0,0, 0,0,0,0,0,0,0,0,  0,0, RANGING_INITIATION, 0,0};
-        DW1000Ng::getNetworkId(&RangingInitiation[3]);
-        memcpy(&RangingInitiation[5], tag_eui, 8);
-        DW1000Ng::getDeviceAddress(&RangingInitiation[13]);
-        memcpy(&RangingInitiation[16], tag_short_address, 2);
-        DW1000Ng::setTransmitData(RangingInitiation, sizeof(RangingInitiation));
-        DW1000Ng::startTransmit();
+        DW1000NgFrame::DataFrame<SHORT_SRC_LONG_DEST, 3> rangingInitiation(SEQ_NUMBER++, tag_eui);
+        rangingInitiation.payload()[0] = RANGING_INITIATION;
+        memcpy(&rangingInitiation.payload()[1], tag_short_address, 2);
+        rangingInitiation.transmit();
     }
 
     void transmitPoll(byte anchor_address[]){
-        byte Poll[] = {DATA, SHORT_SRC_AND_DEST, SEQ_NUMBER++, 0,0, 0,0, 0,0 , RANGING_TAG_POLL};
-        DW1000Ng::getNetworkId(&Poll[3]);
-        memcpy(&Poll[5], anchor_address, 2);
-        DW1000Ng::getDeviceAddress(&Poll[7]);
-        DW1000Ng::setTransmitData(Poll, sizeof(Poll));
-        DW1000Ng::startTransmit();
+        DW1000NgFrame::DataFrame<SHORT_SRC_AND_DEST, 1> poll(SEQ_NUMBER++, anchor_address);
+        poll.payload()[0] = RANGING_TAG_POLL;
+        poll.transmit();
     }
 
     void transmitResponseToPoll(byte tag_short_address[]) {
-        byte pollAck[] = {DATA, SHORT_SRC_AND_DEST, SEQ_NUMBER++, 0,0, 0,0, 0,0, ACTIVITY_CONTROL, RANGING_CONTINUE, 0, 0};
-        DW1000Ng::getNetworkId(&pollAck[3]);
-        memcpy(&pollAck[5], tag_short_address, 2);
-        DW1000Ng::getDeviceAddress(&pollAck[7]);
-        DW1000Ng::setTransmitData(pollAck, sizeof(pollAck));
-        DW1000Ng::startTransmit();
+        DW1000NgFrame::DataFrame<SHORT_SRC_AND_DEST, 4> pollAck(SEQ_NUMBER++, tag_short_address);
+        pollAck.payload()[0] = ACTIVITY_CONTROL;
+        pollAck.payload()[1] = RANGING_CONTINUE;
+        pollAck.payload()[2] = 0;
+        pollAck.payload()[3] = 0;
+        pollAck.transmit();
     }
 
-    void transmitFinalMessage(byte anchor_address[], uint16_t reply_delay, uint64_t timePollSent, uint64_t timeResponseToPollReceived) {
-        /* Calculation of future time */
-        byte futureTimeBytes[LENGTH_TIMESTAMP];
-
-	    uint64_t timeFinalMessageSent = DW1000Ng::getSystemTimestamp();
-	    timeFinalMessageSent += DW1000NgTime::microsecondsToUWBTime(reply_delay);
-        DW1000NgUtils::writeValueToBytes(futureTimeBytes, timeFinalMessageSent, LENGTH_TIMESTAMP);
-        DW1000Ng::setDelayedTRX(futureTimeBytes);
-        timeFinalMessageSent += DW1000Ng::getTxAntennaDelay();
-
-        byte finalMessage[] = {DATA, SHORT_SRC_AND_DEST, SEQ_NUMBER++, 0,0, 0,0, 0,0, RANGING_TAG_FINAL_RESPONSE_EMBEDDED, 
-            0,0,0,0,0,0,0,0,0,0,0,0
-        };
-
-        DW1000Ng::getNetworkId(&finalMessage[3]);
-        memcpy(&finalMessage[5], anchor_address, 2);
-        DW1000Ng::getDeviceAddress(&finalMessage[7]);
-
-        DW1000NgUtils::writeValueToBytes(finalMessage + 10, (uint32_t) timePollSent, 4);
-        DW1000NgUtils::writeValueToBytes(finalMessage + 14, (uint32_t) timeResponseToPollReceived, 4);
-        DW1000NgUtils::writeValueToBytes(finalMessage + 18, (uint32_t) timeFinalMessageSent, 4);
-        DW1000Ng::setTransmitData(finalMessage, sizeof(finalMessage));
-        DW1000Ng::startTransmit(TransmitMode::DELAYED);
+    static boolean transmitFinalMessage(byte functionCode, byte sequenceNumber, byte anchor_address[], uint16_t reply_delay, uint64_t timePollSent, uint64_t timeResponseToPollReceived) {
+        /* Calculation of future time, the device tells us the exact timestamp it will use */
+        uint64_t timeFinalMessageSent = DW1000Ng::setDelayedTransmitTime(
+            DW1000Ng::getSystemTimestamp() + DW1000NgTime::microsecondsToUWBTime(reply_delay)
+        );
+
+        DW1000NgFrame::DataFrame<SHORT_SRC_AND_DEST, 13> finalMessage(sequenceNumber, anchor_address);
+        byte* payload = finalMessage.payload();
+        payload[0] = functionCode;
+        DW1000NgUtils::writeValueToBytes(payload + 1, (uint32_t) timePollSent, 4);
+        DW1000NgUtils::writeValueToBytes(payload + 5, (uint32_t) timeResponseToPollReceived, 4);
+        DW1000NgUtils::writeValueToBytes(payload + 9, (uint32_t) timeFinalMessageSent, 4);
+        return finalMessage.transmit(TransmitMode::DELAYED);
+    }
+
+    boolean transmitFinalMessage(byte anchor_address[], uint16_t reply_delay, uint64_t timePollSent, uint64_t timeResponseToPollReceived) {
+        return transmitFinalMessage(RANGING_TAG_FINAL_RESPONSE_EMBEDDED, SEQ_NUMBER++, anchor_address, reply_delay, timePollSent, timeResponseToPollReceived);
     }
 
     void transmitRangingConfirm(byte tag_short_address[], byte next_anchor[]) {
-        byte rangingConfirm[] = {DATA, SHORT_SRC_AND_DEST, SEQ_NUMBER++, 0,0, 0,0, 0,0, ACTIVITY_CONTROL, RANGING_CONFIRM, next_anchor[0], next_anchor[1]};
-        DW1000Ng::getNetworkId(&rangingConfirm[3]);
-        memcpy(&rangingConfirm[5], tag_short_address, 2);
-        DW1000Ng::getDeviceAddress(&rangingConfirm[7]);
-        DW1000Ng::setTransmitData(rangingConfirm, sizeof(rangingConfirm));
-        DW1000Ng::startTransmit();
+        DW1000NgFrame::DataFrame<SHORT_SRC_AND_DEST, 4> rangingConfirm(SEQ_NUMBER++, tag_short_address);
+        rangingConfirm.payload()[0] = ACTIVITY_CONTROL;
+        rangingConfirm.payload()[1] = RANGING_CONFIRM;
+        memcpy(&rangingConfirm.payload()[2], next_anchor, 2);
+        rangingConfirm.transmit();
     }
 
     void transmitActivityFinished(byte tag_short_address[], byte blink_rate[]) {
         /* I send the new blink rate to the tag */
-        byte rangingConfirm[] = {DATA, SHORT_SRC_AND_DEST, SEQ_NUMBER++, 0,0, 0,0, 0,0, ACTIVITY_CONTROL, ACTIVITY_FINISHED, blink_rate[0], blink_rate[1]};
-        DW1000Ng::getNetworkId(&rangingConfirm[3]);
-        memcpy(&rangingConfirm[5], tag_short_address, 2);
-        DW1000Ng::getDeviceAddress(&rangingConfirm[7]);
-        DW1000Ng::setTransmitData(rangingConfirm, sizeof(rangingConfirm));
-        DW1000Ng::startTransmit();
+        DW1000NgFrame::DataFrame<SHORT_SRC_AND_DEST, 4> activityFinished(SEQ_NUMBER++, tag_short_address);
+        activityFinished.payload()[0] = ACTIVITY_CONTROL;
+        activityFinished.payload()[1] = ACTIVITY_FINISHED;
+        memcpy(&activityFinished.payload()[2], blink_rate, 2);
+        activityFinished.transmit();
     }
 
     static uint32_t calculateNewBlinkRate(byte frame[]) {
-        uint32_t blinkRate = frame[11] + static_cast<uint32_t>(((frame[12] & 0x3F) << 8));
-        byte multiplier = ((frame[12] & 0xC0) >> 6);
+        uint32_t blinkRate = frame[PAYLOAD + 2] + static_cast<uint32_t>(((frame[PAYLOAD + 3] & 0x3F) << 8));
+        byte multiplier = ((frame[PAYLOAD + 3] & 0xC0) >> 6);
         if(multiplier  == 0x01) {
             blinkRate *= 25;
         } else if(multiplier == 0x02) {
@@ -167,12 +172,12 @@ namespace DW1000NgRTLS {
         byte init_recv[init_len];
         DW1000Ng::getReceivedData(init_recv, init_len);
 
-        if(!(init_len > 17 && init_recv[15] == RANGING_INITIATION)) {
+        if(!(init_len > INITIATION_PAYLOAD + 2 && init_recv[INITIATION_PAYLOAD] == RANGING_INITIATION)) {
             return { false, 0};
         }
 
-        DW1000Ng::setDeviceAddress(DW1000NgUtils::bytesAsValue(&init_recv[16], 2));
-        return { true, static_cast<uint16_t>(DW1000NgUtils::bytesAsValue(&init_recv[13], 2)) };
+        DW1000Ng::setDeviceAddress(DW1000NgUtils::bytesAsValue(&init_recv[INITIATION_PAYLOAD + 1], 2));
+        return { true, static_cast<uint16_t>(DW1000NgUtils::bytesAsValue(&init_recv[INITIATION_SOURCE], 2)) };
     }
 
     static RangeResult tagFinishRange(uint16_t anchor, uint16_t replyDelayUs) {
@@ -190,16 +195,17 @@ namespace DW1000NgRTLS {
             byte cont_recv[cont_len];
             DW1000Ng::getReceivedData(cont_recv, cont_len);
 
-            if (cont_len > 10 && cont_recv[9] == ACTIVITY_CONTROL && cont_recv[10] == RANGING_CONTINUE) {
+            if (cont_len > PAYLOAD + 1 && cont_recv[PAYLOAD] == ACTIVITY_CONTROL && cont_recv[PAYLOAD + 1] == RANGING_CONTINUE) {
                 /* Received Response to poll */
-                DW1000NgRTLS::transmitFinalMessage(
-                    &cont_recv[7], 
+                boolean finalMessageSent = DW1000NgRTLS::transmitFinalMessage(
+                    &cont_recv[SOURCE], 
                     replyDelayUs, 
                     DW1000Ng::getTransmitTimestamp(), // Poll transmit time
                     DW1000Ng::getReceiveTimestamp()  // Response to poll receive time
                 );
 
-                if(!DW1000NgRTLS::waitForNextRangingStep()) {
+                /* reply delay too short for this device */
+                if(!finalMessageSent || !DW1000NgRTLS::waitForNextRangingStep()) {
                     returnValue = {false, false, 0, 0};
                 } else {
 
@@ -207,10 +213,10 @@ namespace DW1000NgRTLS {
                     byte act_recv[act_len];
                     DW1000Ng::getReceivedData(act_recv, act_len);
 
-                    if(act_len > 10 && act_recv[9] == ACTIVITY_CONTROL) {
-                        if (act_len > 12 && act_recv[10] == RANGING_CONFIRM) {
-                            returnValue = {true, true, static_cast<uint16_t>(DW1000NgUtils::bytesAsValue(&act_recv[11], 2)), 0};
-                        } else if(act_len > 12 && act_recv[10] == ACTIVITY_FINISHED) {
+                    if(act_len > PAYLOAD + 1 && act_recv[PAYLOAD] == ACTIVITY_CONTROL) {
+                        if (act_len > PAYLOAD + 3 && act_recv[PAYLOAD + 1] == RANGING_CONFIRM) {
+                            returnValue = {true, true, static_cast<uint16_t>(DW1000NgUtils::bytesAsValue(&act_recv[PAYLOAD + 2], 2)), 0};
+                        } else if(act_len > PAYLOAD + 3 && act_recv[PAYLOAD + 1] == ACTIVITY_FINISHED) {
                             returnValue = {true, false, 0, calculateNewBlinkRate(act_recv)};
                         }
                     } else {
@@ -269,6 +275,61 @@ namespace DW1000NgRTLS {
         return returnValue;
     }
 
+    RangeInfrastructureResult tagRangeInfrastructure(uint16_t target_anchor) {
+        return tagRangeInfrastructure(target_anchor, REPLY_DELAY);
+    }
+
+    RangeInfrastructureResult tagTwrLocalize() {
+        return tagTwrLocalize(REPLY_DELAY);
+    }
+
+    /* Schedules final messages as the tag does, each one is aborted once the late check passed.
+       If the preamble already started, what reaches the air is a probe no node parses; the sequence number does not move */
+    static boolean tryReplyDelay(uint16_t replyDelay) {
+        byte broadcast[] = {0xFF, 0xFF};
+        for(uint8_t i = 0; i < REPLY_DELAY_TRIALS; i++) {
+            boolean onTime = transmitFinalMessage(REPLY_DELAY_PROBE, SEQ_NUMBER, broadcast, replyDelay, 0, 0);
+            DW1000Ng::forceTRxOff();
+            if(!onTime)
+                return false;
+        }
+        return true;
+    }
+
+    uint16_t calibrateReplyDelay(uint8_t marginPercent) {
+        uint16_t low = REPLY_DELAY_MIN;
+        uint16_t high = REPLY_DELAY_LIMIT;
+
+        if(tryReplyDelay(low)) {
+            high = low;
+        } else if(!tryReplyDelay(high)) {
+            /* Too slow for the anchors (or something is wrong with the device), keep the current value */
+            return 0;
+        }
+
+        /* low always fails, high always succeeds */
+        while(high - low > REPLY_DELAY_RESOLUTION) {
+            uint16_t middle = low + (high - low) / 2;
+            if(tryReplyDelay(middle)) {
+                high = middle;
+            } else {
+                low = middle;
+            }
+        }
+
+        uint32_t replyDelay = high + (static_cast<uint32_t>(high) * marginPercent) / 100;
+        REPLY_DELAY = replyDelay > REPLY_DELAY_LIMIT ? REPLY_DELAY_LIMIT : static_cast<uint16_t>(replyDelay);
+        return REPLY_DELAY;
+    }
+
+    void setReplyDelay(uint16_t replyDelay) {
+        REPLY_DELAY = replyDelay;
+    }
+
+    uint16_t getReplyDelay() {
+        return REPLY_DELAY;
+    }
+
     RangeInfrastructureResult tagTwrLocalize(uint16_t finalMessageDelay) {
         RangeRequestResult request_result = DW1000NgRTLS::tagRangeRequest();
 
@@ -283,7 +344,7 @@ namespace DW1000NgRTLS {
     }
 
     RangeAcceptResult anchorRangeAccept(NextActivity next, uint16_t value) {
-        RangeAcceptResult returnValue;
+        RangeAcceptResult returnValue = {false, 0};
 
         double range;
         if(!DW1000NgRTLS::receiveFrame()) {
@@ -294,12 +355,11 @@ namespace DW1000NgRTLS {
             byte poll_data[poll_len];
             DW1000Ng::getReceivedData(poll_data, poll_len);
 
-            if(poll_len > 9 && poll_data[9] == RANGING_TAG_POLL) {
+            if(poll_len > PAYLOAD && poll_data[PAYLOAD] == RANGING_TAG_POLL) {
                 uint64_t timePollReceived = DW1000Ng::getReceiveTimestamp();
-                DW1000NgRTLS::transmitResponseToPoll(&poll_data[7]);
+                DW1000NgRTLS::transmitResponseToPoll(&poll_data[SOURCE]);
                 DW1000NgRTLS::waitForTransmission();
                 uint64_t timeResponseToPoll = DW1000Ng::getTransmitTimestamp();
-                delayMicroseconds(1500);
 
                 if(!DW1000NgRTLS::receiveFrame()) {
                     returnValue = {false, 0};
@@ -308,30 +368,31 @@ namespace DW1000NgRTLS {
                     size_t rfinal_len = DW1000Ng::getReceivedDataLength();
                     byte rfinal_data[rfinal_len];
                     DW1000Ng::getReceivedData(rfinal_data, rfinal_len);
-                    if(rfinal_len > 18 && rfinal_data[9] == RANGING_TAG_FINAL_RESPONSE_EMBEDDED) {
+                    if(rfinal_len > PAYLOAD + 9 && rfinal_data[PAYLOAD] == RANGING_TAG_FINAL_RESPONSE_EMBEDDED) {
                         uint64_t timeFinalMessageReceive = DW1000Ng::getReceiveTimestamp();
+                        float rxPower = DW1000Ng::getReceivePower();
 
                         byte finishValue[2];
                         DW1000NgUtils::writeValueToBytes(finishValue, value, 2);
 
                         if(next == NextActivity::RANGING_CONFIRM) {
-                            DW1000NgRTLS::transmitRangingConfirm(&rfinal_data[7], finishValue);
+                            DW1000NgRTLS::transmitRangingConfirm(&rfinal_data[SOURCE], finishValue);
                         } else {
-                            DW1000NgRTLS::transmitActivityFinished(&rfinal_data[7], finishValue);
+                            DW1000NgRTLS::transmitActivityFinished(&rfinal_data[SOURCE], finishValue);
                         }
                         
                         DW1000NgRTLS::waitForTransmission();
 
                         range = DW1000NgRanging::computeRangeAsymmetric(
-                            DW1000NgUtils::bytesAsValue(rfinal_data + 10, LENGTH_TIMESTAMP), // Poll send time
+                            DW1000NgUtils::bytesAsValue(rfinal_data + PAYLOAD + 1, LENGTH_TIMESTAMP), // Poll send time
                             timePollReceived, 
                             timeResponseToPoll, // Response to poll sent time
-                            DW1000NgUtils::bytesAsValue(rfinal_data + 14, LENGTH_TIMESTAMP), // Response to Poll Received
-                            DW1000NgUtils::bytesAsValue(rfinal_data + 18, LENGTH_TIMESTAMP), // Final Message send time
+                            DW1000NgUtils::bytesAsValue(rfinal_data + PAYLOAD + 5, LENGTH_TIMESTAMP), // Response to Poll Received
+                            DW1000NgUtils::bytesAsValue(rfinal_data + PAYLOAD + 9, LENGTH_TIMESTAMP), // Final Message send time
                             timeFinalMessageReceive // Final message receive time
                         );
 
-                        range = DW1000NgRanging::correctRange(range);
+                        range = DW1000NgRanging::correctRange(range, rxPower);
 
                         /* In case of wrong read due to bad device calibration */
                         if(range <= 0) 
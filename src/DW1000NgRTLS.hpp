@@ -33,6 +33,8 @@ constexpr byte SHORT_SRC_AND_DEST = 0x88;
 constexpr byte LONG_SRC_AND_DEST = 0xCC;
 constexpr byte SHORT_SRC_LONG_DEST = 0x8C;
 constexpr byte LONG_SRC_SHORT_DEST = 0xC8;
+constexpr byte ACKNOWLEDGEMENT = 0x02;
+constexpr byte ACK_REQUEST = 0x20; /* bit of the first byte */
 
 /* Application ID */
 constexpr byte RTLS_APP_ID_LOW = 0x9A;
@@ -46,6 +48,11 @@ constexpr byte RANGING_TAG_POLL = 0x21;
 constexpr byte RANGING_TAG_FINAL_RESPONSE_EMBEDDED = 0x23;
 constexpr byte RANGING_TAG_FINAL_RESPONSE_NO_EMBEDDED = 0x25;
 constexpr byte RANGING_TAG_FINAL_SEND_TIME = 0x27;
+/* Final message scheduled by DW1000NgRTLS::calibrateReplyDelay(), parsed by no node */
+constexpr byte REPLY_DELAY_PROBE = 0x2F;
+
+/* Longest reply delay (us) DW1000NgRTLS::calibrateReplyDelay() accepts, anchors wait this long for the final message */
+constexpr uint16_t REPLY_DELAY_LIMIT = 2000;
 
 /* Activity code */
 constexpr byte ACTIVITY_FINISHED = 0x00;
@@ -97,11 +104,12 @@ typedef struct RangeAcceptResult {
 namespace DW1000NgRTLS {
     /*** TWR functions used in ISO/IEC 24730-62:2013, refer to the standard or the decawave manual for details about TWR ***/
     byte increaseSequenceNumber();
+    byte getSequenceNumber(); /* sequence number of the next frame, e.g. of the next blink */
     void transmitTwrShortBlink();
     void transmitRangingInitiation(byte tag_eui[], byte tag_short_address[]);
     void transmitPoll(byte anchor_address[]);
     void transmitResponseToPoll(byte tag_short_address[]);
-    void transmitFinalMessage(byte anchor_address[], uint16_t reply_delay, uint64_t timePollSent, uint64_t timeResponseToPollReceived);
+    boolean transmitFinalMessage(byte anchor_address[], uint16_t reply_delay, uint64_t timePollSent, uint64_t timeResponseToPollReceived);
     void transmitRangingConfirm(byte tag_short_address[], byte next_anchor[]);
     void transmitActivityFinished(byte tag_short_address[], byte blink_rate[]);
     
@@ -116,6 +124,8 @@ namespace DW1000NgRTLS {
        NextActivity is used to indicate the tag what to do next after the ranging process (Activity finished is to return to blink (range request), 
         Continue range is to tell the tag to range a new anchor)
        value is the value relative to the next activity (Activity finished = new blink rante, continue range = new anchor address)
+       The anchor listens for the final message right after the response to poll, so the receive frame wait
+        timeout must be longer than the reply delay used by the tags.
     */
     RangeAcceptResult anchorRangeAccept(NextActivity next, uint16_t value);
 
@@ -126,8 +136,34 @@ namespace DW1000NgRTLS {
     */
     RangeInfrastructureResult tagRangeInfrastructure(uint16_t target_anchor, uint16_t finalMessageDelay);
 
+    /* Same as above, using the reply delay found by calibrateReplyDelay (or set by setReplyDelay) */
+    RangeInfrastructureResult tagRangeInfrastructure(uint16_t target_anchor);
+
     /* Can be used as a single function start the localization process from the tag.
         Finalmessagedelay is the same as in function tagRangeInfrastructure
     */
     RangeInfrastructureResult tagTwrLocalize(uint16_t finalMessageDelay);
+
+    /* Same as above, using the reply delay found by calibrateReplyDelay (or set by setReplyDelay) */
+    RangeInfrastructureResult tagTwrLocalize();
+
+    /* Finds the smallest reply delay (us) at which this device can still schedule the final message.
+        The search (binary) schedules final messages and checks whether the delayed transmission
+        was late (HPDWARN) or fell into the transmitter power-up (TXPUTE); each one is aborted right
+        after the check, so at most the start of a REPLY_DELAY_PROBE frame reaches the air.
+        Run it after applying the configuration, the transceiver is off at the end.
+        marginPercent is added on top of the minimum found to absorb jitter (interrupts, SPI contention),
+        the result is capped at REPLY_DELAY_LIMIT.
+        The result is stored and used by tagRangeInfrastructure/tagTwrLocalize without the delay argument.
+        There is a single stored reply delay, shared by all the devices (see DW1000Ng::select()).
+        Returns 0 and keeps the stored value if even REPLY_DELAY_LIMIT is too short for this device:
+        anchors waiting REPLY_DELAY_LIMIT would miss every final message.
+    */
+    uint16_t calibrateReplyDelay(uint8_t marginPercent = 20);
+
+    /* Sets the stored reply delay (us), default is 1500. Above REPLY_DELAY_LIMIT the anchors of the examples miss the final message */
+    void setReplyDelay(uint16_t replyDelay);
+
+    /* Gets the stored reply delay (us) */
+    uint16_t getReplyDelay();
 }
\ No newline at end of file
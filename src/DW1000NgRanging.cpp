@@ -26,11 +26,147 @@
 #include "DW1000Ng.hpp"
 #include "DW1000NgConstants.hpp"
 #include "DW1000NgRanging.hpp"
-#include "DW1000NgConstants.hpp"
 #include "DW1000NgRTLS.hpp"
+#include "DW1000NgAirtime.hpp"
 
 namespace DW1000NgRanging {
 
+    /* anonymous namespace to host private-like variables and methods */
+    namespace {
+
+        /* one entry per dB, linearly interpolated from the sparse bias table */
+        constexpr uint8_t BIAS_DENSE_TABLE_SIZE = 64;
+
+        /* APS006 part 3 thresholds on receive power - first path power */
+        constexpr float LOS_POWER_DIFFERENCE = 6.0f;
+        constexpr float NLOS_POWER_DIFFERENCE = 10.0f;
+        /* strongest path more than this many samples after the first path: multipath or blocked direct path */
+        constexpr uint8_t LOS_PEAK_DELAY = 1;
+        constexpr uint8_t NLOS_PEAK_DELAY = 5;
+        /* range standard deviations, meters */
+        constexpr float LOS_RANGE_SIGMA = 0.1f;
+        constexpr float NLOS_RANGE_SIGMA = 0.5f;
+        /* below this receive quality the first path is close to the noise floor */
+        constexpr float GOOD_RECEIVE_QUALITY = 6.0f;
+        constexpr uint8_t CIR_WINDOW_BEFORE = 2;
+        constexpr uint8_t CIR_WINDOW = 16;
+
+        /* dense table of the selected device: its calibration (_biasTableDevice) or the default one (nullptr) */
+        int16_t         _biasTable[BIAS_DENSE_TABLE_SIZE];
+        uint8_t         _biasTableStart = 0;
+        uint8_t         _biasTableLength = 0;
+        boolean         _biasTableValid = false;
+        const DW1000NgDevice* _biasTableDevice = nullptr;
+        Channel         _biasTableChannel;
+        PulseFrequency  _biasTablePulseFrequency;
+
+        float _ramp(float value, float low, float high) {
+            if(value <= low)
+                return 0.0f;
+            if(value >= high)
+                return 1.0f;
+            return (value - low) / (high - low);
+        }
+
+        uint8_t _peakDelay() {
+            cir_sample_t window[CIR_WINDOW];
+            uint16_t firstPath = DW1000Ng::getFirstPathIndex() >> 6;
+            uint16_t start = firstPath > CIR_WINDOW_BEFORE ? firstPath - CIR_WINDOW_BEFORE : 0;
+            uint16_t count = DW1000Ng::readCIR(window, start, CIR_WINDOW);
+
+            uint16_t peak = 0;
+            uint32_t peakMagnitude = 0;
+            for(uint16_t i = 0; i < count; i++) {
+                int32_t re = window[i].real;
+                int32_t im = window[i].imaginary;
+                uint32_t magnitude = static_cast<uint32_t>(re * re) + static_cast<uint32_t>(im * im);
+                if(magnitude > peakMagnitude) {
+                    peakMagnitude = magnitude;
+                    peak = i;
+                }
+            }
+            return start + peak > firstPath ? start + peak - firstPath : 0;
+        }
+
+        /* rows must be sorted by increasing rxPower */
+        void _buildDenseTable(const bias_correction_point_t rows[], uint8_t n) {
+            uint16_t length = rows[n-1].rxPower - rows[0].rxPower + 1;
+            if(length > BIAS_DENSE_TABLE_SIZE)
+                length = BIAS_DENSE_TABLE_SIZE;
+
+            _biasTableStart = rows[0].rxPower;
+            _biasTableLength = length;
+
+            uint8_t row = 0;
+            for(uint8_t i = 0; i < length; i++) {
+                uint8_t power = _biasTableStart + i;
+                while(row < n - 1 && rows[row+1].rxPower <= power)
+                    row++;
+                if(row == n - 1 || rows[row+1].rxPower == rows[row].rxPower) {
+                    _biasTable[i] = rows[row].correction;
+                } else {
+                    int32_t span = rows[row+1].rxPower - rows[row].rxPower;
+                    int32_t delta = static_cast<int32_t>(rows[row+1].correction) - rows[row].correction;
+                    _biasTable[i] = rows[row].correction + (delta * (power - rows[row].rxPower)) / span;
+                }
+            }
+        }
+
+        /* APS011 table for the current channel and PRF */
+        void _buildDefaultTable(Channel channel, PulseFrequency pulseFrequency) {
+            size_t index = pulseFrequency == PulseFrequency::FREQ_16MHZ ? 1 : 2;
+            if(channel == Channel::CHANNEL_4 || channel == Channel::CHANNEL_7)
+                index+=2;
+
+            bias_correction_point_t rows[18];
+            for(uint8_t i = 0; i < 18; i++) {
+                rows[i].rxPower = static_cast<uint8_t>(BIAS_TABLE[i][0]);
+                rows[i].correction = static_cast<int16_t>(BIAS_TABLE[i][index]);
+            }
+            _buildDenseTable(rows, 18);
+        }
+
+        /* Rebuilds the table only when the selected device, its calibration, channel or PRF changed since last time */
+        void _updateBiasTable() {
+            const DW1000NgDevice& device = DW1000Ng::getSelectedDevice();
+            Channel channel = DW1000Ng::getChannel();
+            PulseFrequency pulseFrequency = DW1000Ng::getPulseFrequency();
+            /* a calibration holds only on the channel and PRF it was measured on */
+            const DW1000NgDevice* owner = device._biasCorrectionRows > 0 && device._biasCorrectionChannel == channel
+                && device._biasCorrectionPulseFrequency == pulseFrequency ? &device : nullptr;
+            if(_biasTableValid && owner == _biasTableDevice && channel == _biasTableChannel && pulseFrequency == _biasTablePulseFrequency)
+                return;
+
+            if(owner != nullptr)
+                _buildDenseTable(device._biasCorrection, device._biasCorrectionRows);
+            else
+                _buildDefaultTable(channel, pulseFrequency);
+            _biasTableDevice = owner;
+            _biasTableChannel = channel;
+            _biasTablePulseFrequency = pulseFrequency;
+            _biasTableValid = true;
+        }
+
+        /* Bias in millimeters for the given receive power (dBm, Q16.16) */
+        int16_t _biasAt(int32_t rxPowerQ16) {
+            _updateBiasTable();
+
+            /* table is indexed by -dBm */
+            int32_t offset = -rxPowerQ16 - (static_cast<int32_t>(_biasTableStart) << 16);
+            if(offset <= 0)
+                return _biasTable[0];
+
+            uint16_t index = offset >> 16;
+            if(index >= _biasTableLength - 1)
+                return _biasTable[_biasTableLength - 1];
+
+            /* 8 bit fraction is enough and keeps the product in 32 bit */
+            int32_t fraction = (offset & 0xFFFF) >> 8;
+            int32_t delta = static_cast<int32_t>(_biasTable[index+1]) - _biasTable[index];
+            return _biasTable[index] + ((delta * fraction) >> 8);
+        }
+    }
+
     /* asymmetric two-way ranging (more computation intense, less error prone) */
     double computeRangeAsymmetric(    
                                     uint64_t timePollSent, 
@@ -41,6 +177,9 @@ namespace DW1000NgRanging {
                                     uint64_t timeRangeReceived
                                 )
     {
+        #if DW1000NG_FIXED_POINT
+        return computeRangeAsymmetricMillimeters(timePollSent, timePollReceived, timePollAckSent, timePollAckReceived, timeRangeSent, timeRangeReceived) * 0.001;
+        #else
         uint32_t timePollSent_32 = static_cast<uint32_t>(timePollSent);
         uint32_t timePollReceived_32 = static_cast<uint32_t>(timePollReceived);
         uint32_t timePollAckSent_32 = static_cast<uint32_t>(timePollAckSent);
@@ -57,32 +196,108 @@ namespace DW1000NgRanging {
         double distance = tof_uwb * DISTANCE_OF_RADIO;
 
         return distance;
+        #endif
+    }
+
+    /* same as computeRangeAsymmetric, products of 32 bit intervals are kept exact in 64 bit */
+    int32_t computeRangeAsymmetricMillimeters(    
+                                    uint64_t timePollSent, 
+                                    uint64_t timePollReceived, 
+                                    uint64_t timePollAckSent, 
+                                    uint64_t timePollAckReceived,
+                                    uint64_t timeRangeSent,
+                                    uint64_t timeRangeReceived
+                                )
+    {
+        uint32_t round1 = static_cast<uint32_t>(timePollAckReceived) - static_cast<uint32_t>(timePollSent);
+        uint32_t reply1 = static_cast<uint32_t>(timePollAckSent) - static_cast<uint32_t>(timePollReceived);
+        uint32_t round2 = static_cast<uint32_t>(timeRangeReceived) - static_cast<uint32_t>(timePollAckSent);
+        uint32_t reply2 = static_cast<uint32_t>(timeRangeSent) - static_cast<uint32_t>(timePollAckReceived);
+
+        uint64_t rounds = static_cast<uint64_t>(round1) * round2;
+        uint64_t replies = static_cast<uint64_t>(reply1) * reply2;
+        uint64_t sum = static_cast<uint64_t>(round1) + round2 + reply1 + reply2;
+        if(sum == 0)
+            return 0;
+
+        /* Truncates towards zero like the floating point version */
+        int64_t tof_uwb = rounds >= replies ? static_cast<int64_t>((rounds - replies) / sum) : -static_cast<int64_t>((replies - rounds) / sum);
+        int64_t distance = tof_uwb * DISTANCE_OF_RADIO_MM_Q24;
+
+        /* round to nearest millimeter */
+        return static_cast<int32_t>(distance >= 0 ? (distance + (1L << 23)) >> 24 : -((-distance + (1L << 23)) >> 24));
     }
 
     double correctRange(double range) {
-        double result = 0;
+        #if DW1000NG_FIXED_POINT
+        return correctRangeMillimeters(static_cast<int32_t>(range * 1000), DW1000Ng::getReceivePowerQ16()) * 0.001;
+        #else
+        return correctRange(range, DW1000Ng::getReceivePower());
+        #endif
+    }
 
-        Channel currentChannel = DW1000Ng::getChannel();
-        double rxPower = -(static_cast<double>(DW1000Ng::getReceivePower()));
-        
-        size_t index = DW1000Ng::getPulseFrequency() == PulseFrequency::FREQ_16MHZ ? 1 : 2;
-        if(currentChannel == Channel::CHANNEL_4 || currentChannel == Channel::CHANNEL_7)
-            index+=2;
-        
-        if (rxPower < BIAS_TABLE[0][0]) {
-            result = range += BIAS_TABLE[0][index]*0.001;
-        } else if (rxPower >= BIAS_TABLE[17][0]) {
-            result = range += BIAS_TABLE[17][index]*0.001;
-        } else {
-            for(auto i=0; i < 17; i++) {
-                if (rxPower >= BIAS_TABLE[i][0] && rxPower < BIAS_TABLE[i+1][0]){
-                    result = range += BIAS_TABLE[i][index]*0.001;
-                    break;
-                }
-            }
+    double correctRange(double range, float rxPower) {
+        return range + _biasAt(static_cast<int32_t>(rxPower * 65536)) * 0.001;
+    }
+
+    int32_t correctRangeMillimeters(int32_t range, int32_t rxPowerQ16) {
+        return range + _biasAt(rxPowerQ16);
+    }
+
+    boolean setBiasCorrectionTable(const bias_correction_point_t table[], uint8_t rows) {
+        if(rows == 0 || rows > DW1000NG_BIAS_TABLE_ROWS)
+            return false;
+        for(uint8_t i = 1; i < rows; i++) {
+            if(table[i].rxPower <= table[i-1].rxPower)
+                return false;
         }
 
-        return result;
+        DW1000NgDevice& device = DW1000Ng::getSelectedDevice();
+        memcpy(device._biasCorrection, table, rows * sizeof(bias_correction_point_t));
+        device._biasCorrectionRows = rows;
+        device._biasCorrectionChannel = DW1000Ng::getChannel();
+        device._biasCorrectionPulseFrequency = DW1000Ng::getPulseFrequency();
+        _biasTableValid = false;
+        return true;
     }
 
+    void useDefaultBiasCorrectionTable() {
+        DW1000Ng::getSelectedDevice()._biasCorrectionRows = 0;
+        _biasTableValid = false;
+    }
+
+    link_quality_t assessLink(boolean readCIR) {
+        uint8_t peakDelay = readCIR ? _peakDelay() : 0;
+        return assessLink(
+            DW1000Ng::getReceivePower(),
+            DW1000Ng::getFirstPathPower(),
+            DW1000Ng::getReceiveQuality(),
+            DW1000Ng::getPreambleAccumulationCount(),
+            DW1000NgAirtime::preambleSymbols(DW1000Ng::getPreambleLength()),
+            peakDelay
+        );
+    }
+
+    link_quality_t assessLink(float rxPower, float fpPower, float receiveQuality, uint16_t preambleAccumulation, uint16_t preambleSymbols, uint8_t peakDelay) {
+        link_quality_t link;
+        link.powerDifference = rxPower - fpPower;
+        link.receiveQuality = receiveQuality;
+        link.preambleAccumulation = preambleAccumulation;
+        link.peakDelay = peakDelay;
+
+        float probability = _ramp(link.powerDifference, LOS_POWER_DIFFERENCE, NLOS_POWER_DIFFERENCE);
+        float delayProbability = _ramp(peakDelay, LOS_PEAK_DELAY, NLOS_PEAK_DELAY);
+        link.nlosProbability = delayProbability > probability ? delayProbability : probability;
+
+        float sigma = LOS_RANGE_SIGMA + link.nlosProbability * (NLOS_RANGE_SIGMA - LOS_RANGE_SIGMA);
+        float variance = sigma * sigma;
+        /* weak first path: the leading edge is found later in the noise */
+        if(receiveQuality < GOOD_RECEIVE_QUALITY)
+            variance *= receiveQuality > 1.0f ? GOOD_RECEIVE_QUALITY / receiveQuality : GOOD_RECEIVE_QUALITY;
+        /* preamble detected late: fewer symbols were accumulated and the CIR is noisier */
+        if(preambleAccumulation > 0 && preambleAccumulation < preambleSymbols / 2)
+            variance *= static_cast<float>(preambleSymbols) / (2 * preambleAccumulation);
+        link.rangeVariance = variance;
+        return link;
+    }
 }
@@ -25,6 +25,18 @@
 #pragma once
 
 #include <Arduino.h>
+#include "DW1000NgCompileOptions.hpp"
+#include "DW1000NgConfiguration.hpp"
+
+/* Link quality of a received frame, see DW1000NgRanging::assessLink */
+typedef struct link_quality_t {
+    float nlosProbability; // 0 (line of sight) to 1 (non line of sight)
+    float rangeVariance; // expected variance of a range measured on the frame, m^2
+    float powerDifference; // receive power - first path power, dB
+    float receiveQuality; // first path amplitude / noise
+    uint16_t preambleAccumulation; // preamble symbols accumulated (RXPACC)
+    uint8_t peakDelay; // samples (~1 ns) from the first path to the strongest path, 0 if the CIR was not read
+} link_quality_t;
 
 namespace DW1000NgRanging {
 
@@ -48,12 +60,100 @@ namespace DW1000NgRanging {
                                         uint64_t timeRangeSent,
                                         uint64_t timeRangeReceived 
                                  );
+
+    /** 
+    Asymmetric two-way ranging algorithm computed with integer math only (see computeRangeAsymmetric)
+    
+    @param [in] timePollSent timestamp of poll transmission
+    @param [in] timePollReceived timestamp of poll receive
+    @param [in] timePollAckSent timestamp of response to poll transmission
+    @param [in] timePollAckReceived timestamp of response to poll receive
+    @param [in] timeRangeSent timestamp of final message transmission
+    @param [in] timeRangeReceived timestamp of final message receive
+
+    returns the range in millimeters
+    */
+    int32_t computeRangeAsymmetricMillimeters(    
+                                        uint64_t timePollSent, 
+                                        uint64_t timePollReceived, 
+                                        uint64_t timePollAckSent, 
+                                        uint64_t timePollAckReceived,
+                                        uint64_t timeRangeSent,
+                                        uint64_t timeRangeReceived 
+                                 );
     //TODO Symmetric
 
     /**
-    Removes bias from the target range
+    Removes bias from the target range.
+    Reads the receive power of the last received frame from the device.
     
     returns the unbiased range
     */
     double correctRange(double range);
+
+    /**
+    Removes bias from the target range using an already measured receive power.
+    The correction is linearly interpolated between the bias table rows.
+
+    @param [in] range the range in meters
+    @param [in] rxPower the receive power of the frame in dBm (see DW1000Ng::getReceivePower)
+
+    returns the unbiased range
+    */
+    double correctRange(double range, float rxPower);
+
+    /**
+    Removes bias from the target range using integer math only
+
+    @param [in] range the range in millimeters
+    @param [in] rxPowerQ16 the receive power of the frame in dBm, Q16.16 (see DW1000Ng::getReceivePowerQ16)
+
+    returns the unbiased range in millimeters
+    */
+    int32_t correctRangeMillimeters(int32_t range, int32_t rxPowerQ16);
+
+    /**
+    Replaces the default (APS011) bias table of the selected device with a calibration table measured on its antenna.
+    The calibration is tied to the current channel and PRF: on any other (e.g. after a hop, see DW1000NgHopping)
+    the default table of that channel and PRF is used. The rows are copied, so the array can be discarded after the call.
+
+    @param [in] table the table rows, sorted by strictly increasing rxPower
+    @param [in] rows the number of rows, at most DW1000NG_BIAS_TABLE_ROWS
+
+    returns false if the rows are not sorted or their number is out of range, the current table is then kept
+    */
+    boolean setBiasCorrectionTable(const bias_correction_point_t table[], uint8_t rows);
+
+    /**
+    Goes back to the default (APS011) bias table of the current channel and PRF for the selected device
+    */
+    void useDefaultBiasCorrectionTable();
+
+    /**
+    Classifies the last received frame as line of sight or not from the difference between
+    the receive power and the first path power (APS006: below 6 dB the link is likely LOS, above 10 dB likely NLOS),
+    and optionally from the delay between the first and the strongest path of the accumulator.
+    The range variance grows with the NLOS probability and when the first path is weak or the preamble
+    was detected late, so a position solver can weight each range by its inverse.
+    Must be called before the receiver is re-enabled.
+
+    @param [in] readCIR reads 16 accumulator samples around the first path (slower, detects NLOS links with a strong first path)
+
+    returns the link quality of the last received frame
+    */
+    link_quality_t assessLink(boolean readCIR = false);
+
+    /**
+    Classifies a link from already measured values, see assessLink()
+
+    @param [in] rxPower the receive power in dBm (see DW1000Ng::getReceivePower)
+    @param [in] fpPower the first path power in dBm (see DW1000Ng::getFirstPathPower)
+    @param [in] receiveQuality the receive quality (see DW1000Ng::getReceiveQuality)
+    @param [in] preambleAccumulation the accumulated preamble symbols (see DW1000Ng::getPreambleAccumulationCount)
+    @param [in] preambleSymbols the transmitted preamble length in symbols
+    @param [in] peakDelay samples from the first path to the strongest path, 0 if unknown
+
+    returns the link quality
+    */
+    link_quality_t assessLink(float rxPower, float fpPower, float receiveQuality, uint16_t preambleAccumulation, uint16_t preambleSymbols, uint8_t peakDelay = 0);
 }
\ No newline at end of file
@@ -134,8 +134,10 @@ constexpr uint16_t RX_TIME = 0x15;
 constexpr uint16_t LEN_RX_TIME = 14;
 constexpr uint16_t RX_STAMP_SUB = 0x00;
 constexpr uint16_t FP_AMPL1_SUB = 0x07;
+constexpr uint16_t FP_INDEX_SUB = 0x05;
 constexpr uint16_t LEN_RX_STAMP = 5;
 constexpr uint16_t LEN_FP_AMPL1 = 2;
+constexpr uint16_t LEN_FP_INDEX = 2;
 
 // RX frame quality
 constexpr uint16_t RX_FQUAL = 0x12;
@@ -202,6 +204,16 @@ constexpr uint16_t OTP_RDAT_SUB = 0x0A;
 constexpr uint16_t LEN_OTP_ADDR = 2;
 constexpr uint16_t LEN_OTP_CTRL = 2;
 constexpr uint16_t LEN_OTP_RDAT = 4;
+constexpr uint16_t LDELOAD_BIT = 15;
+
+// OTP memory map (factory calibration), addresses of 32 bit words
+constexpr uint16_t OTP_EUI_ADDRESS = 0x000;
+constexpr uint16_t OTP_LDOTUNE_ADDRESS = 0x004;
+constexpr uint16_t OTP_VMEAS_ADDRESS = 0x008;
+constexpr uint16_t OTP_TMEAS_ADDRESS = 0x009;
+constexpr uint16_t OTP_ANTENNA_DELAY_ADDRESS = 0x01C;
+constexpr uint16_t OTP_XTAL_TRIM_ADDRESS = 0x01E;
+constexpr uint16_t LEN_OTP_LDOTUNE = 5;
 
 // AGC_TUNE1/2/3 (for re-tuning only)
 constexpr uint16_t AGC_TUNE = 0x23;
@@ -257,15 +269,29 @@ constexpr uint16_t LEN_LDE_RXANTD = 2;
 // DIG_DIAG (Digital Diagnostics Interface)
 constexpr uint16_t DIG_DIAG = 0x2F;
 constexpr uint16_t EVC_CTRL_SUB = 0x00;
+constexpr uint16_t EVC_PHE_SUB = 0x04;
+constexpr uint16_t EVC_RSE_SUB = 0x06;
+constexpr uint16_t EVC_FCG_SUB = 0x08;
+constexpr uint16_t EVC_FCE_SUB = 0x0A;
+constexpr uint16_t EVC_FFR_SUB = 0x0C;
+constexpr uint16_t EVC_OVR_SUB = 0x0E;
 constexpr uint16_t EVC_STO_SUB = 0x10;
 constexpr uint16_t EVC_PTO_SUB = 0x12;
 constexpr uint16_t EVC_FWTO_SUB = 0x14;
+constexpr uint16_t EVC_TXFS_SUB = 0x16;
+constexpr uint16_t EVC_HPW_SUB = 0x18;
+constexpr uint16_t EVC_TPW_SUB = 0x1A;
 constexpr uint16_t DIAG_TMC_SUB = 0x24;
 constexpr uint16_t LEN_EVC_CTRL = 4;
 constexpr uint16_t LEN_EVC_STO = 2;
 constexpr uint16_t LEN_EVC_PTO = 2;
 constexpr uint16_t LEN_EVC_FWTO = 2;
 constexpr uint16_t LEN_DIAG_TMC = 2;
+/* the twelve 12 bit event counters, EVC_PHE to EVC_TPW, read in one burst */
+constexpr uint16_t LEN_EVC_COUNTERS = 24;
+constexpr uint16_t EVC_COUNTER_MASK = 0x0FFF;
+constexpr uint16_t EVC_EN_BIT = 0;
+constexpr uint16_t EVC_CLR_BIT = 1;
 
 // TX_POWER (for re-tuning only)
 constexpr uint16_t TX_POWER = 0x1E;
@@ -279,6 +305,8 @@ constexpr uint16_t RF_TXCTRL_SUB = 0x0C;
 constexpr uint16_t LEN_RX_CONF_SUB = 4;
 constexpr uint16_t LEN_RF_RXCTRLH = 1;
 constexpr uint16_t LEN_RF_TXCTRL = 4;
+constexpr uint16_t RF_LDOTUNE_SUB = 0x30;
+constexpr uint16_t LEN_RF_LDOTUNE = 5;
 
 // TX_CAL (for re-tuning only)
 constexpr uint16_t TX_CAL = 0x2A;
@@ -332,6 +360,9 @@ constexpr uint16_t LEN_AON_CFG1 = 2;
 // PMSC
 constexpr uint16_t PMSC = 0x36;
 constexpr uint16_t PMSC_CTRL0_SUB = 0x00;
+constexpr uint16_t RXCLKS_BIT = 2;
+constexpr uint16_t FACE_BIT = 6;
+constexpr uint16_t AMCE_BIT = 15;
 constexpr uint16_t GPDCE_BIT = 18;
 constexpr uint16_t KHZCLKEN_BIT = 23;
 constexpr uint16_t PMSC_SOFTRESET_SUB = 0x03;
@@ -345,6 +376,13 @@ constexpr uint16_t LEN_PMSC_SOFTRESET = 1;
 constexpr uint16_t LEN_PMSC_CTRL1 = 4;
 constexpr uint16_t LEN_PMSC_LEDC = 4;
 
+// Accumulator (CIR) memory, complex samples of 16 bit real and 16 bit imaginary parts
+constexpr uint16_t ACC_MEM = 0x25;
+constexpr uint16_t LEN_ACC_MEM = 4064;
+constexpr uint16_t LEN_ACC_SAMPLE = 4;
+constexpr uint16_t ACC_SAMPLES_16MHZ = 992;
+constexpr uint16_t ACC_SAMPLES_64MHZ = 1016;
+
 // TX_ANTD Antenna delays
 constexpr uint16_t TX_ANTD = 0x18;
 constexpr uint16_t LEN_TX_ANTD = 2;
@@ -353,6 +391,8 @@ constexpr uint16_t LEN_TX_ANTD = 2;
 constexpr uint16_t ACK_RESP_T = 0x1A;
 constexpr uint16_t ACK_RESP_T_W4R_TIME_SUB = 0x00;
 constexpr uint16_t LEN_ACK_RESP_T_W4R_TIME_SUB = 3;
+constexpr uint16_t ACK_RESP_T_ACK_TIM_SUB = 0x03;
+constexpr uint16_t LEN_ACK_RESP_T_ACK_TIM_SUB = 1;
 constexpr uint16_t LEN_ACK_RESP_T = 4;
 
 // GPIO
@@ -25,7 +25,133 @@
 #pragma once
 
 #include <Arduino.h>
+#include "DW1000NgConstants.hpp"
 
 namespace DW1000NgTime {
+
+    /* 1 UWB time unit = 1 / (128 * 499.2 MHz) = 1 / 63897.6 us */
+    constexpr uint64_t TICKS_PER_10_MICROSECONDS = 638976;
+    constexpr uint64_t TICKS_PER_625_NANOSECONDS = 39936;
+
+    /* DX_TIME ignores the least significant 9 bits in functional modes */
+    constexpr uint64_t DELAYED_TRX_IGNORED_MASK = 0x1FF;
+
+    /**
+    Converts microseconds to UWB time without floating point math
+
+    @param [in] microSeconds the time in us
+
+    returns the time in UWB time units
+    */
+    constexpr uint64_t microsecondsToTicks(uint64_t microSeconds) {
+        return microSeconds * TICKS_PER_10_MICROSECONDS / 10;
+    }
+
+    /**
+    Converts nanoseconds to UWB time without floating point math
+
+    @param [in] nanoSeconds the time in ns
+
+    returns the time in UWB time units
+    */
+    constexpr uint64_t nanosecondsToTicks(uint64_t nanoSeconds) {
+        return nanoSeconds * TICKS_PER_625_NANOSECONDS / 625;
+    }
+
+    /**
+    Converts UWB time to microseconds (truncated) without floating point math
+
+    @param [in] ticks the time in UWB time units
+
+    returns the time in us
+    */
+    constexpr uint64_t ticksToMicroseconds(uint64_t ticks) {
+        return ticks * 10 / TICKS_PER_10_MICROSECONDS;
+    }
+
+    /**
+    Converts UWB time to nanoseconds (truncated) without floating point math
+
+    @param [in] ticks the time in UWB time units
+
+    returns the time in ns
+    */
+    constexpr uint64_t ticksToNanoseconds(uint64_t ticks) {
+        return ticks * 625 / TICKS_PER_625_NANOSECONDS;
+    }
+
+    /**
+    A 40 bit DW1000 timestamp (system time, RX/TX stamps).
+    Arithmetic wraps around like the device counter, which overflows every ~17.2 seconds.
+    */
+    class Timestamp {
+    public:
+        constexpr Timestamp() : _ticks(0) {}
+        constexpr explicit Timestamp(uint64_t ticks) : _ticks(ticks & TIME_MAX) {}
+
+        /* raw 40 bit value */
+        constexpr uint64_t ticks() const { return _ticks; }
+
+        constexpr Timestamp operator+(uint64_t ticks) const { return Timestamp(_ticks + ticks); }
+        constexpr Timestamp operator-(uint64_t ticks) const { return Timestamp(_ticks - ticks); }
+
+        /**
+        Signed distance from other to this, assuming they are less than half a wrap (~8.6 s) apart
+        */
+        constexpr int64_t operator-(Timestamp other) const {
+            return _signExtend((_ticks - other._ticks) & TIME_MAX);
+        }
+
+        constexpr bool operator==(Timestamp other) const { return _ticks == other._ticks; }
+        constexpr bool operator!=(Timestamp other) const { return _ticks != other._ticks; }
+        constexpr bool operator<(Timestamp other) const { return (*this - other) < 0; }
+        constexpr bool operator>(Timestamp other) const { return (*this - other) > 0; }
+        constexpr bool operator<=(Timestamp other) const { return (*this - other) <= 0; }
+        constexpr bool operator>=(Timestamp other) const { return (*this - other) >= 0; }
+
+    private:
+        static constexpr int64_t _signExtend(uint64_t value) {
+            return (value & 0x8000000000) ? static_cast<int64_t>(value) - TIME_OVERFLOW : static_cast<int64_t>(value);
+        }
+
+        uint64_t _ticks;
+    };
+
+    /**
+    The time at which the device will really start a delayed transmission/reception
+    programmed with the target time, since the low 9 bits of DX_TIME are ignored.
+
+    @param [in] target the requested time
+
+    returns the time the device will use
+    */
+    constexpr Timestamp delayedTRXTime(Timestamp target) {
+        return Timestamp(target.ticks() & ~DELAYED_TRX_IGNORED_MASK);
+    }
+
+    /**
+    Earliest time, not before target, that the device can use for a delayed transmission/reception
+    without losing the low 9 bits.
+
+    @param [in] target the requested time
+
+    returns the target rounded up to the DX_TIME resolution (~8 ns)
+    */
+    constexpr Timestamp delayedTRXTimeNotBefore(Timestamp target) {
+        return delayedTRXTime(target + DELAYED_TRX_IGNORED_MASK);
+    }
+
+    /**
+    The TX timestamp a delayed transmission programmed with target will carry
+
+    @param [in] target the requested transmission time
+    @param [in] antennaDelay the tx antenna delay of the device
+
+    returns the timestamp of the transmission (RMARKER at the antenna)
+    */
+    constexpr Timestamp delayedTransmitTimestamp(Timestamp target, uint16_t antennaDelay) {
+        return delayedTRXTime(target) + antennaDelay;
+    }
+
     uint64_t microsecondsToUWBTime(uint64_t microSeconds);
 }
\ No newline at end of file
@@ -0,0 +1,276 @@
+/*
+ * MIT License
+ * 
+ * Copyright (c) 2018 Michele Biondi, Andrea Salvatori
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+*/
+
+
+#include <Arduino.h>
+#include "DW1000NgTransport.hpp"
+#include "DW1000Ng.hpp"
+#include "DW1000NgAirtime.hpp"
+#include "DW1000NgFrame.hpp"
+#include "DW1000NgRegisters.hpp"
+#include "DW1000NgUtils.hpp"
+
+namespace DW1000NgTransport {
+
+    namespace {
+        using DW1000NgFrame::DataFrame;
+
+        typedef DataFrame<SHORT_SRC_AND_DEST, TRANSPORT_HEADER_LENGTH + DW1000NG_TRANSPORT_FRAGMENT_SIZE> TransportFrame;
+
+        constexpr uint8_t FRAGMENT_INDEX = 1;
+        constexpr uint8_t FRAGMENT_COUNT = 2;
+        constexpr uint8_t WINDOW_SIZE = 32;
+
+        typedef struct Peer {
+            uint16_t address;
+            uint32_t lastUse;       /* millis() */
+            byte txSequence;
+            boolean txSynchronized; /* a fragment to the peer has been acknowledged */
+            boolean rxValid;        /* rxLast and rxWindow hold received sequence numbers */
+            byte rxLast;            /* highest sequence number received */
+            uint32_t rxWindow;      /* bit i: rxLast - i received */
+            /* reassembly of the message being received from the peer: acknowledged fragments can't be dropped */
+            uint8_t nextFragment;   /* 0: no message in progress */
+            uint16_t messageLength;
+            byte message[DW1000NG_TRANSPORT_MESSAGE_SIZE];
+        } Peer;
+
+        Peer _peers[DW1000NG_TRANSPORT_PEERS];
+        uint8_t _peersCount = 0;
+
+        byte _frame[TransportFrame::LENGTH + 2];
+
+        transport_statistics_t _statistics = {};
+
+        Peer& _peer(uint16_t address) {
+            uint8_t oldest = 0;
+            for(uint8_t i = 0; i < _peersCount; i++) {
+                if(_peers[i].address == address) {
+                    _peers[i].lastUse = millis();
+                    return _peers[i];
+                }
+                if((int32_t)(_peers[i].lastUse - _peers[oldest].lastUse) < 0)
+                    oldest = i;
+            }
+            if(_peersCount == DW1000NG_TRANSPORT_PEERS && _peers[oldest].nextFragment != 0)
+                _statistics.incompleteMessages++;
+            Peer& peer = _peersCount < DW1000NG_TRANSPORT_PEERS ? _peers[_peersCount++] : _peers[oldest];
+            peer.address = address;
+            peer.lastUse = millis();
+            /* unlikely to repeat the sequence numbers of a previous run: the low 9 bits of SYS_TIME are always zero */
+            peer.txSequence = (byte)(DW1000Ng::getSystemTimestamp() >> 9);
+            peer.txSynchronized = false;
+            peer.rxValid = false;
+            peer.nextFragment = 0;
+            return peer;
+        }
+
+        /* returns false if the sequence number has already been received */
+        boolean _acceptSequence(Peer& peer, byte sequence, boolean sync) {
+            int8_t distance = (int8_t)(sequence - peer.rxLast);
+            if(!peer.rxValid || (sync && distance != 0) || distance <= -(int8_t)WINDOW_SIZE) {
+                /* first frame, sender restarted or too far behind to be a retransmission */
+                peer.rxValid = true;
+                peer.rxLast = sequence;
+                peer.rxWindow = 1;
+                return true;
+            }
+            if(distance > 0) {
+                peer.rxWindow = distance < WINDOW_SIZE ? (peer.rxWindow << distance) | 1 : 1;
+                peer.rxLast = sequence;
+                return true;
+            }
+            uint32_t bit = (uint32_t)1 << -distance;
+            if(peer.rxWindow & bit)
+                return false;
+            peer.rxWindow |= bit;
+            return true;
+        }
+
+        /* returns true when the message is complete */
+        boolean _reassemble(Peer& peer, const byte fragment[], uint16_t length) {
+            uint8_t index = fragment[FRAGMENT_INDEX];
+            uint8_t count = fragment[FRAGMENT_COUNT];
+            if(index == 0) {
+                if(peer.nextFragment != 0)
+                    _statistics.incompleteMessages++;
+                peer.messageLength = 0;
+            } else if(index != peer.nextFragment) {
+                return false;
+            }
+            length -= TRANSPORT_HEADER_LENGTH;
+            if(peer.messageLength + length > DW1000NG_TRANSPORT_MESSAGE_SIZE || index >= count) {
+                _statistics.incompleteMessages++;
+                peer.nextFragment = 0;
+                return false;
+            }
+            memcpy(&peer.message[peer.messageLength], &fragment[TRANSPORT_HEADER_LENGTH], length);
+            peer.messageLength += length;
+            peer.nextFragment = index + 1;
+            if(peer.nextFragment < count)
+                return false;
+            peer.nextFragment = 0;
+            return true;
+        }
+
+        void _waitForTransmission() {
+            while(!DW1000Ng::isTransmitDone()) {
+                #if defined(ESP8266)
+                yield();
+                #endif
+            }
+            DW1000Ng::clearTransmitStatus();
+        }
+
+        /* returns false on timeout or receive error */
+        boolean _waitForFrame() {
+            while(!DW1000Ng::isReceiveDone()) {
+                if(DW1000Ng::isReceiveTimeout()) {
+                    DW1000Ng::clearReceiveTimeoutStatus();
+                    return false;
+                }
+                if(DW1000Ng::isReceiveFailed()) {
+                    DW1000Ng::clearReceiveFailedStatus();
+                    return false;
+                }
+                #if defined(ESP8266)
+                yield();
+                #endif
+            }
+            DW1000Ng::clearReceiveStatus();
+            return true;
+        }
+
+        boolean _sendFragment(TransportFrame& frame, uint16_t payloadLength) {
+            for(uint8_t attempt = 0; attempt <= DW1000NG_TRANSPORT_RETRIES; attempt++) {
+                if(attempt > 0)
+                    _statistics.retransmissions++;
+                frame.transmit(payloadLength);
+                _waitForTransmission();
+                if(!_waitForFrame())
+                    continue;
+                byte acknowledgement[DW1000NgAirtime::ACKNOWLEDGEMENT_LENGTH + 2];
+                uint16_t length = DW1000Ng::getReceivedDataLength();
+                if(length > sizeof(acknowledgement))
+                    continue;
+                DW1000Ng::getReceivedData(acknowledgement, length);
+                if(DW1000NgFrame::isAcknowledgement(acknowledgement, length, frame.sequenceNumber()))
+                    return true;
+            }
+            return false;
+        }
+    }
+
+    boolean send(uint16_t destination, const byte data[], uint16_t length) {
+        device_configuration_t config;
+        DW1000Ng::getConfiguration(config);
+        uint16_t fragmentSize = (config.extendedFrameLength ? LEN_EXT_UWB_FRAMES : LEN_UWB_FRAMES)
+                                - 2 - TransportFrame::HEADER_LENGTH - TRANSPORT_HEADER_LENGTH;
+        if(fragmentSize > DW1000NG_TRANSPORT_FRAGMENT_SIZE)
+            fragmentSize = DW1000NG_TRANSPORT_FRAGMENT_SIZE;
+        uint16_t count = length == 0 ? 1 : (length + fragmentSize - 1) / fragmentSize;
+        if(count > 0xFF)
+            return false;
+
+        Peer& peer = _peer(destination);
+        byte address[2];
+        DW1000NgUtils::writeValueToBytes(address, destination, 2);
+
+        uint16_t frameWaitTimeout = DW1000Ng::getReceiveFrameWaitTimeoutPeriod();
+        DW1000Ng::setReceiveFrameWaitTimeoutPeriod(DW1000NgAirtime::acknowledgeWaitTimeout(config));
+        DW1000Ng::setWait4Acknowledge(true);
+
+        boolean delivered = true;
+        for(uint16_t index = 0; index < count && delivered; index++) {
+            uint16_t offset = index * fragmentSize;
+            uint16_t fragmentLength = length - offset < fragmentSize ? length - offset : fragmentSize;
+            TransportFrame frame(peer.txSequence++, address);
+            frame.requestAcknowledge();
+            byte* payload = frame.payload();
+            payload[0] = peer.txSynchronized ? TRANSPORT_DATA : TRANSPORT_DATA_SYNC;
+            payload[FRAGMENT_INDEX] = index;
+            payload[FRAGMENT_COUNT] = count;
+            memcpy(&payload[TRANSPORT_HEADER_LENGTH], &data[offset], fragmentLength);
+            delivered = _sendFragment(frame, TRANSPORT_HEADER_LENGTH + fragmentLength);
+            if(delivered) {
+                peer.txSynchronized = true;
+                _statistics.fragmentsSent++;
+            }
+        }
+        if(!delivered)
+            _statistics.sendFailures++;
+
+        DW1000Ng::setWait4Acknowledge(false);
+        DW1000Ng::setReceiveFrameWaitTimeoutPeriod(frameWaitTimeout);
+        return delivered;
+    }
+
+    boolean receive(byte data[], uint16_t size, uint16_t& length, uint16_t& source) {
+        while(true) {
+            DW1000Ng::startReceive();
+            if(!_waitForFrame())
+                return false;
+            /* the ACK goes out right after the frame, it must end before the receiver is restarted */
+            if(DW1000Ng::isAutoAcknowledgeTriggered())
+                _waitForTransmission();
+
+            uint16_t frameLength = DW1000Ng::getReceivedDataLength();
+            if(frameLength < TransportFrame::HEADER_LENGTH + TRANSPORT_HEADER_LENGTH || frameLength > sizeof(_frame))
+                continue;
+            DW1000Ng::getReceivedData(_frame, frameLength);
+            byte* fragment = &_frame[TransportFrame::HEADER_LENGTH];
+            if((_frame[0] & 0x07) != (DATA & 0x07) || _frame[1] != SHORT_SRC_AND_DEST
+                || (fragment[0] != TRANSPORT_DATA && fragment[0] != TRANSPORT_DATA_SYNC))
+                continue;
+
+            uint16_t sender = DW1000NgUtils::bytesAsValue(&_frame[TransportFrame::SOURCE], 2);
+            Peer& peer = _peer(sender);
+            if(!_acceptSequence(peer, _frame[DW1000NgFrame::SEQUENCE_NUMBER], fragment[0] == TRANSPORT_DATA_SYNC)) {
+                _statistics.duplicates++;
+                continue;
+            }
+            /* without frame check the length includes the CRC */
+            device_configuration_t config;
+            DW1000Ng::getConfiguration(config);
+            uint16_t fragmentLength = frameLength - TransportFrame::HEADER_LENGTH - (config.frameCheck ? 0 : 2);
+            if(fragmentLength < TRANSPORT_HEADER_LENGTH || !_reassemble(peer, fragment, fragmentLength))
+                continue;
+
+            _statistics.messagesReceived++;
+            length = peer.messageLength;
+            source = sender;
+            memcpy(data, peer.message, peer.messageLength < size ? peer.messageLength : size);
+            return true;
+        }
+    }
+
+    void reset() {
+        _peersCount = 0;
+        _statistics = {};
+    }
+
+    void getStatistics(transport_statistics_t& statistics) {
+        statistics = _statistics;
+    }
+}
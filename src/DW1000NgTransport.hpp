@@ -0,0 +1,98 @@
+/*
+ * MIT License
+ * 
+ * Copyright (c) 2018 Michele Biondi, Andrea Salvatori
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+*/
+
+
+#pragma once
+
+#include <Arduino.h>
+#include "DW1000NgCompileOptions.hpp"
+
+/* Function code of the transport frames, first byte of the payload, followed by fragment index and count.
+   The sender uses TRANSPORT_DATA_SYNC until its first fragment to a peer is acknowledged:
+   the receiver then restarts the duplicate window of that peer (e.g. after a reboot of the sender) */
+constexpr byte TRANSPORT_DATA = 0x30;
+constexpr byte TRANSPORT_DATA_SYNC = 0x31;
+constexpr uint8_t TRANSPORT_HEADER_LENGTH = 3;
+
+typedef struct transport_statistics_t {
+    uint32_t fragmentsSent;        /* acknowledged fragments */
+    uint32_t retransmissions;
+    uint32_t sendFailures;         /* messages given up after DW1000NG_TRANSPORT_RETRIES retransmissions */
+    uint32_t messagesReceived;
+    uint32_t duplicates;           /* fragments received again because the ACK was lost */
+    uint32_t incompleteMessages;   /* reassemblies dropped: missing fragment or message too long */
+} transport_statistics_t;
+
+/**
+Reliable data transport between devices with short addresses, on top of the automatic acknowledgement.
+Messages are split in fragments of at most DW1000NG_TRANSPORT_FRAGMENT_SIZE bytes, each sent in its own data frame
+with the ACK request bit and retransmitted until acknowledged. Every peer (at most DW1000NG_TRANSPORT_PEERS,
+the least recently used one is forgotten) has its own sequence number and a window of the last 32 sequence numbers
+received, so retransmissions of an acknowledged fragment are dropped, and its own reassembly buffer, so messages
+from several senders can be received at the same time.
+
+The receiver needs frame filtering with data frames allowed and the automatic acknowledgement enabled
+(see DW1000Ng::enableFrameFiltering() and DW1000Ng::enableAutoAcknowledge()); if the sender filters frames
+it must allow acknowledgements. Both are polled, the interrupts of the used events must be disabled.
+*/
+namespace DW1000NgTransport {
+    /**
+    Sends a message and waits for the acknowledgement of each fragment.
+    During the transfer the frame wait timeout is set to DW1000NgAirtime::acknowledgeWaitTimeout(),
+    the previous value (see DW1000Ng::setReceiveFrameWaitTimeoutPeriod()) is restored at the end,
+    as is the wait for response delay (see DW1000Ng::setWait4Response()).
+
+    @param [in] destination the short address of the receiver
+    @param [in] data the message
+    @param [in] length the message length, at most 255 fragments
+
+    returns true if every fragment has been acknowledged
+    */
+    boolean send(uint16_t destination, const byte data[], uint16_t length);
+
+    /**
+    Receives frames until a message is complete, other frames are dropped.
+    A frame wait timeout (see DW1000Ng::setReceiveFrameWaitTimeoutPeriod()) bounds the wait for each frame.
+
+    @param [out] data the message, truncated to size
+    @param [in] size the size of data
+    @param [out] length the message length
+    @param [out] source the short address of the sender
+
+    returns false on receive timeout or error
+    */
+    boolean receive(byte data[], uint16_t size, uint16_t& length, uint16_t& source);
+
+    /**
+    Forgets every peer: sequence numbers and duplicate windows start over
+    */
+    void reset();
+
+    /**
+    Gets the counters since the last reset()
+
+    @param [out] statistics the counters
+    */
+    void getStatistics(transport_statistics_t& statistics);
+}
@@ -137,5 +137,32 @@ namespace DW1000NgUtils {
 		}
 		memcpy(bytes, eui_byte, LEN_EUI);
 	}
+
+	namespace {
+		/* log2(1 + i/16) in Q16.16 (log2(2) = 65536 closes the last segment) */
+		const uint16_t LOG2_TABLE[16] = {
+			0, 5732, 11136, 16248, 21098, 25711, 30109, 34312,
+			38336, 42196, 45904, 49472, 52911, 56229, 59434, 62534
+		};
+	}
+
+	/*
+	* Integer part is the position of the most significant bit (leading zero count),
+	* the 4 bits below it select a table segment and the next 12 bits interpolate inside it.
+	* The error is below 0.001 (0.003 dB once scaled to 10*log10).
+	*/
+	int32_t log2Q16(uint64_t value) {
+		if(value == 0) {
+			return 0;
+		}
+		uint8_t msb = 63 - __builtin_clzll(value);
+		/* Q0.16 fraction of the normalized mantissa */
+		uint16_t fraction = msb >= 16 ? static_cast<uint16_t>(value >> (msb - 16)) : static_cast<uint16_t>(value << (16 - msb));
+		uint8_t segment = fraction >> 12;
+		uint32_t low = LOG2_TABLE[segment];
+		uint32_t high = segment < 15 ? LOG2_TABLE[segment + 1] : 65536;
+		uint32_t interpolated = low + (((high - low) * (fraction & 0x0FFF)) >> 12);
+		return (static_cast<int32_t>(msb) << 16) + static_cast<int32_t>(interpolated);
+	}
 	
 }
@@ -107,4 +107,13 @@ namespace DW1000NgUtils {
     @param [out] eui_byte The eui bytes
     */
 	void convertToByte(const char string[], byte* eui_byte);
+
+    /**
+    Computes the base 2 logarithm of an integer using only integer math
+
+    @param [in] value the target value (0 returns 0)
+
+    returns log2(value) in Q16.16 fixed point
+    */
+    int32_t log2Q16(uint64_t value);
 }
@@ -67,6 +67,10 @@ namespace SPIporting {
 		_spi->begin();
 	}
 
+	void SPIbind(SPIClass &spi) {
+		_spi = &spi;
+	}
+
 	void SPIend() {
 		_spi->end();
 	}
@@ -81,6 +85,9 @@ namespace SPIporting {
 	}
 
 	void writeToSPI(uint8_t slaveSelectPIN, uint8_t headerLen, byte header[], uint16_t dataLen, byte data[]) {
+		#if DW1000NG_SPI_TRACE
+		traceSPI(micros(), true, headerLen, header, dataLen, data);
+		#endif
 		_openSPI(slaveSelectPIN);
 		for(auto i = 0; i < headerLen; i++) {
 			_spi->transfer(header[i]); // send header
@@ -93,6 +100,9 @@ namespace SPIporting {
 	}
 
     void readFromSPI(uint8_t slaveSelectPIN, uint8_t headerLen, byte header[], uint16_t dataLen, byte data[]){
+		#if DW1000NG_SPI_TRACE
+		uint32_t start = micros();
+		#endif
 		_openSPI(slaveSelectPIN);
 		for(auto i = 0; i < headerLen; i++) {
 			_spi->transfer(header[i]); // send header
@@ -102,6 +112,9 @@ namespace SPIporting {
 		}
 		delayMicroseconds(5);
 		_closeSPI(slaveSelectPIN);
+		#if DW1000NG_SPI_TRACE
+		traceSPI(start, false, headerLen, header, dataLen, data);
+		#endif
 	}
 
 	void setSPIspeed(SPIClock speed) {
@@ -29,6 +29,7 @@
 
 #include <Arduino.h>
 #include "DW1000NgConstants.hpp"
+#include "DW1000NgCompileOptions.hpp"
 #include <SPI.h>
 
 namespace SPIporting{
@@ -38,6 +39,11 @@ namespace SPIporting{
 	*/
     void SPIinit(SPIClass &spi = SPI);
 
+    /** 
+	Binds an already initialized SPI bus, used when switching between devices on different buses.
+	*/
+    void SPIbind(SPIClass &spi);
+
     /** 
 	Tells the driver library that no communication to a DW1000 will be required anymore.
 	This basically just frees SPI and the previously used pins.
@@ -78,4 +84,61 @@ namespace SPIporting{
     */
     void setSPIspeed(SPIClock speed);
 
-}
\ No newline at end of file
+#if DW1000NG_SPI_TRACE
+    /* First data bytes kept for every traced transaction, enough for command and status registers */
+    constexpr uint8_t SPI_TRACE_DATA_LENGTH = 4;
+
+    typedef struct spi_trace_entry_t {
+        uint32_t timestamp;     /* micros() at the start of the transaction */
+        uint8_t  reg;
+        boolean  write;
+        uint16_t subAddress;    /* 0 when the transaction does not use sub-addressing */
+        uint16_t length;        /* data bytes, header excluded */
+        byte     data[SPI_TRACE_DATA_LENGTH];
+    } spi_trace_entry_t;
+
+    /**
+    Records a transaction in the trace ring buffer, called by the SPI backend.
+
+    @param [in] timestamp micros() at the start of the transaction
+    @param [in] write true for writes
+    @param [in] headerLen header length
+    @param [in] header the SPI header sent
+    @param [in] dataLen data length
+    @param [in] data the bytes written or read
+    */
+    void traceSPI(uint32_t timestamp, boolean write, uint8_t headerLen, byte header[], uint16_t dataLen, byte data[]);
+
+    /**
+    Empties the trace ring buffer.
+    */
+    void clearSPItrace();
+
+    /**
+    returns the number of transactions in the trace ring buffer
+    */
+    uint16_t getSPItraceLength();
+
+    /**
+    returns the number of transactions overwritten because the ring buffer was full
+    */
+    uint32_t getSPItraceOverwritten();
+
+    /**
+    Copies a traced transaction.
+
+    @param [in] index 0 is the oldest transaction in the buffer
+    @param [out] entry the transaction
+    */
+    void getSPItraceEntry(uint16_t index, spi_trace_entry_t& entry);
+
+    /**
+    Prints the trace, one transaction per line, in the format read by extras/spitrace.
+    The buffer is emptied.
+
+    @param [in] out where to print, usually Serial
+    */
+    void dumpSPItrace(Print& out);
+#endif
+
+}
@@ -0,0 +1,138 @@
+/*
+ * MIT License
+ * 
+ * Copyright (c) 2018 Michele Biondi, Andrea Salvatori
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ * 
+ * @file SPIportingTrace.cpp
+ * Optional ring buffer of the SPI transactions, shared by all the SPI backends.
+*/
+
+#include "SPIporting.hpp"
+
+#if DW1000NG_SPI_TRACE
+
+namespace SPIporting {
+
+	namespace {
+		spi_trace_entry_t _trace[DW1000NG_SPI_TRACE_SIZE];
+		uint16_t _traceHead = 0;
+		uint16_t _traceLength = 0;
+		uint32_t _traceOverwritten = 0;
+
+		void _printHex(Print& out, uint32_t value, uint8_t digits) {
+			while(digits-- > 0)
+				out.print((value >> (4*digits)) & 0x0F, HEX);
+		}
+	}
+
+	void traceSPI(uint32_t timestamp, boolean write, uint8_t headerLen, byte header[], uint16_t dataLen, byte data[]) {
+		spi_trace_entry_t entry;
+		entry.timestamp = timestamp;
+		entry.reg = header[0] & 0x3F;
+		entry.write = write;
+		entry.subAddress = 0;
+		if(headerLen > 1)
+			entry.subAddress = header[1] & 0x7F;
+		if(headerLen > 2)
+			entry.subAddress |= static_cast<uint16_t>(header[2]) << 7;
+		entry.length = dataLen;
+		for(uint8_t i = 0; i < SPI_TRACE_DATA_LENGTH; i++)
+			entry.data[i] = i < dataLen ? data[i] : 0;
+
+		/* outside of the SPI transaction the DW1000 interrupt is not masked, and its handler traces too:
+		   the slot is taken with interrupts disabled. On AVR the handler runs with them disabled, so their state is restored */
+		#if defined(__AVR__)
+		uint8_t sreg = SREG;
+		#endif
+		noInterrupts();
+		_trace[_traceHead] = entry;
+		_traceHead = (_traceHead + 1) % DW1000NG_SPI_TRACE_SIZE;
+		if(_traceLength < DW1000NG_SPI_TRACE_SIZE)
+			_traceLength++;
+		else
+			_traceOverwritten++;
+		#if defined(__AVR__)
+		SREG = sreg;
+		#else
+		interrupts();
+		#endif
+	}
+
+	void clearSPItrace() {
+		noInterrupts();
+		_traceLength = 0;
+		_traceOverwritten = 0;
+		interrupts();
+	}
+
+	uint16_t getSPItraceLength() {
+		return _traceLength;
+	}
+
+	uint32_t getSPItraceOverwritten() {
+		return _traceOverwritten;
+	}
+
+	void getSPItraceEntry(uint16_t index, spi_trace_entry_t& entry) {
+		noInterrupts();
+		uint16_t oldest = (_traceHead + DW1000NG_SPI_TRACE_SIZE - _traceLength) % DW1000NG_SPI_TRACE_SIZE;
+		entry = _trace[(oldest + index) % DW1000NG_SPI_TRACE_SIZE];
+		interrupts();
+	}
+
+	void dumpSPItrace(Print& out) {
+		/* snapshot first, transactions made while printing (e.g. from the ISR) stay in the buffer */
+		noInterrupts();
+		uint16_t length = _traceLength;
+		uint16_t oldest = (_traceHead + DW1000NG_SPI_TRACE_SIZE - _traceLength) % DW1000NG_SPI_TRACE_SIZE;
+		uint32_t overwritten = _traceOverwritten;
+		interrupts();
+
+		out.print("SPI trace: "); out.print(length); out.print(" transactions, ");
+		out.print(overwritten); out.println(" overwritten");
+		for(uint16_t i = 0; i < length; i++) {
+			spi_trace_entry_t entry;
+			noInterrupts();
+			entry = _trace[(oldest + i) % DW1000NG_SPI_TRACE_SIZE];
+			interrupts();
+
+			out.print("SPI "); out.print(entry.timestamp);
+			out.print(entry.write ? " W " : " R ");
+			_printHex(out, entry.reg, 2); out.print(' ');
+			_printHex(out, entry.subAddress, 4); out.print(' ');
+			out.print(entry.length);
+			uint8_t shown = entry.length < SPI_TRACE_DATA_LENGTH ? entry.length : SPI_TRACE_DATA_LENGTH;
+			for(uint8_t j = 0; j < shown; j++) {
+				out.print(' ');
+				_printHex(out, entry.data[j], 2);
+			}
+			out.println();
+		}
+
+		noInterrupts();
+		_traceLength -= length;
+		_traceOverwritten -= overwritten;
+		interrupts();
+	}
+
+}
+
+#endif